@@ -0,0 +1,214 @@
+#include "ast.h"
+#include "irUtil.h"
+#include "parserUtil.h"
+
+namespace ast {
+
+namespace {
+
+// Emits the quadruples of a tree in the order the parser's semantic actions
+// would: children first, temporaries numbered as they are created, and jump
+// lists chained and backpatched with the same helpers
+class Lowering {
+public:
+    explicit Lowering(const Program& program)
+        : tree(program.tree), symbols(program.symbols) {}
+
+    irStruct::Module run() {
+        // The jumps leaving the program's statement stay unpatched
+        statement(tree.root);
+        emit(irStruct::OpCode::End, NONE, NONE, NONE);
+
+        irStruct::Module module;
+        module.symbols = symbols;
+        module.temps = std::move(temps);
+        parserUtil::resolveJumps(quads);
+        module.quads = std::move(quads);
+        return module;
+    }
+
+private:
+    struct Value {
+        irStruct::Operand place;
+        irStruct::ValueType type;
+    };
+
+    struct Jumps {
+        int truelist;
+        int falselist;
+    };
+
+    const irStruct::Operand NONE;  // The "-" operand
+
+    const Tree& tree;
+    const std::vector<irStruct::SymbolEntry>& symbols;
+    irStruct::QuadList quads;
+    std::vector<irStruct::ValueType> temps;
+
+    int next() const { return static_cast<int>(quads.size()); }
+
+    void emit(irStruct::OpCode op,
+              const irStruct::Operand& arg1,
+              const irStruct::Operand& arg2,
+              const irStruct::Operand& result) {
+        quads.push(op, arg1, arg2, result);
+    }
+
+    irStruct::Operand temp(irStruct::ValueType type) {
+        return parserUtil::Temp_New(static_cast<int>(type), temps);
+    }
+
+    // Returns the list of jumps leaving the statement
+    int statement(int index) {
+        const Node& node = tree[index];
+        switch (node.kind) {
+            case Kind::Assign: {
+                Value value = expression(node.b);
+                emit(irStruct::OpCode::Assign, value.place, NONE,
+                     irStruct::Operand::symbol(node.a));
+                return -1;
+            }
+            case Kind::Read:
+            case Kind::Write: {
+                const auto op = node.kind == Kind::Read
+                                    ? irStruct::OpCode::Read
+                                    : irStruct::OpCode::Write;
+                for (int i = node.a; i < node.b; i++) {
+                    emit(op, NONE, NONE,
+                         irStruct::Operand::symbol(tree.lists[i]));
+                }
+                return -1;
+            }
+            case Kind::Block: {
+                // L -> L ; N STATEMENT patches the previous statement's
+                // jumps to the next one
+                int nextlist = statement(tree.lists[node.a]);
+                for (int i = node.a + 1; i < node.b; i++) {
+                    const int start = next();
+                    const int following = statement(tree.lists[i]);
+                    parserUtil::backpatch(nextlist, start, quads);
+                    nextlist = following;
+                }
+                return nextlist;
+            }
+            case Kind::While: {
+                const int start = next();
+                Jumps jumps = condition(node.a);
+                const int body = next();
+                const int nextlist = statement(node.b);
+                parserUtil::backpatch(nextlist, start, quads);
+                parserUtil::backpatch(jumps.truelist, body, quads);
+                emit(irStruct::OpCode::Jump, NONE, NONE,
+                     irStruct::Operand::target(start));
+                return jumps.falselist;
+            }
+            case Kind::If: {
+                Jumps jumps = condition(node.a);
+                const int body = next();
+                const int nextlist = statement(node.b);
+                parserUtil::backpatch(jumps.truelist, body, quads);
+                return parserUtil::merge(jumps.falselist, nextlist, quads);
+            }
+            default:
+                return -1;
+        }
+    }
+
+    Value expression(int index) {
+        const Node& node = tree[index];
+        switch (node.kind) {
+            case Kind::Symbol:
+                return {irStruct::Operand::symbol(node.a),
+                        symbols[node.a].type};
+            case Kind::Literal: {
+                const irStruct::Operand& literal = tree.literals[node.a];
+                Value value{temp(literal.type), literal.type};
+                emit(irStruct::OpCode::Assign, literal, NONE, value.place);
+                return value;
+            }
+            case Kind::Unary: {
+                Value operand = expression(node.a);
+                Value value{temp(operand.type), operand.type};
+                emit(node.op, irStruct::Operand::immInt(0), operand.place,
+                     value.place);
+                return value;
+            }
+            case Kind::Not: {
+                Value operand = expression(node.a);
+                Value value{temp(irStruct::ValueType::Int),
+                            irStruct::ValueType::Int};
+                emit(irStruct::OpCode::Not, operand.place, NONE, value.place);
+                return value;
+            }
+            default: {
+                // Sums take the left operand's type and products the right
+                // one's; everything else is an int
+                Value left = expression(node.a);
+                Value right = expression(node.b);
+                auto type = irStruct::ValueType::Int;
+                if (node.op == irStruct::OpCode::Add ||
+                    node.op == irStruct::OpCode::Sub) {
+                    type = left.type;
+                } else if (node.op == irStruct::OpCode::Mul ||
+                           node.op == irStruct::OpCode::Div) {
+                    type = right.type;
+                }
+                Value value{temp(type), type};
+                emit(node.op, left.place, right.place, value.place);
+                return value;
+            }
+        }
+    }
+
+    Jumps condition(int index) {
+        const Node& node = tree[index];
+        switch (node.kind) {
+            case Kind::Compare:
+            case Kind::Test: {
+                Value left = expression(node.a);
+                Value right{NONE, irStruct::ValueType::Int};
+                auto op = irStruct::OpCode::JumpNz;
+                if (node.kind == Kind::Compare) {
+                    right = expression(node.b);
+                    op = irUtil::toJump(node.op);
+                }
+                Jumps jumps{next(), next() + 1};
+                emit(op, left.place, right.place,
+                     irStruct::Operand::target(-1));
+                emit(irStruct::OpCode::Jump, NONE, NONE,
+                     irStruct::Operand::target(-1));
+                return jumps;
+            }
+            case Kind::CondNot: {
+                Jumps jumps = condition(node.a);
+                return {jumps.falselist, jumps.truelist};
+            }
+            case Kind::CondAnd: {
+                Jumps left = condition(node.a);
+                const int start = next();
+                Jumps right = condition(node.b);
+                parserUtil::backpatch(left.truelist, start, quads);
+                return {right.truelist,
+                        parserUtil::merge(left.falselist, right.falselist,
+                                          quads)};
+            }
+            default: {
+                Jumps left = condition(node.a);
+                const int start = next();
+                Jumps right = condition(node.b);
+                parserUtil::backpatch(left.falselist, start, quads);
+                return {parserUtil::merge(left.truelist, right.truelist,
+                                          quads),
+                        right.falselist};
+            }
+        }
+    }
+};
+
+}  // namespace
+
+irStruct::Module lower(const Program& program) {
+    return Lowering(program).run();
+}
+
+}  // namespace ast
@@ -0,0 +1,109 @@
+#ifndef AST_H
+#define AST_H
+
+#include "irStruct.h"
+#include <cstdint>
+#include <vector>
+
+namespace ast {
+
+/**
+ * @enum Kind
+ * @brief What a node stands for. Declarations are not nodes: they only fill
+ * the symbol table.
+ */
+enum class Kind : std::uint8_t {
+    // Statements
+    Empty,   ///< The empty statement.
+    Assign,  ///< a = symbol, b = value.
+    Read,    ///< scanf; a, b = range of symbols in Tree::lists.
+    Write,   ///< printf; a, b = range of symbols in Tree::lists.
+    Block,   ///< { ... }; a, b = range of statements in Tree::lists.
+    While,   ///< a = condition, b = body.
+    If,      ///< a = condition, b = body.
+
+    // Expressions
+    Symbol,   ///< a = symbol index.
+    Literal,  ///< a = index in Tree::literals.
+    Unary,    ///< op = Add or Sub, a = operand; computed as 0 op a.
+    Not,      ///< a = operand.
+    Binary,   ///< op = arithmetic, relational, And or Or; a, b = operands.
+
+    // Conditions
+    Compare,  ///< op = relational; a, b = Symbol or Literal operands.
+    Test,     ///< a = Symbol or Literal operand, true if nonzero.
+    CondNot,  ///< a = condition.
+    CondAnd,  ///< a, b = conditions, short-circuit.
+    CondOr    ///< a, b = conditions, short-circuit.
+};
+
+/**
+ * @struct Node
+ * @brief A node of the tree. Nodes refer to each other by index, so a node
+ * is a few bytes of plain data.
+ */
+struct Node {
+    Kind kind;        ///< What the node stands for.
+    irStruct::OpCode op;  ///< The operator, for nodes that have one.
+    std::int32_t a;   ///< First child, or see Kind.
+    std::int32_t b;   ///< Second child, or see Kind.
+};
+
+/**
+ * @class Tree
+ * @brief The abstract syntax tree of a program, stored in flat arrays.
+ *
+ * Nodes are appended to one array and refer to their children by index, in
+ * the order the parser reduced them, so every child comes before its parent
+ * and the root is last. Variable-length children (statements of a block,
+ * operands of scanf and printf) are runs of Tree::lists, and literal values
+ * live in Tree::literals. Building a tree only appends to these arrays, and
+ * destroying it frees them whole.
+ */
+class Tree {
+public:
+    std::vector<Node> nodes;  ///< All nodes; children before parents.
+    std::vector<std::int32_t> lists;  ///< Runs of node or symbol indices.
+    std::vector<irStruct::Operand> literals;  ///< Literal values.
+    int root = -1;  ///< The program's statement.
+
+    /**
+     * @brief Appends a node.
+     *
+     * @return int The index of the new node.
+     */
+    int add(Kind kind,
+            int a = -1,
+            int b = -1,
+            irStruct::OpCode op = irStruct::OpCode::Assign) {
+        nodes.push_back(Node{kind, op, a, b});
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    /**
+     * @brief Returns a node by index.
+     */
+    const Node& operator[](int index) const { return nodes[index]; }
+};
+
+/**
+ * @struct Program
+ * @brief A parsed program: its tree and its symbol table.
+ */
+struct Program {
+    Tree tree;  ///< The statements.
+    std::vector<irStruct::SymbolEntry> symbols;  ///< Declared variables.
+};
+
+/**
+ * @brief Translates a program into quadruples. The result is identical to
+ * the module the parser produces while parsing.
+ *
+ * @param program The program.
+ * @return irStruct::Module The symbol table, temporaries and quadruples.
+ */
+irStruct::Module lower(const Program& program);
+
+}  // namespace ast
+
+#endif  // AST_H
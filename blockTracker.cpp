@@ -0,0 +1,117 @@
+#include "blockTracker.h"
+#include "irUtil.h"
+#include <algorithm>
+
+BlockTracker::BlockTracker(Sink sink)
+    : sink(std::move(sink)), leaders(1, true) {}
+
+void BlockTracker::reduced(std::string_view lhs,
+                           const std::pmr::vector<std::pmr::string>& rhs,
+                           const irStruct::QuadList& quads) {
+    // N records the next quadruple; the rules using it consume the markers
+    openMarkers.resize(openMarkers.size() -
+                       std::count(rhs.begin(), rhs.end(), "N"));
+    if (lhs == "N") {
+        openMarkers.push_back(static_cast<int>(quads.size()));
+    }
+
+    scan(quads);
+
+    int bound = static_cast<int>(quads.size());
+    if (!openMarkers.empty()) {
+        bound = std::min(bound, openMarkers.front());
+    }
+    if (!pending.empty()) {
+        bound = std::min(bound, *pending.begin());
+    }
+    release(quads, bound, false);
+}
+
+void BlockTracker::resolved(int index, int target) {
+    // Targets that are not positive are redirected to the End at the finish
+    if (target > 0) {
+        pending.erase(index);
+        markLeader(target);
+    }
+}
+
+void BlockTracker::finish(const irStruct::QuadList& quads) {
+    scan(quads);
+    for (int index : pending) {
+        markLeader(quads.result(index).index);
+    }
+    pending.clear();
+    openMarkers.clear();
+    release(quads, static_cast<int>(quads.size()), true);
+}
+
+void BlockTracker::scan(const irStruct::QuadList& quads) {
+    for (; scanned < static_cast<int>(quads.size()); scanned++) {
+        const auto op = quads.op(scanned);
+        if (irUtil::isJump(op)) {
+            // New jumps either know their target or wait for backpatching
+            const int target = quads.result(scanned).index;
+            if (target > 0) {
+                markLeader(target);
+            } else {
+                pending.insert(scanned);
+            }
+            if (op != irStruct::OpCode::Jump) {
+                markLeader(scanned + 1);
+            }
+        } else if (op == irStruct::OpCode::Read ||
+                   op == irStruct::OpCode::Write) {
+            markLeader(scanned);
+        }
+    }
+}
+
+void BlockTracker::markLeader(int index) {
+    if (static_cast<size_t>(index) >= leaders.size()) {
+        leaders.resize(index + 1, false);
+    }
+    leaders[index] = true;
+}
+
+void BlockTracker::release(const irStruct::QuadList& quads,
+                           int bound,
+                           bool final) {
+    const int size = static_cast<int>(quads.size());
+    auto isLeader = [this](int index) {
+        return static_cast<size_t>(index) < leaders.size() && leaders[index];
+    };
+
+    while (cursor < bound) {
+        // Quadruples before the next leader belong to no block
+        if (!isLeader(cursor)) {
+            cursor++;
+            continue;
+        }
+
+        // The block ends at a jump, at End, or before the next leader
+        int end = cursor;
+        while (true) {
+            if (end >= bound) {
+                return;
+            }
+            const auto op = quads.op(end);
+            if (irUtil::isJump(op) || op == irStruct::OpCode::End) {
+                break;
+            }
+            if (end + 1 == size && final) {
+                break;
+            }
+            if (end + 1 >= bound) {
+                return;
+            }
+            if (isLeader(end + 1)) {
+                break;
+            }
+            end++;
+        }
+
+        sink(quads, released, cursor, end);
+        released = end + 1;
+        cursor = end + 1;
+    }
+}
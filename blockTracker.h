@@ -0,0 +1,95 @@
+#ifndef BLOCKTRACKER_H
+#define BLOCKTRACKER_H
+
+#include "irStruct.h"
+#include <functional>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class BlockTracker
+ * @brief Follows the quadruples while the parser produces them and hands out
+ * every basic block as soon as it can no longer change.
+ *
+ * A jump still waiting for backpatching may later target any quadruple from
+ * the oldest open N marker (or from the next quadruple) onwards, so the
+ * quadruples before that bound, and before the first waiting jump, have
+ * their final contents and their final basic block boundaries.
+ */
+class BlockTracker {
+public:
+    /**
+     * @brief Receives the quadruples [first, end] from the parser's list. The
+     * basic block is [start, end]; the quadruples before start are
+     * unreachable.
+     */
+    using Sink = std::function<void(
+        const irStruct::QuadList& quads, int first, int start, int end)>;
+
+    /**
+     * @brief Constructs a tracker.
+     *
+     * @param sink Called for every completed basic block, in program order.
+     */
+    explicit BlockTracker(Sink sink);
+
+    /**
+     * @brief Called after every reduction with the rule that was applied.
+     *
+     * @param lhs The left-hand side of the rule.
+     * @param rhs The right-hand side of the rule.
+     * @param quads The quadruples produced so far.
+     */
+    void reduced(std::string_view lhs,
+                 const std::pmr::vector<std::pmr::string>& rhs,
+                 const irStruct::QuadList& quads);
+
+    /**
+     * @brief Called when a jump is backpatched.
+     *
+     * @param index The index of the jump.
+     * @param target Its target.
+     */
+    void resolved(int index, int target);
+
+    /**
+     * @brief Hands out the remaining blocks once the unresolved jumps have
+     * been given their final targets.
+     *
+     * @param quads The complete list of quadruples.
+     */
+    void finish(const irStruct::QuadList& quads);
+
+private:
+    /**
+     * @brief Records the jumps and I/O operations of new quadruples.
+     */
+    void scan(const irStruct::QuadList& quads);
+
+    /**
+     * @brief Marks a quadruple as the start of a basic block.
+     */
+    void markLeader(int index);
+
+    /**
+     * @brief Hands out the basic blocks that end before a bound.
+     *
+     * @param quads The quadruples produced so far.
+     * @param bound The first quadruple that may still change.
+     * @param final Whether all quadruples have been produced.
+     */
+    void release(const irStruct::QuadList& quads, int bound, bool final);
+
+    Sink sink;                      ///< Receiver of the completed blocks.
+    std::vector<bool> leaders;      ///< Quadruples that start a basic block.
+    std::set<int> pending;          ///< Jumps still waiting for a target.
+    std::vector<int> openMarkers;   ///< Quadruple numbers of open N markers.
+    int scanned = 0;                ///< Quadruples examined by scan().
+    int cursor = 0;                 ///< Next quadruple to partition.
+    int released = 0;               ///< Quadruples handed to the sink.
+};
+
+#endif  // BLOCKTRACKER_H
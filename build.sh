@@ -1,7 +1,7 @@
 #!/bin/bash
 
 CXX=g++
-CXXFLAGS="-std=c++17 -O2 -Wall -g"
+CXXFLAGS="-std=c++17 -O2 -Wall -g -pthread"
 SRC_DIR="."
 BUILD_DIR="."
 EXEC_NAME="Main"
@@ -11,6 +11,11 @@ if [ "$1" == "--online-judge" ]; then
     CXXFLAGS="$CXXFLAGS -D ONLINE_JUDGE"
 fi
 
+# What Main runs without options, e.g. TASK=2 ./build.sh (see pipeline.h)
+if [ -n "$TASK" ]; then
+    CXXFLAGS="$CXXFLAGS -D TASK=$TASK"
+fi
+
 for src_file in $SRC_DIR/*.cpp; do
     obj_file="$BUILD_DIR/$(basename "$src_file" .cpp).o"
     $CXX $CXXFLAGS -c $src_file -o $obj_file
@@ -3,20 +3,27 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory_resource>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <tuple>
 
 // The Expression structure represents an expression in the parser or compiler,
 // encapsulating the expression's type, symbols, position, index, and suffix.
+// Its strings and containers come from the allocator of the container that
+// holds it, e.g. the parser's memory resource for its item sets.
 struct Expression {
-    std::string T;  // The type of the expression (e.g., "int", "float")
-    std::vector<std::string>
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    std::pmr::string T;  // The type of the expression (e.g., "int", "float")
+    std::pmr::vector<std::pmr::string>
         S;           // The list of symbols (e.g., variables, operators)
     size_t pos = 0;  // The position of the expression (used for tracking)
     int idx = 0;     // The index of the expression (can be used for ordering or
                      // referencing)
-    std::set<std::string>
+    std::pmr::set<std::pmr::string>
         suffix;  // The set of suffixes associated with the expression (e.g.,
                  // possible continuations or references)
 
@@ -24,12 +31,28 @@ struct Expression {
     Expression() = default;
 
     // Constructor for initializing an Expression with specific values
-    explicit Expression(std::string T,
-                        const std::vector<std::string>& S,
+    explicit Expression(std::string_view T,
+                        const std::pmr::vector<std::pmr::string>& S,
                         size_t pos,
                         int idx,
-                        const std::set<std::string>& suffix)
-        : T(std::move(T)), S(S), pos(pos), idx(idx), suffix(suffix) {}
+                        const std::pmr::set<std::pmr::string>& suffix,
+                        const allocator_type& alloc = {})
+        : T(T, alloc), S(S, alloc), pos(pos), idx(idx), suffix(suffix, alloc) {}
+
+    // Copy and move constructors, plain and allocator-extended
+    Expression(const Expression&) = default;
+    Expression(Expression&&) = default;
+    Expression(const Expression& other, const allocator_type& alloc)
+        : Expression(other.T, other.S, other.pos, other.idx, other.suffix,
+                     alloc) {}
+    Expression(Expression&& other, const allocator_type& alloc)
+        : T(std::move(other.T), alloc),
+          S(std::move(other.S), alloc),
+          pos(other.pos),
+          idx(other.idx),
+          suffix(std::move(other.suffix), alloc) {}
+    Expression& operator=(const Expression&) = default;
+    Expression& operator=(Expression&&) = default;
 
     // Overloaded stream insertion operator for printing the expression
     friend std::ostream& operator<<(std::ostream& os, const Expression& expr) {
@@ -0,0 +1,253 @@
+#include "incrementalParser.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+bool sameToken(const lexerStruct::Token& a, const lexerStruct::Token& b) {
+    return a.kind == b.kind && a.text == b.text;
+}
+
+bool sameSymbols(const std::pmr::vector<parserStruct::Symbol>& a,
+                 const std::pmr::vector<parserStruct::Symbol>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const auto& x, const auto& y) {
+                          return x.name == y.name && x.type == y.type &&
+                                 x.offset == y.offset;
+                      });
+}
+
+}  // namespace
+
+IncrementalParser::IncrementalParser() : parser(Parser::Engine::Table) {
+    parser.buildTables();
+}
+
+std::optional<irStruct::Module> IncrementalParser::parse(
+    std::vector<lexerStruct::Token> next) {
+    // Tokens shared with the previous version at the start and at the end
+    size_t prefix = 0;
+    size_t suffix = 0;
+    if (valid) {
+        const size_t limit = std::min(tokens.size(), next.size());
+        while (prefix < limit && sameToken(tokens[prefix], next[prefix])) {
+            prefix++;
+        }
+        while (suffix < limit - prefix &&
+               sameToken(tokens[tokens.size() - 1 - suffix],
+                         next[next.size() - 1 - suffix])) {
+            suffix++;
+        }
+    }
+
+    // Resume from the last checkpoint that only covers unchanged tokens
+    size_t kept = 0;
+    if (valid) {
+        kept = std::upper_bound(checkpoints.begin(), checkpoints.end(), prefix,
+                                [](size_t token, const Checkpoint& c) {
+                                    return token < c.token;
+                                }) -
+               checkpoints.begin();
+    }
+    restore(kept > 0 ? &checkpoints[kept - 1] : nullptr);
+
+    // The checkpoints before the resumption point stay valid. The one it
+    // resumes from is copied, since splicing may still start at it
+    std::vector<Checkpoint> recorded;
+    if (kept > 0) {
+        recorded.assign(std::make_move_iterator(checkpoints.begin()),
+                        std::make_move_iterator(checkpoints.begin() + kept -
+                                                1));
+        recorded.push_back(checkpoints[kept - 1]);
+    }
+
+    size_t consumed = kept > 0 ? recorded.back().token : 0;
+    const long tokenShift = static_cast<long>(next.size()) -
+                            static_cast<long>(tokens.size());
+    parsed = 0;
+    auto nextToken = [&](lexerStruct::Token& token) {
+        if (consumed == next.size()) {
+            return false;
+        }
+        token = next[consumed++];
+        parsed++;
+        return true;
+    };
+
+    // At every boundary record a checkpoint, and pause once the rest of the
+    // input is the unchanged tail of a boundary of the previous version
+    bool canSplice = valid;
+    std::optional<size_t> spliceFrom;
+    parser.boundaryHook = [&]() {
+        recorded.push_back(capture(consumed));
+        if (!canSplice || consumed < next.size() - suffix) {
+            return false;
+        }
+        const long oldToken = static_cast<long>(consumed) - tokenShift;
+        auto it = std::lower_bound(
+            checkpoints.begin() + (kept > 0 ? kept - 1 : 0), checkpoints.end(),
+            oldToken, [](const Checkpoint& c, long token) {
+                return static_cast<long>(c.token) < token;
+            });
+        // A boundary before any quadruple leaves link 0 ambiguous
+        if (it == checkpoints.end() ||
+            static_cast<long>(it->token) != oldToken || it->quads == 0 ||
+            it->states != parser.stateStack) {
+            return false;
+        }
+        // The copied quadruples refer to symbols by index
+        if (!sameSymbols(symbols, parser.symbolTable)) {
+            canSplice = false;
+            return false;
+        }
+        spliceFrom = it - checkpoints.begin();
+        return true;
+    };
+
+    bool accepted = parser.runTable(nextToken);
+    if (!accepted && spliceFrom) {
+        canSplice = false;
+        splice(*spliceFrom, tokenShift, recorded);
+        consumed = recorded.back().token;
+        accepted = parser.runTable(nextToken);
+    }
+    parser.boundaryHook = nullptr;
+
+    if (!accepted) {
+        valid = false;
+        tokens.clear();
+        checkpoints.clear();
+        return std::nullopt;
+    }
+
+    // Keep this version for the next edit
+    valid = true;
+    tokens = std::move(next);
+    checkpoints = std::move(recorded);
+    quads = parser.quadruples;
+    temps = parser.tempVariableIndices;
+    symbols = parser.symbolTable;
+    offset = parser.offset;
+    return parser.buildModule();
+}
+
+void IncrementalParser::restore(const Checkpoint* checkpoint) {
+    parser.quadruples.clear();
+    parser.tempVariableIndices.clear();
+    parser.stateStack = std::stack<int>();
+    parser.attributeStack = parserStruct::AttributeStack();
+
+    if (!checkpoint) {
+        parser.stateStack.push(0);
+        parser.symbolTable.clear();
+        parser.nxt = 0;
+        parser.offset = 0;
+        return;
+    }
+
+    parser.quadruples.reserve(quads.size());
+    for (int i = 0; i < checkpoint->quads; i++) {
+        parser.quadruples.push(quads.at(i));
+    }
+    // Undo the backpatching done after the checkpoint
+    for (const auto& [index, link] : checkpoint->pending) {
+        parser.quadruples.setResult(index, link);
+    }
+    parser.tempVariableIndices.assign(temps.begin(),
+                                      temps.begin() + checkpoint->temps);
+    parser.symbolTable = symbols;
+    parser.offset = offset;
+    parser.nxt = checkpoint->quads;
+    parser.stateStack = checkpoint->states;
+    parser.attributeStack = checkpoint->attributes;
+}
+
+IncrementalParser::Checkpoint IncrementalParser::capture(size_t token) const {
+    Checkpoint checkpoint;
+    checkpoint.token = token;
+    checkpoint.quads = parser.nxt;
+    checkpoint.temps = static_cast<int>(parser.tempVariableIndices.size());
+    checkpoint.states = parser.stateStack;
+    checkpoint.attributes = parser.attributeStack;
+
+    // The jumps leaving the last statement, patched by the next one
+    const auto& q = parser.quadruples;
+    for (int i = parser.attributeStack.top().nextlist; i > 0;
+         i = q.result(i).index) {
+        checkpoint.pending.emplace_back(i, q.result(i));
+    }
+    return checkpoint;
+}
+
+void IncrementalParser::splice(size_t from,
+                               long tokenShift,
+                               std::vector<Checkpoint>& recorded) {
+    const Checkpoint& first = checkpoints[from];
+    const int quadShift = parser.nxt - first.quads;
+    const int tempShift =
+        static_cast<int>(parser.tempVariableIndices.size()) - first.temps;
+
+    // Quadruple numbers from the first copied statement on move; smaller
+    // ones are list terminators (0 or -1)
+    auto moveQuad = [&](int quad) {
+        return quad >= first.quads ? quad + quadShift : quad;
+    };
+    auto moveOperand = [&](irStruct::Operand operand) {
+        if (operand.kind == irStruct::OperandKind::Temp) {
+            operand.index += tempShift;
+        } else if (operand.kind == irStruct::OperandKind::Target) {
+            operand.index = moveQuad(operand.index);
+        }
+        return operand;
+    };
+    auto moveAttributes = [&](parserStruct::AttributeStack stack) {
+        std::vector<parserStruct::Attribute> items;
+        for (; !stack.empty(); stack.pop()) {
+            items.push_back(stack.top());
+        }
+        for (auto it = items.rbegin(); it != items.rend(); ++it) {
+            it->quad = moveQuad(it->quad);
+            it->nextlist = moveQuad(it->nextlist);
+            it->truelist = moveQuad(it->truelist);
+            it->falselist = moveQuad(it->falselist);
+            stack.push(*it);
+        }
+        return stack;
+    };
+
+    // If a statement follows, it starts here, so the jumps leaving the
+    // reparsed one get the target L -> L ; N STATEMENT would give them
+    const Checkpoint& last = checkpoints.back();
+    if (from + 1 < checkpoints.size()) {
+        parser.patch(parser.attributeStack.top().nextlist, parser.nxt);
+    }
+
+    for (int i = first.quads; i < last.quads; i++) {
+        parser.quadruples.push(quads.op(i), moveOperand(quads.arg1(i)),
+                               moveOperand(quads.arg2(i)),
+                               moveOperand(quads.result(i)));
+    }
+    parser.tempVariableIndices.insert(parser.tempVariableIndices.end(),
+                                      temps.begin() + first.temps,
+                                      temps.begin() + last.temps);
+
+    // The checkpoint just recorded stands for the one at from
+    for (size_t k = from + 1; k < checkpoints.size(); k++) {
+        const Checkpoint& old = checkpoints[k];
+        Checkpoint moved;
+        moved.token = old.token + tokenShift;
+        moved.quads = old.quads + quadShift;
+        moved.temps = old.temps + tempShift;
+        moved.states = old.states;
+        moved.attributes = moveAttributes(old.attributes);
+        for (const auto& [index, link] : old.pending) {
+            moved.pending.emplace_back(index + quadShift, moveOperand(link));
+        }
+        recorded.push_back(std::move(moved));
+    }
+
+    // Continue after the last statement of the previous version
+    parser.nxt = recorded.back().quads;
+    parser.stateStack = recorded.back().states;
+    parser.attributeStack = recorded.back().attributes;
+}
@@ -0,0 +1,103 @@
+#ifndef INCREMENTALPARSER_H
+#define INCREMENTALPARSER_H
+
+#include "irStruct.h"
+#include "lexerStruct.h"
+#include "parser.h"
+#include "parserStruct.h"
+#include <optional>
+#include <stack>
+#include <vector>
+
+/**
+ * @class IncrementalParser
+ * @brief Reparses successive versions of a program, reusing the work done on
+ * the previous version.
+ *
+ * The table-driven parser is checkpointed after the ';' that ends each
+ * statement of the outermost block. After an edit, parsing resumes from the
+ * last checkpoint before the first changed token. Once it reaches a statement
+ * boundary inside the unchanged tail of the program, the remaining
+ * statements are spliced in from the previous version: their quadruples are
+ * copied with quadruple and temporary numbers shifted, and only the jumps
+ * left pending by the reparsed region are backpatched. The semantic actions
+ * thus run only for the statements around the edit, and the result is
+ * identical to a parse from scratch.
+ */
+class IncrementalParser {
+public:
+    IncrementalParser();
+
+    /**
+     * @brief Parses the next version of the program.
+     *
+     * @param tokens The tokens of the new version.
+     * @return The module, or std::nullopt on a syntax error. After an error
+     * the next version is parsed from scratch.
+     */
+    std::optional<irStruct::Module> parse(
+        std::vector<lexerStruct::Token> tokens);
+
+    /**
+     * @brief Returns how many tokens the last parse handed to the LR parser;
+     * the others were covered by checkpoints or spliced statements.
+     *
+     * @return size_t The number of tokens parsed.
+     */
+    size_t parsedTokens() const { return parsed; }
+
+private:
+    /**
+     * @struct Checkpoint
+     * @brief The parser state right after a statement boundary.
+     */
+    struct Checkpoint {
+        size_t token = 0;  ///< Tokens consumed, including the ';'.
+        int quads = 0;     ///< Quadruples produced.
+        int temps = 0;     ///< Temporaries allocated.
+        std::stack<int> states;  ///< LR state stack.
+        parserStruct::AttributeStack attributes;  ///< Attribute stack.
+        /// Result fields of the jumps still waiting for a target, as they were
+        /// before a later statement backpatched them.
+        std::vector<std::pair<int, irStruct::Operand>> pending;
+    };
+
+    /**
+     * @brief Resets the parser to the state of a checkpoint of the previous
+     * version, or to the initial state.
+     */
+    void restore(const Checkpoint* checkpoint);
+
+    /**
+     * @brief Records the parser state at the current statement boundary.
+     */
+    Checkpoint capture(size_t token) const;
+
+    /**
+     * @brief Copies the statements after an old checkpoint into the parser,
+     * shifting their quadruple and temporary numbers to follow the current
+     * state, and moves the parser to the state after the last of them.
+     *
+     * @param from The index of the old checkpoint matching the current state.
+     * @param tokenShift How far the old token positions move.
+     * @param recorded The checkpoints of the new version; the copied ones are
+     * appended.
+     */
+    void splice(size_t from,
+                long tokenShift,
+                std::vector<Checkpoint>& recorded);
+
+    Parser parser;  ///< Table-driven parser; its tables are built once.
+
+    bool valid = false;  ///< The previous version parsed successfully.
+    std::vector<lexerStruct::Token> tokens;  ///< Tokens of the previous version.
+    std::vector<Checkpoint> checkpoints;     ///< Its statement boundaries.
+    irStruct::QuadList quads;  ///< Its quadruples before jump resolution.
+    std::vector<irStruct::ValueType> temps;     ///< Its temporary types.
+    std::pmr::vector<parserStruct::Symbol> symbols;  ///< Its symbol table.
+    int offset = 0;  ///< Its offset after the declarations.
+
+    size_t parsed = 0;  ///< Tokens handed to the LR parser by the last parse.
+};
+
+#endif  // INCREMENTALPARSER_H
@@ -0,0 +1,343 @@
+#include "irBinary.h"
+#include "irUtil.h"
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace irBinary {
+
+namespace {
+
+// Payload of an ImmText literal whose text is at offset in the name pool
+std::int64_t encodeText(std::uint32_t offset, std::size_t length) {
+    return static_cast<std::int64_t>(
+        (static_cast<std::uint64_t>(offset) << 32) | length);
+}
+
+// Offset and length of the text of an ImmText payload
+std::uint64_t textOffset(std::int64_t value) {
+    return static_cast<std::uint64_t>(value) >> 32;
+}
+
+std::uint64_t textLength(std::int64_t value) {
+    return static_cast<std::uint64_t>(value) & 0xFFFFFFFFu;
+}
+
+// Payload of an operand: the index, the integer or the bits of the double
+std::int64_t encodeValue(const irStruct::Operand& op) {
+    switch (op.kind) {
+        case irStruct::OperandKind::ImmInt:
+            return op.intValue;
+        case irStruct::OperandKind::ImmDouble: {
+            std::int64_t bits;
+            std::memcpy(&bits, &op.doubleValue, sizeof(bits));
+            return bits;
+        }
+        case irStruct::OperandKind::None:
+            return 0;
+        default:
+            return op.index;
+    }
+}
+
+// Whether a stored byte names a value type
+bool validType(std::uint8_t type) {
+    return type <= static_cast<std::uint8_t>(irStruct::ValueType::Double);
+}
+
+// Checks operand slot of a record against the tables of the module
+void checkOperand(const QuadRecord& quad, int slot, std::size_t index,
+                  const Header& head) {
+    auto fail = [index](const std::string& what) {
+        throw std::invalid_argument("QIR quadruple " + std::to_string(index) +
+                                    ": " + what + ".");
+    };
+    if (quad.kinds[slot] >
+        static_cast<std::uint8_t>(irStruct::OperandKind::ImmText)) {
+        fail("unknown operand kind " + std::to_string(quad.kinds[slot]));
+    }
+    if (!validType(quad.types[slot])) {
+        fail("unknown operand type " + std::to_string(quad.types[slot]));
+    }
+    const std::int64_t value = quad.values[slot];
+    switch (static_cast<irStruct::OperandKind>(quad.kinds[slot])) {
+        case irStruct::OperandKind::Symbol:
+            if (value < 0 || value >= head.symbolCount) {
+                fail("symbol TB" + std::to_string(value) + " out of range");
+            }
+            break;
+        case irStruct::OperandKind::Temp:
+            if (value < 0 || value >= head.tempCount) {
+                fail("temporary T" + std::to_string(value) + " out of range");
+            }
+            break;
+        case irStruct::OperandKind::Target:
+            if (value < 0 || value > head.quadCount) {
+                fail("jump target " + std::to_string(value) + " out of range");
+            }
+            break;
+        case irStruct::OperandKind::ImmText:
+            if (textLength(value) == 0 ||
+                textOffset(value) + textLength(value) > head.nameBytes) {
+                fail("literal text out of range");
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+}  // namespace
+
+std::string serialize(const irStruct::Module& module) {
+    const auto& quads = module.quads;
+
+    std::size_t nameBytes = 0;
+    for (const auto& symbol : module.symbols) {
+        nameBytes += symbol.name.size();
+    }
+
+    // The texts of ImmText literals follow the symbol names
+    std::vector<std::string> texts;
+    for (std::size_t i = 0; i < quads.size(); i++) {
+        for (const auto* operand :
+             {&quads.arg1(i), &quads.arg2(i), &quads.result(i)}) {
+            if (operand->kind == irStruct::OperandKind::ImmText) {
+                texts.push_back(irUtil::literalText(*operand));
+                nameBytes += texts.back().size();
+            }
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC.data(), MAGIC.size());
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.symbolCount = static_cast<std::uint32_t>(module.symbols.size());
+    header.tempCount = static_cast<std::uint32_t>(module.temps.size());
+    header.quadCount = static_cast<std::uint32_t>(quads.size());
+    header.nameBytes = static_cast<std::uint32_t>(nameBytes);
+
+    // Size the buffer once and fill every section in place
+    const std::size_t size = sizeof(Header) +
+                             module.symbols.size() * sizeof(SymbolRecord) +
+                             quads.size() * sizeof(QuadRecord) +
+                             module.temps.size() + nameBytes;
+    std::string out(size, '\0');
+    char* pos = out.data();
+    std::memcpy(pos, &header, sizeof(header));
+    pos += sizeof(header);
+
+    std::uint32_t nameOffset = 0;
+    for (const auto& symbol : module.symbols) {
+        SymbolRecord record{};
+        record.nameOffset = nameOffset;
+        record.nameLength = static_cast<std::uint32_t>(symbol.name.size());
+        record.offset = symbol.offset;
+        record.type = static_cast<std::uint8_t>(symbol.type);
+        std::memcpy(pos, &record, sizeof(record));
+        pos += sizeof(record);
+        nameOffset += record.nameLength;
+    }
+
+    std::uint32_t textOffset = nameOffset;
+    std::size_t text = 0;
+    for (std::size_t i = 0; i < quads.size(); i++) {
+        QuadRecord record{};
+        record.op = static_cast<std::uint8_t>(quads.op(i));
+        const irStruct::Operand* operands[3] = {&quads.arg1(i), &quads.arg2(i),
+                                                &quads.result(i)};
+        for (int slot = 0; slot < 3; slot++) {
+            const auto& operand = *operands[slot];
+            record.kinds[slot] = static_cast<std::uint8_t>(operand.kind);
+            record.types[slot] = static_cast<std::uint8_t>(operand.type);
+            if (operand.kind == irStruct::OperandKind::ImmText) {
+                const std::size_t length = texts[text++].size();
+                record.values[slot] = encodeText(textOffset, length);
+                textOffset += static_cast<std::uint32_t>(length);
+            } else {
+                record.values[slot] = encodeValue(operand);
+            }
+        }
+        std::memcpy(pos, &record, sizeof(record));
+        pos += sizeof(record);
+    }
+
+    for (auto type : module.temps) {
+        *pos++ = static_cast<char>(type);
+    }
+
+    for (const auto& symbol : module.symbols) {
+        std::memcpy(pos, symbol.name.data(), symbol.name.size());
+        pos += symbol.name.size();
+    }
+    for (const auto& literal : texts) {
+        std::memcpy(pos, literal.data(), literal.size());
+        pos += literal.size();
+    }
+
+    return out;
+}
+
+ModuleView::ModuleView(const char* data, std::size_t size) {
+    if (size < sizeof(Header) ||
+        reinterpret_cast<std::uintptr_t>(data) % alignof(QuadRecord) != 0) {
+        throw std::invalid_argument("Truncated or misaligned QIR module.");
+    }
+    head = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(head->magic, MAGIC.data(), MAGIC.size()) != 0) {
+        throw std::invalid_argument("Not a QIR module.");
+    }
+    if (head->version != VERSION) {
+        throw std::invalid_argument("Unsupported QIR version: " +
+                                    std::to_string(head->version));
+    }
+    if (head->byteOrder != BYTE_ORDER_MARK) {
+        throw std::invalid_argument("QIR module has a foreign byte order.");
+    }
+
+    // Section sizes are computed in 64 bits so that no count can overflow
+    const std::uint64_t expected =
+        sizeof(Header) +
+        static_cast<std::uint64_t>(head->symbolCount) * sizeof(SymbolRecord) +
+        static_cast<std::uint64_t>(head->quadCount) * sizeof(QuadRecord) +
+        head->tempCount + head->nameBytes;
+    if (expected > size) {
+        throw std::invalid_argument("Truncated QIR module.");
+    }
+
+    symbols = reinterpret_cast<const SymbolRecord*>(data + sizeof(Header));
+    quads = reinterpret_cast<const QuadRecord*>(symbols + head->symbolCount);
+    temps = reinterpret_cast<const std::uint8_t*>(quads + head->quadCount);
+    names = reinterpret_cast<const char*>(temps + head->tempCount);
+
+    for (std::size_t i = 0; i < head->symbolCount; i++) {
+        if (static_cast<std::uint64_t>(symbols[i].nameOffset) +
+                symbols[i].nameLength >
+            head->nameBytes) {
+            throw std::invalid_argument("QIR symbol name out of range.");
+        }
+        if (!validType(symbols[i].type)) {
+            throw std::invalid_argument("QIR symbol " + std::to_string(i) +
+                                        ": unknown type.");
+        }
+    }
+    for (std::size_t i = 0; i < head->tempCount; i++) {
+        if (!validType(temps[i])) {
+            throw std::invalid_argument("QIR temporary " + std::to_string(i) +
+                                        ": unknown type.");
+        }
+    }
+
+    // Every record is checked once here, so that toModule() and the code
+    // generator never see an operation or an index that does not exist
+    for (std::size_t i = 0; i < head->quadCount; i++) {
+        const auto& record = quads[i];
+        if (record.op > static_cast<std::uint8_t>(irStruct::OpCode::End)) {
+            throw std::invalid_argument("QIR quadruple " + std::to_string(i) +
+                                        ": unknown operation " +
+                                        std::to_string(record.op) + ".");
+        }
+        for (int slot = 0; slot < 3; slot++) {
+            checkOperand(record, slot, i, *head);
+        }
+        const auto op = static_cast<irStruct::OpCode>(record.op);
+        if (irUtil::isJump(op) &&
+            record.kinds[2] !=
+                static_cast<std::uint8_t>(irStruct::OperandKind::Target)) {
+            throw std::invalid_argument("QIR quadruple " + std::to_string(i) +
+                                        ": jump without a target.");
+        }
+    }
+}
+
+irStruct::Operand ModuleView::operand(const QuadRecord& quad,
+                                      int slot) const {
+    const auto kind = static_cast<irStruct::OperandKind>(quad.kinds[slot]);
+    const auto type = static_cast<irStruct::ValueType>(quad.types[slot]);
+    const std::int64_t value = quad.values[slot];
+
+    switch (kind) {
+        case irStruct::OperandKind::Symbol:
+            return irStruct::Operand::symbol(static_cast<int>(value));
+        case irStruct::OperandKind::Temp:
+            return irStruct::Operand::temp(static_cast<int>(value), type);
+        case irStruct::OperandKind::ImmInt:
+            return irStruct::Operand::immInt(value);
+        case irStruct::OperandKind::ImmDouble: {
+            double d;
+            std::memcpy(&d, &value, sizeof(d));
+            return irStruct::Operand::immDouble(d);
+        }
+        case irStruct::OperandKind::Target:
+            return irStruct::Operand::target(static_cast<int>(value));
+        case irStruct::OperandKind::ImmText:
+            return irUtil::textLiteral(std::string_view(
+                names + textOffset(value), textLength(value)));
+        default:
+            return irStruct::Operand();
+    }
+}
+
+irStruct::Module ModuleView::toModule() const {
+    irStruct::Module module;
+
+    module.symbols.reserve(symbolCount());
+    for (std::size_t i = 0; i < symbolCount(); i++) {
+        module.symbols.emplace_back(
+            std::string(symbolName(i)),
+            static_cast<irStruct::ValueType>(symbols[i].type),
+            symbols[i].offset);
+    }
+
+    module.temps.assign(
+        reinterpret_cast<const irStruct::ValueType*>(temps),
+        reinterpret_cast<const irStruct::ValueType*>(temps) + tempCount());
+
+    module.quads.reserve(quadCount());
+    for (std::size_t i = 0; i < quadCount(); i++) {
+        const auto& record = quads[i];
+        module.quads.push(static_cast<irStruct::OpCode>(record.op),
+                          operand(record, 0), operand(record, 1),
+                          operand(record, 2));
+    }
+
+    return module;
+}
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    length = static_cast<std::size_t>(st.st_size);
+
+    // An empty file cannot be mapped; the view reports it as truncated
+    if (length > 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        base = static_cast<const char*>(mapping);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (base != nullptr) {
+        ::munmap(const_cast<char*>(base), length);
+    }
+}
+
+}  // namespace irBinary
@@ -0,0 +1,174 @@
+#ifndef IRBINARY_H
+#define IRBINARY_H
+
+#include "irStruct.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Binary container of a module ("QIR" file). All records have a fixed width
+ * and are stored in host byte order, so a mapped file is validated and
+ * decoded without parsing:
+ *
+ *   Header
+ *   SymbolRecord[symbolCount]
+ *   QuadRecord[quadCount]
+ *   std::uint8_t tempTypes[tempCount]
+ *   char names[nameBytes]          (symbol names, then the texts of the
+ *                                   ImmText literals, not NUL terminated)
+ */
+namespace irBinary {
+
+constexpr std::array<char, 4> MAGIC{'Q', 'I', 'R', '\0'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/**
+ * @struct Header
+ * @brief File header: identification and the size of every section.
+ */
+struct Header {
+    char magic[4];              ///< MAGIC.
+    std::uint32_t version;      ///< VERSION of the writer.
+    std::uint32_t byteOrder;    ///< BYTE_ORDER_MARK as written by the host.
+    std::uint32_t symbolCount;  ///< Number of SymbolRecords.
+    std::uint32_t tempCount;    ///< Number of temporaries.
+    std::uint32_t quadCount;    ///< Number of QuadRecords.
+    std::uint32_t nameBytes;    ///< Size of the name pool with the texts.
+    std::uint32_t reserved;     ///< Zero.
+};
+
+/**
+ * @struct SymbolRecord
+ * @brief A symbol table entry. The name lives in the name pool.
+ */
+struct SymbolRecord {
+    std::uint32_t nameOffset;  ///< Offset of the name in the name pool.
+    std::uint32_t nameLength;  ///< Length of the name.
+    std::int32_t offset;       ///< Frame offset of the variable.
+    std::uint8_t type;         ///< irStruct::ValueType.
+    std::uint8_t reserved[3];  ///< Zero.
+};
+
+/**
+ * @struct QuadRecord
+ * @brief A quadruple. Operand i is described by kinds[i], types[i] and
+ * values[i]; values holds the index, the integer or the bits of the double.
+ * For an ImmText literal it holds the offset of the text in the name pool
+ * in the high 32 bits and its length in the low 32 bits.
+ */
+struct QuadRecord {
+    std::uint8_t op;         ///< irStruct::OpCode.
+    std::uint8_t kinds[3];   ///< irStruct::OperandKind of arg1, arg2, result.
+    std::uint8_t types[3];   ///< irStruct::ValueType of arg1, arg2, result.
+    std::uint8_t reserved;   ///< Zero.
+    std::int64_t values[3];  ///< Payload of arg1, arg2, result.
+};
+
+static_assert(sizeof(Header) == 32 && sizeof(SymbolRecord) == 16 &&
+                  sizeof(QuadRecord) == 32,
+              "QIR records must have a fixed width");
+static_assert(std::is_trivially_copyable_v<Header> &&
+                  std::is_trivially_copyable_v<SymbolRecord> &&
+                  std::is_trivially_copyable_v<QuadRecord>,
+              "QIR records are copied and mapped as raw bytes");
+
+/**
+ * @brief Serializes a module into the binary container.
+ *
+ * @param module The module to serialize.
+ * @return std::string The file contents.
+ */
+std::string serialize(const irStruct::Module& module);
+
+/**
+ * @class ModuleView
+ * @brief Read-only view of a binary module held in memory (a mapped file or
+ * a buffer). The records are validated in place; toModule() decodes them
+ * into the module the later stages run on.
+ */
+class ModuleView {
+public:
+    /**
+     * @brief Validates a buffer: the header, the section sizes, and every
+     * record, whose operations, operand kinds, types, indices and jump
+     * targets must exist in the module.
+     *
+     * @param data The buffer, aligned to 8 bytes.
+     * @param size The size of the buffer.
+     * @throws std::invalid_argument If the buffer is not a QIR module of this
+     * version and byte order, is truncated, or has an invalid record; the
+     * message names the record.
+     */
+    ModuleView(const char* data, std::size_t size);
+
+    std::size_t symbolCount() const { return head->symbolCount; }
+    std::size_t tempCount() const { return head->tempCount; }
+    std::size_t quadCount() const { return head->quadCount; }
+
+    /**
+     * @brief Returns the name of symbol i from the name pool.
+     */
+    std::string_view symbolName(std::size_t i) const {
+        return std::string_view(names + symbols[i].nameOffset,
+                                symbols[i].nameLength);
+    }
+
+    /**
+     * @brief Decodes operand slot (0: arg1, 1: arg2, 2: result) of a record.
+     */
+    irStruct::Operand operand(const QuadRecord& quad, int slot) const;
+
+    /**
+     * @brief Copies the view into an in-memory module.
+     *
+     * @return irStruct::Module The module.
+     */
+    irStruct::Module toModule() const;
+
+private:
+    const Header* head;            ///< The header.
+    const SymbolRecord* symbols;   ///< The symbol records.
+    const QuadRecord* quads;       ///< The quadruple records.
+    const std::uint8_t* temps;     ///< The temporary types.
+    const char* names;             ///< The name pool.
+};
+
+/**
+ * @class MappedFile
+ * @brief A file mapped read-only into memory for the lifetime of the object.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps a file.
+     *
+     * @param path The file to map.
+     * @throws std::runtime_error If the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return base; }
+    std::size_t size() const { return length; }
+
+    /**
+     * @brief Returns a view of the mapped module.
+     */
+    ModuleView view() const { return ModuleView(base, length); }
+
+private:
+    const char* base = nullptr;  ///< Start of the mapping.
+    std::size_t length = 0;      ///< Size of the mapping.
+};
+
+}  // namespace irBinary
+
+#endif  // IRBINARY_H
@@ -0,0 +1,360 @@
+#include "irCfg.h"
+#include "irUtil.h"
+#include <algorithm>
+#include <numeric>
+
+namespace irCfg {
+
+std::vector<std::pair<int, int>> findBlocks(const irStruct::QuadList& quads) {
+    const int count = static_cast<int>(quads.size());
+    std::vector<std::pair<int, int>> blocks;
+    if (count == 0) {
+        return blocks;
+    }
+
+    // Mark the entry points: jump targets, fall-throughs of conditional
+    // jumps, and I/O operations
+    std::vector<bool> entries(count, false);
+    entries[0] = true;
+    for (int i = 0; i < count; i++) {
+        const auto op = quads.op(i);
+        if (irUtil::isJump(op)) {
+            const int target = quads.result(i).index;
+            if (target >= 0 && target < count) {
+                entries[target] = true;
+            }
+            if (op != irStruct::OpCode::Jump && i < count - 1) {
+                entries[i + 1] = true;
+            }
+        }
+        if (op == irStruct::OpCode::Write || op == irStruct::OpCode::Read) {
+            entries[i] = true;
+        }
+    }
+
+    // A block runs from an entry point to a jump, End or the next entry
+    for (int first = 0; first < count;) {
+        if (!entries[first]) {
+            ++first;
+            continue;
+        }
+        int end = first + 1;
+        for (; end < count; ++end) {
+            const auto prev = quads.op(end - 1);
+            if (entries[end] || irUtil::isJump(prev) ||
+                prev == irStruct::OpCode::End) {
+                break;
+            }
+        }
+        blocks.emplace_back(first, end - 1);
+        first = end;
+    }
+    return blocks;
+}
+
+Cfg::Cfg(const irStruct::QuadList& quads)
+    : quadBlocks(quads.size(), -1) {
+    const auto ranges = findBlocks(quads);
+    blockList.resize(ranges.size());
+    for (size_t b = 0; b < ranges.size(); b++) {
+        blockList[b].first = ranges[b].first;
+        blockList[b].last = ranges[b].second;
+        for (int q = ranges[b].first; q <= ranges[b].second; q++) {
+            quadBlocks[q] = static_cast<int>(b);
+        }
+    }
+
+    // Successors: the jump target, and the next block unless the block ends
+    // with an unconditional jump or End
+    const int count = static_cast<int>(quads.size());
+    for (auto& block : blockList) {
+        const auto op = quads.op(block.last);
+        if (irUtil::isJump(op)) {
+            const int target = quads.result(block.last).index;
+            if (target >= 0 && target < count) {
+                block.taken = quadBlocks[target];
+            }
+        }
+        if (op != irStruct::OpCode::Jump && op != irStruct::OpCode::End &&
+            block.last + 1 < count) {
+            block.fallThrough = quadBlocks[block.last + 1];
+        }
+    }
+
+    // Predecessors, counted first and then filled in place
+    predecessorStart.assign(blockList.size() + 1, 0);
+    for (const auto& block : blockList) {
+        for (const int succ : {block.taken, block.fallThrough}) {
+            if (succ >= 0) {
+                predecessorStart[succ + 1]++;
+            }
+        }
+    }
+    for (size_t b = 0; b < blockList.size(); b++) {
+        predecessorStart[b + 1] += predecessorStart[b];
+    }
+    predecessorList.resize(predecessorStart.back());
+    std::vector<int> fill(predecessorStart.begin(), predecessorStart.end() - 1);
+    for (size_t b = 0; b < blockList.size(); b++) {
+        for (const int succ : {blockList[b].taken, blockList[b].fallThrough}) {
+            if (succ >= 0) {
+                predecessorList[fill[succ]++] = static_cast<int>(b);
+            }
+        }
+    }
+}
+
+DominatorTree::DominatorTree(const Cfg& cfg) {
+    const auto& blocks = cfg.blocks();
+    const int count = static_cast<int>(blocks.size());
+    immediate.assign(count, -1);
+    orderIndex.assign(count, -1);
+    enter.assign(count, 0);
+    leave.assign(count, 0);
+    if (count == 0) {
+        return;
+    }
+
+    // Postorder from the entry, searched with an explicit stack of blocks
+    // and the next successor to try, fall-through first
+    std::vector<bool> seen(count, false);
+    std::vector<std::pair<int, int>> stack{{0, 0}};
+    seen[0] = true;
+    while (!stack.empty()) {
+        auto& [block, edge] = stack.back();
+        if (edge == 2) {
+            order.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+        const int succ =
+            edge++ == 0 ? blocks[block].fallThrough : blocks[block].taken;
+        if (succ >= 0 && !seen[succ]) {
+            seen[succ] = true;
+            stack.emplace_back(succ, 0);
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    for (size_t i = 0; i < order.size(); i++) {
+        orderIndex[order[i]] = static_cast<int>(i);
+    }
+
+    // Each block's immediate dominator is where the dominator tree paths of
+    // its processed predecessors meet; repeat until nothing changes
+    auto intersect = [this](int a, int b) {
+        while (a != b) {
+            while (orderIndex[a] > orderIndex[b]) {
+                a = immediate[a];
+            }
+            while (orderIndex[b] > orderIndex[a]) {
+                b = immediate[b];
+            }
+        }
+        return a;
+    };
+    immediate[0] = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t i = 1; i < order.size(); i++) {
+            const int block = order[i];
+            int dominator = -1;
+            const auto [first, last] = cfg.predecessors(block);
+            for (auto pred = first; pred != last; ++pred) {
+                if (immediate[*pred] >= 0) {
+                    dominator =
+                        dominator < 0 ? *pred : intersect(*pred, dominator);
+                }
+            }
+            if (dominator != immediate[block]) {
+                immediate[block] = dominator;
+                changed = true;
+            }
+        }
+    }
+
+    // Number the dominator tree in pre- and postorder, so that a dominates b
+    // iff b's interval lies within a's
+    std::vector<int> childStart(count + 1, 0);
+    for (size_t i = 1; i < order.size(); i++) {
+        childStart[immediate[order[i]] + 1]++;
+    }
+    std::partial_sum(childStart.begin(), childStart.end(), childStart.begin());
+    std::vector<int> children(childStart.back());
+    std::vector<int> fill(childStart.begin(), childStart.end() - 1);
+    for (size_t i = 1; i < order.size(); i++) {
+        children[fill[immediate[order[i]]]++] = order[i];
+    }
+    int clock = 0;
+    enter[0] = clock++;
+    stack.assign(1, {0, childStart[0]});
+    while (!stack.empty()) {
+        auto& [block, next] = stack.back();
+        if (next == childStart[block + 1]) {
+            leave[block] = clock++;
+            stack.pop_back();
+            continue;
+        }
+        const int child = children[next++];
+        enter[child] = clock++;
+        stack.emplace_back(child, childStart[child]);
+    }
+}
+
+LoopNest::LoopNest(const Cfg& cfg, const DominatorTree& dominators)
+    : innermost(cfg.blocks().size(), -1) {
+    const int count = static_cast<int>(cfg.blocks().size());
+
+    // Blocks already in a loop lead to the header of the outermost loop
+    // found around them so far
+    std::vector<int> leader(count);
+    std::iota(leader.begin(), leader.end(), 0);
+    auto find = [&leader](int block) {
+        while (leader[block] != block) {
+            leader[block] = leader[leader[block]];
+            block = leader[block];
+        }
+        return block;
+    };
+
+    std::vector<int> stamp(count, -1);
+    std::vector<int> pending;
+    const auto& order = dominators.reversePostorder();
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        Loop loop;
+        loop.header = *it;
+        const auto [first, last] = cfg.predecessors(loop.header);
+        for (auto pred = first; pred != last; ++pred) {
+            if (dominators.dominates(loop.header, *pred)) {
+                loop.latches.push_back(*pred);
+            }
+        }
+        if (loop.latches.empty()) {
+            continue;
+        }
+
+        // Walk back from the latches to the header, taking in the blocks
+        // not yet in a loop and the outermost loops found inside this one
+        const int index = static_cast<int>(loopList.size());
+        auto visit = [&](int block) {
+            block = find(block);
+            if (stamp[block] != index) {
+                stamp[block] = index;
+                pending.push_back(block);
+            }
+        };
+        innermost[loop.header] = index;
+        stamp[loop.header] = index;
+        for (const int latch : loop.latches) {
+            visit(latch);
+        }
+        while (!pending.empty()) {
+            const int block = pending.back();
+            pending.pop_back();
+            if (innermost[block] < 0) {
+                innermost[block] = index;
+            } else {
+                loopList[innermost[block]].parent = index;
+            }
+            leader[block] = loop.header;
+            const auto [from, to] = cfg.predecessors(block);
+            for (auto pred = from; pred != to; ++pred) {
+                if (dominators.reachable(*pred)) {
+                    visit(*pred);
+                }
+            }
+        }
+        loopList.push_back(std::move(loop));
+    }
+
+    // Enclosing loops come later in the list
+    const int loopCount = static_cast<int>(loopList.size());
+    for (auto it = loopList.rbegin(); it != loopList.rend(); ++it) {
+        it->depth = it->parent < 0 ? 1 : loopList[it->parent].depth + 1;
+    }
+
+    // Lay out the blocks of each loop, then those of the loops nested in it,
+    // walking the loop tree from the outermost loops
+    std::vector<int> childStart(loopCount + 2, 0);
+    for (const auto& loop : loopList) {
+        childStart[loop.parent + 2]++;
+    }
+    std::vector<int> ownStart(loopCount + 1, 0);
+    for (int block = 0; block < count; block++) {
+        if (innermost[block] >= 0) {
+            ownStart[innermost[block] + 1]++;
+        }
+    }
+    std::partial_sum(childStart.begin(), childStart.end(), childStart.begin());
+    std::partial_sum(ownStart.begin(), ownStart.end(), ownStart.begin());
+    std::vector<int> children(loopCount);
+    std::vector<int> own(ownStart.back());
+    std::vector<int> childFill(childStart.begin(), childStart.end() - 1);
+    std::vector<int> ownFill(ownStart.begin(), ownStart.end() - 1);
+    for (int l = 0; l < loopCount; l++) {
+        children[childFill[loopList[l].parent + 1]++] = l;
+    }
+    for (int block = 0; block < count; block++) {
+        if (innermost[block] >= 0) {
+            own[ownFill[innermost[block]]++] = block;
+        }
+    }
+
+    position.assign(count, -1);
+    ranges.resize(loopCount);
+    layout.reserve(own.size());
+    std::vector<std::pair<int, int>> stack;  // Loop, next child; -1 is root
+    stack.emplace_back(-1, childStart[0]);
+    while (!stack.empty()) {
+        auto& [loop, next] = stack.back();
+        if (next == childStart[loop + 2]) {
+            if (loop >= 0) {
+                ranges[loop].second = static_cast<int>(layout.size());
+            }
+            stack.pop_back();
+            continue;
+        }
+        const int child = children[next++];
+        ranges[child].first = static_cast<int>(layout.size());
+        for (int i = ownStart[child]; i < ownStart[child + 1]; i++) {
+            position[own[i]] = static_cast<int>(layout.size());
+            layout.push_back(own[i]);
+        }
+        stack.emplace_back(child, childStart[child + 1]);
+    }
+}
+
+const Cfg& Analysis::cfg() {
+    refresh();
+    if (!graph) {
+        graph.emplace(quads);
+    }
+    return *graph;
+}
+
+const DominatorTree& Analysis::dominators() {
+    refresh();
+    if (!tree) {
+        tree.emplace(cfg());
+    }
+    return *tree;
+}
+
+const LoopNest& Analysis::loops() {
+    refresh();
+    if (!nest) {
+        nest.emplace(cfg(), dominators());
+    }
+    return *nest;
+}
+
+void Analysis::refresh() {
+    if (quads.version() == version) {
+        return;
+    }
+    version = quads.version();
+    nest.reset();
+    tree.reset();
+    graph.reset();
+}
+
+}  // namespace irCfg
@@ -0,0 +1,259 @@
+#ifndef IRCFG_H
+#define IRCFG_H
+
+#include "irStruct.h"
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace irCfg {
+
+/**
+ * @brief Splits quadruples into basic blocks. A block starts at the first
+ * quadruple, at a jump target, after a conditional jump and at every R or W;
+ * it ends at a jump, at End, or before the next start. Quadruples following
+ * the end of a block without starting one belong to no block.
+ *
+ * @param quads The quadruples.
+ * @return std::vector<std::pair<int, int>> The first and last quadruple of
+ * each block, in program order.
+ */
+std::vector<std::pair<int, int>> findBlocks(const irStruct::QuadList& quads);
+
+/**
+ * @struct Block
+ * @brief A basic block and the blocks control can pass to after it.
+ */
+struct Block {
+    int first = 0;         ///< Index of the first quadruple.
+    int last = 0;          ///< Index of the last quadruple.
+    int taken = -1;        ///< Block a jump at the end goes to, or -1.
+    int fallThrough = -1;  ///< Block reached without jumping, or -1.
+};
+
+/**
+ * @class Cfg
+ * @brief The control flow graph of a list of quadruples: the basic blocks of
+ * findBlocks() with their successor and predecessor edges.
+ */
+class Cfg {
+public:
+    /**
+     * @brief Builds the graph in time linear in the number of quadruples.
+     *
+     * @param quads The quadruples; jump targets must be resolved.
+     */
+    explicit Cfg(const irStruct::QuadList& quads);
+
+    /// The blocks, in program order; block 0 is the entry.
+    const std::vector<Block>& blocks() const { return blockList; }
+
+    /**
+     * @brief Finds the block a quadruple belongs to.
+     *
+     * @param quad The quadruple index.
+     * @return int The block, or -1 if the quadruple is in none.
+     */
+    int blockOf(int quad) const { return quadBlocks[quad]; }
+
+    /**
+     * @brief Lists the blocks control can come from.
+     *
+     * @param block The block.
+     * @return A pair of pointers delimiting the predecessors.
+     */
+    std::pair<const int*, const int*> predecessors(int block) const {
+        return {predecessorList.data() + predecessorStart[block],
+                predecessorList.data() + predecessorStart[block + 1]};
+    }
+
+private:
+    std::vector<Block> blockList;  ///< The blocks.
+    std::vector<int> quadBlocks;   ///< Block of each quadruple, or -1.
+    /// Index in predecessorList of each block's first predecessor, plus one
+    /// past the last.
+    std::vector<int> predecessorStart;
+    std::vector<int> predecessorList;  ///< Predecessors, grouped by block.
+};
+
+/**
+ * @class DominatorTree
+ * @brief The dominators of the blocks of a Cfg: block a dominates block b if
+ * every path from the entry to b passes through a. Computed with the
+ * iterative algorithm of Cooper, Harvey and Kennedy over reverse postorder,
+ * which settles in two or three passes over the graphs of structured code.
+ * Blocks the entry cannot reach have no dominators.
+ */
+class DominatorTree {
+public:
+    /**
+     * @brief Computes the dominators of every block.
+     *
+     * @param cfg The control flow graph.
+     */
+    explicit DominatorTree(const Cfg& cfg);
+
+    /**
+     * @brief Finds the immediate dominator of a block.
+     *
+     * @param block The block.
+     * @return int The closest block that strictly dominates it; the entry for
+     * itself, and -1 for blocks that cannot be reached.
+     */
+    int idom(int block) const { return immediate[block]; }
+
+    /// Whether the entry can reach a block.
+    bool reachable(int block) const { return orderIndex[block] >= 0; }
+
+    /**
+     * @brief Checks in constant time whether a block dominates another, each
+     * block dominating itself.
+     *
+     * @param a The dominating block.
+     * @param b The dominated block.
+     * @return bool False if either block cannot be reached.
+     */
+    bool dominates(int a, int b) const {
+        return reachable(a) && reachable(b) && enter[a] <= enter[b] &&
+               leave[b] <= leave[a];
+    }
+
+    /// The reachable blocks in reverse postorder, starting with the entry.
+    const std::vector<int>& reversePostorder() const { return order; }
+
+private:
+    std::vector<int> immediate;   ///< Immediate dominator of each block.
+    std::vector<int> order;       ///< Reachable blocks in reverse postorder.
+    std::vector<int> orderIndex;  ///< Position in order, or -1.
+    std::vector<int> enter;  ///< Preorder number in the dominator tree.
+    std::vector<int> leave;  ///< Postorder number in the dominator tree.
+};
+
+/**
+ * @struct Loop
+ * @brief A natural loop: a header dominating the blocks that jump back to
+ * it, and the blocks that reach those without passing through the header.
+ * Loops sharing a header are one loop.
+ */
+struct Loop {
+    int header = 0;            ///< The block every iteration starts at.
+    int parent = -1;           ///< Innermost enclosing loop, or -1.
+    int depth = 1;             ///< Nesting depth, 1 for an outermost loop.
+    std::vector<int> latches;  ///< Blocks jumping back to the header.
+};
+
+/**
+ * @class LoopNest
+ * @brief The natural loops of a Cfg and how they nest; for this language,
+ * the loops of while statements. Headers are visited from the last in
+ * reverse postorder, so inner loops are found first, and a union-find over
+ * the blocks already assigned lets an outer loop step over an inner one
+ * through its header, which takes near-linear time. The blocks are then
+ * laid out so that each loop's, nested loops included, are contiguous.
+ */
+class LoopNest {
+public:
+    /**
+     * @brief Finds the loops of a graph.
+     *
+     * @param cfg The control flow graph.
+     * @param dominators Its dominators.
+     */
+    LoopNest(const Cfg& cfg, const DominatorTree& dominators);
+
+    /// The loops, each inner loop before the loops around it.
+    const std::vector<Loop>& loops() const { return loopList; }
+
+    /**
+     * @brief Finds the innermost loop a block belongs to.
+     *
+     * @param block The block.
+     * @return int The index of the loop, or -1 outside loops.
+     */
+    int loopOf(int block) const { return innermost[block]; }
+
+    /**
+     * @brief Returns the number of loops around a block.
+     *
+     * @param block The block.
+     * @return int The depth, 0 outside loops.
+     */
+    int depth(int block) const {
+        return innermost[block] < 0 ? 0 : loopList[innermost[block]].depth;
+    }
+
+    /**
+     * @brief Lists the blocks of a loop: those of the loop itself, then
+     * those of each loop nested in it.
+     *
+     * @param loop The index of the loop.
+     * @return A pair of pointers delimiting the blocks.
+     */
+    std::pair<const int*, const int*> blocks(int loop) const {
+        return {layout.data() + ranges[loop].first,
+                layout.data() + ranges[loop].second};
+    }
+
+    /**
+     * @brief Checks in constant time whether a block belongs to a loop or a
+     * loop nested in it.
+     *
+     * @param loop The index of the loop.
+     * @param block The block.
+     * @return bool True if the block is in the loop.
+     */
+    bool contains(int loop, int block) const {
+        return innermost[block] >= 0 && position[block] >= ranges[loop].first &&
+               position[block] < ranges[loop].second;
+    }
+
+private:
+    std::vector<Loop> loopList;  ///< The loops.
+    std::vector<int> innermost;  ///< Innermost loop of each block, or -1.
+    std::vector<int> layout;     ///< The blocks in loops, grouped by loop.
+    std::vector<int> position;   ///< Index of each block in layout.
+    /// Range of each loop's blocks in layout.
+    std::vector<std::pair<int, int>> ranges;
+};
+
+/**
+ * @class Analysis
+ * @brief Computes the control flow graph, dominators and loops of a list of
+ * quadruples when they are first asked for, and keeps them until the
+ * quadruples change, as told by QuadList::version(). The results returned
+ * before a change are then computed again, so references to them must not
+ * be kept across it.
+ */
+class Analysis {
+public:
+    /**
+     * @brief Analyzes a list of quadruples, which must outlive the analysis.
+     *
+     * @param quads The quadruples; jump targets must be resolved.
+     */
+    explicit Analysis(const irStruct::QuadList& quads) : quads(quads) {}
+
+    /// The control flow graph.
+    const Cfg& cfg();
+
+    /// The dominators of the blocks of cfg().
+    const DominatorTree& dominators();
+
+    /// The loops of cfg().
+    const LoopNest& loops();
+
+private:
+    /// Drops the results if the quadruples changed since they were computed.
+    void refresh();
+
+    const irStruct::QuadList& quads;    ///< The quadruples analyzed.
+    std::uint64_t version = 0;          ///< quads.version() of the results.
+    std::optional<Cfg> graph;           ///< Cached cfg().
+    std::optional<DominatorTree> tree;  ///< Cached dominators().
+    std::optional<LoopNest> nest;       ///< Cached loops().
+};
+
+}  // namespace irCfg
+
+#endif  // IRCFG_H
@@ -0,0 +1,1116 @@
+#include "irOpt.h"
+#include "irCfg.h"
+#include "irUtil.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace irOpt {
+
+namespace {
+
+using irStruct::OpCode;
+using irStruct::Operand;
+using irStruct::OperandKind;
+using irStruct::ValueType;
+
+// Lattice values below the constants; a constant is its index in the pool
+constexpr int TOP = -1;     // No value reaches the variable yet
+constexpr int BOTTOM = -2;  // The value is not known at compile time
+
+int meet(int a, int b) {
+    if (a == TOP) {
+        return b;
+    }
+    if (b == TOP || a == b) {
+        return a;
+    }
+    return BOTTOM;
+}
+
+// Interns literals, so that two constants are equal iff their indices are.
+// Doubles are compared by bit pattern, keeping 0.0 apart from -0.0; literals
+// kept as text by the index of their text
+class ConstantPool {
+public:
+    int intern(const Operand& literal) {
+        std::uint64_t bits = 0;
+        if (literal.kind == OperandKind::ImmDouble) {
+            std::memcpy(&bits, &literal.doubleValue, sizeof(bits));
+        } else if (literal.kind == OperandKind::ImmText) {
+            bits = static_cast<std::uint64_t>(literal.index);
+        } else {
+            bits = static_cast<std::uint64_t>(literal.intValue);
+        }
+        auto& indices = literal.kind == OperandKind::ImmInt ? intIndices
+                        : literal.kind == OperandKind::ImmDouble
+                            ? doubleIndices
+                            : textIndices;
+        auto [it, inserted] =
+            indices.try_emplace(bits, static_cast<int>(literals.size()));
+        if (inserted) {
+            literals.push_back(literal);
+        }
+        return it->second;
+    }
+
+    const Operand& at(int value) const { return literals[value]; }
+
+private:
+    std::vector<Operand> literals;
+    std::unordered_map<std::uint64_t, int> intIndices;
+    std::unordered_map<std::uint64_t, int> doubleIndices;
+    std::unordered_map<std::uint64_t, int> textIndices;
+};
+
+// Removes the quadruples not kept and moves each jump to the first kept
+// quadruple at or after its target. The last quadruple stays as the target
+// of jumps past the end
+void removeQuads(irStruct::QuadList& quads, std::vector<bool> keep) {
+    const int count = static_cast<int>(quads.size());
+    keep[count - 1] = true;
+    std::vector<int> newIndex(count);
+    int position = 0;
+    for (int i = 0; i < count; i++) {
+        position += keep[i];
+    }
+    irStruct::QuadList result;
+    result.reserve(position);
+    for (int i = count - 1; i >= 0; i--) {
+        position -= keep[i];
+        newIndex[i] = position;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!keep[i]) {
+            continue;
+        }
+        auto quad = quads.at(i);
+        const int target = quad.result.index;
+        if (irUtil::isJump(quad.op) && target >= 0 && target < count) {
+            quad.result.index = newIndex[target];
+        }
+        result.push(quad);
+    }
+    quads = std::move(result);
+}
+
+// Type of a variable or a literal
+ValueType typeOf(const irStruct::Module& module, const Operand& operand) {
+    return operand.kind == OperandKind::Symbol
+               ? module.symbols[operand.index].type
+               : operand.type;
+}
+
+// Calls f with each operand a quadruple reads: its arguments, and the
+// result of W
+template <typename F>
+void forEachRead(const irStruct::QuadList& quads, int q, F&& f) {
+    for (auto* operand : {&quads.arg1(q), &quads.arg2(q)}) {
+        if (operand->isVariable()) {
+            f(*operand);
+        }
+    }
+    if (quads.op(q) == OpCode::Write && quads.result(q).isVariable()) {
+        f(quads.result(q));
+    }
+}
+
+// Whether a quadruple only computes its result, so it can be dropped when
+// the result is not needed. A division may trap unless its divisor is a
+// literal other than 0 and -1
+bool isPure(OpCode op, const Operand& divisor) {
+    if (op == OpCode::Div) {
+        return divisor.kind == OperandKind::ImmInt
+                   ? divisor.intValue != 0 && divisor.intValue != -1
+                   : divisor.kind == OperandKind::ImmDouble &&
+                         divisor.doubleValue != 0;
+    }
+    return op < OpCode::Jump;
+}
+
+bool isPure(const irStruct::QuadList& quads, int q) {
+    return isPure(quads.op(q), quads.arg2(q));
+}
+
+// Number of times each temporary is read
+std::vector<int> countTempReads(const irStruct::QuadList& quads,
+                                int tempCount) {
+    std::vector<int> reads(tempCount, 0);
+    for (int q = 0; q < static_cast<int>(quads.size()); q++) {
+        forEachRead(quads, q, [&reads](const Operand& operand) {
+            if (operand.kind == OperandKind::Temp) {
+                reads[operand.index]++;
+            }
+        });
+    }
+    return reads;
+}
+
+// Sparse conditional constant propagation; see propagateConstants()
+class ConstantPropagation {
+public:
+    explicit ConstantPropagation(irStruct::Module& module)
+        : module(module),
+          quads(module.quads),
+          cfg(module.quads),
+          symbolCount(static_cast<int>(module.symbols.size())),
+          blockCount(static_cast<int>(cfg.blocks().size())) {}
+
+    bool run() {
+        if (blockCount == 0) {
+            return false;
+        }
+        findTemporaries();
+        blockIn.assign(static_cast<std::size_t>(blockCount) * symbolCount,
+                       TOP);
+        executable.assign(blockCount, false);
+        queued.assign(blockCount, false);
+
+        // Nothing is known about the variables on entry
+        std::fill(blockIn.begin(), blockIn.begin() + symbolCount, BOTTOM);
+        executable[0] = true;
+        enqueue(0);
+        while (!worklist.empty()) {
+            const int block = worklist.back();
+            worklist.pop_back();
+            queued[block] = false;
+            visit(block);
+        }
+        return rewrite();
+    }
+
+private:
+    irStruct::Module& module;
+    irStruct::QuadList& quads;
+    irCfg::Cfg cfg;
+    ConstantPool pool;
+    const int symbolCount;
+    const int blockCount;
+
+    std::vector<int> tempValues;      // Value of each temporary
+    std::vector<int> tempUserStart;   // Readers of temporary t start here
+    std::vector<int> tempUserList;    // Blocks reading each temporary
+    std::vector<int> blockIn;         // Variable values entering each block
+    std::vector<bool> executable;     // Blocks reached so far
+    std::vector<bool> queued;         // Blocks on the worklist
+    std::vector<int> worklist;        // Blocks to evaluate again
+    std::vector<int> state;           // Variable values inside a block
+
+    // Temporaries written more than once start out unknown; the blocks
+    // reading each temporary are listed to be revisited when it changes
+    void findTemporaries() {
+        const int tempCount = static_cast<int>(module.temps.size());
+        std::vector<int> defs(tempCount, 0);
+        tempUserStart.assign(tempCount + 1, 0);
+        auto forEachTemp = [this](int q, auto&& f) {
+            forEachRead(quads, q, [&f](const Operand& operand) {
+                if (operand.kind == OperandKind::Temp) {
+                    f(operand.index);
+                }
+            });
+        };
+        for (const auto& block : cfg.blocks()) {
+            for (int q = block.first; q <= block.last; q++) {
+                const auto& result = quads.result(q);
+                if (result.kind == OperandKind::Temp &&
+                    quads.op(q) != OpCode::Write) {
+                    defs[result.index]++;
+                }
+                forEachTemp(q, [this](int t) { tempUserStart[t + 1]++; });
+            }
+        }
+        for (int t = 0; t < tempCount; t++) {
+            tempUserStart[t + 1] += tempUserStart[t];
+        }
+        tempUserList.resize(tempUserStart.back());
+        std::vector<int> fill(tempUserStart.begin(), tempUserStart.end() - 1);
+        const auto& blocks = cfg.blocks();
+        for (int b = 0; b < blockCount; b++) {
+            for (int q = blocks[b].first; q <= blocks[b].last; q++) {
+                forEachTemp(q, [&](int t) { tempUserList[fill[t]++] = b; });
+            }
+        }
+
+        tempValues.resize(tempCount);
+        for (int t = 0; t < tempCount; t++) {
+            tempValues[t] = defs[t] == 1 ? TOP : BOTTOM;
+        }
+    }
+
+    void enqueue(int block) {
+        if (!queued[block]) {
+            queued[block] = true;
+            worklist.push_back(block);
+        }
+    }
+
+    void setTemp(int temp, int value) {
+        if (tempValues[temp] == value) {
+            return;
+        }
+        tempValues[temp] = value;
+        for (int i = tempUserStart[temp]; i < tempUserStart[temp + 1]; i++) {
+            const int block = tempUserList[i];
+            if (executable[block]) {
+                enqueue(block);
+            }
+        }
+    }
+
+    int valueOf(const Operand& operand) {
+        switch (operand.kind) {
+            case OperandKind::Symbol:
+                return state[operand.index];
+            case OperandKind::Temp:
+                // Read where its definition has not run: give up on it
+                if (tempValues[operand.index] == TOP) {
+                    setTemp(operand.index, BOTTOM);
+                }
+                return tempValues[operand.index];
+            case OperandKind::ImmInt:
+            case OperandKind::ImmDouble:
+                return pool.intern(operand);
+            default:
+                return BOTTOM;
+        }
+    }
+
+    // Value of the result of a computing quadruple
+    int evaluate(int q) {
+        const auto op = quads.op(q);
+        const int a = valueOf(quads.arg1(q));
+        if (op == OpCode::Assign) {
+            return a;
+        }
+        const int b = op == OpCode::Not ? a : valueOf(quads.arg2(q));
+        if (a == BOTTOM || b == BOTTOM) {
+            return BOTTOM;
+        }
+        if (a == TOP || b == TOP) {
+            return TOP;
+        }
+        const auto result = irUtil::fold(
+            op, pool.at(a), op == OpCode::Not ? Operand() : pool.at(b));
+        return result ? pool.intern(*result) : BOTTOM;
+    }
+
+    // Stores a value; a constant of another type than the destination is
+    // converted at run time, so it is not tracked
+    void assign(const Operand& destination, int value) {
+        if (value >= 0 &&
+            pool.at(value).type != typeOf(module, destination)) {
+            value = BOTTOM;
+        }
+        if (destination.kind == OperandKind::Symbol) {
+            state[destination.index] = value;
+        } else if (destination.kind == OperandKind::Temp) {
+            setTemp(destination.index,
+                    meet(tempValues[destination.index], value));
+        }
+    }
+
+    // Whether a conditional jump is taken: 1 or 0 if known, -1 otherwise
+    int outcome(int q) {
+        const auto op = quads.op(q);
+        const int a = valueOf(quads.arg1(q));
+        if (op == OpCode::JumpNz) {
+            if (a < 0 || pool.at(a).kind != OperandKind::ImmInt) {
+                return -1;
+            }
+            return pool.at(a).intValue != 0;
+        }
+        const int b = valueOf(quads.arg2(q));
+        if (a < 0 || b < 0) {
+            return -1;
+        }
+        const auto result =
+            irUtil::fold(irUtil::fromJump(op), pool.at(a), pool.at(b));
+        return result ? result->intValue != 0 : -1;
+    }
+
+    // Runs the computations of a block on its entry values
+    void enter(int block) {
+        const auto first = blockIn.begin() +
+                           static_cast<std::ptrdiff_t>(block) * symbolCount;
+        state.assign(first, first + symbolCount);
+    }
+
+    void step(int q) {
+        const auto op = quads.op(q);
+        if (op == OpCode::Read) {
+            assign(quads.result(q), BOTTOM);
+        } else if (op < OpCode::Jump) {
+            assign(quads.result(q), evaluate(q));
+        }
+    }
+
+    // Merges the values leaving a block into a successor
+    void flow(int successor) {
+        if (successor < 0) {
+            return;
+        }
+        bool changed = !executable[successor];
+        executable[successor] = true;
+        int* in = blockIn.data() +
+                  static_cast<std::ptrdiff_t>(successor) * symbolCount;
+        for (int s = 0; s < symbolCount; s++) {
+            const int value = meet(in[s], state[s]);
+            if (value != in[s]) {
+                in[s] = value;
+                changed = true;
+            }
+        }
+        if (changed) {
+            enqueue(successor);
+        }
+    }
+
+    void visit(int b) {
+        const auto& block = cfg.blocks()[b];
+        enter(b);
+        for (int q = block.first; q <= block.last; q++) {
+            step(q);
+        }
+        const auto op = quads.op(block.last);
+        const int taken = irUtil::isConditionalJump(op) ? outcome(block.last)
+                                                        : -1;
+        if (taken != 0) {
+            flow(block.taken);
+        }
+        if (taken != 1) {
+            flow(block.fallThrough);
+        }
+    }
+
+    // Replaces a variable operand by its constant value
+    bool substitute(Operand& operand) {
+        if (!operand.isVariable()) {
+            return false;
+        }
+        const int value = valueOf(operand);
+        if (value < 0) {
+            return false;
+        }
+        operand = pool.at(value);
+        return true;
+    }
+
+    bool rewrite() {
+        const int count = static_cast<int>(quads.size());
+        std::vector<bool> keep(count, false);
+        bool changed = false;
+        const auto& blocks = cfg.blocks();
+        for (int b = 0; b < blockCount; b++) {
+            if (!executable[b]) {
+                continue;
+            }
+            enter(b);
+            for (int q = blocks[b].first; q <= blocks[b].last; q++) {
+                keep[q] = true;
+                const auto op = quads.op(q);
+                if (irUtil::isConditionalJump(op)) {
+                    const int taken = outcome(q);
+                    if (taken == 1) {
+                        quads.setOp(q, OpCode::Jump);
+                        quads.setArg1(q, Operand());
+                        quads.setArg2(q, Operand());
+                    } else if (taken == 0) {
+                        keep[q] = false;
+                    } else {
+                        Operand arg1 = quads.arg1(q);
+                        Operand arg2 = quads.arg2(q);
+                        if (substitute(arg1) | substitute(arg2)) {
+                            quads.setArg1(q, arg1);
+                            quads.setArg2(q, arg2);
+                            changed = true;
+                        }
+                        continue;
+                    }
+                    changed = true;
+                    continue;
+                }
+                if (op >= OpCode::Jump) {
+                    step(q);
+                    continue;
+                }
+
+                // Operands are looked up before the result is stored, which
+                // may overwrite one of them
+                Operand arg1 = quads.arg1(q);
+                Operand arg2 = quads.arg2(q);
+                const bool substituted = substitute(arg1) | substitute(arg2);
+                step(q);
+
+                // A known result replaces the operation computing it
+                const int value = valueOf(quads.result(q));
+                if (value >= 0) {
+                    if (op != OpCode::Assign ||
+                        quads.arg1(q) != pool.at(value)) {
+                        quads.setOp(q, OpCode::Assign);
+                        quads.setArg1(q, pool.at(value));
+                        quads.setArg2(q, Operand());
+                        changed = true;
+                    }
+                } else if (substituted) {
+                    quads.setArg1(q, arg1);
+                    quads.setArg2(q, arg2);
+                    changed = true;
+                }
+            }
+        }
+
+        if (std::find(keep.begin(), keep.end() - 1, false) != keep.end() - 1) {
+            removeQuads(quads, std::move(keep));
+            return true;
+        }
+        return changed;
+    }
+};
+
+// An operation on value numbers; see numberValues()
+struct Expression {
+    OpCode op;
+    int a;  // Number of the first operand
+    int b;  // Number of the second operand, or 0 for Not
+
+    bool operator==(const Expression& other) const {
+        return op == other.op && a == other.a && b == other.b;
+    }
+};
+
+struct ExpressionHash {
+    std::size_t operator()(const Expression& e) const {
+        const auto operands =
+            static_cast<std::uint64_t>(static_cast<std::uint32_t>(e.a)) << 32 |
+            static_cast<std::uint32_t>(e.b);
+        return std::hash<std::uint64_t>()(
+            operands ^ static_cast<std::uint64_t>(e.op) * 0x9E3779B97F4A7C15);
+    }
+};
+
+// Operations whose operands can be swapped
+bool isCommutative(OpCode op) {
+    return op == OpCode::Add || op == OpCode::Mul || op == OpCode::Eq ||
+           op == OpCode::Ne || op == OpCode::And || op == OpCode::Or;
+}
+
+// The conditional jump taken exactly when one comparing integers is not
+OpCode invertJump(OpCode op) {
+    switch (op) {
+        case OpCode::JumpEq:
+            return OpCode::JumpNe;
+        case OpCode::JumpNe:
+            return OpCode::JumpEq;
+        case OpCode::JumpLt:
+            return OpCode::JumpGe;
+        case OpCode::JumpLe:
+            return OpCode::JumpGt;
+        case OpCode::JumpGt:
+            return OpCode::JumpLe;
+        default:
+            return OpCode::JumpLt;
+    }
+}
+
+}  // namespace
+
+std::optional<Pass> parsePass(std::string_view name) {
+    if (name == "sccp") {
+        return Pass::ConstantPropagation;
+    }
+    if (name == "copy") {
+        return Pass::CopyPropagation;
+    }
+    if (name == "dce") {
+        return Pass::DeadCodeElimination;
+    }
+    if (name == "lvn") {
+        return Pass::ValueNumbering;
+    }
+    if (name == "jumps") {
+        return Pass::JumpThreading;
+    }
+    if (name == "licm") {
+        return Pass::LoopInvariantCodeMotion;
+    }
+    return std::nullopt;
+}
+
+void optimize(irStruct::Module& module, const std::vector<Pass>& passes) {
+    // Kept for as long as the passes leave the quadruples alone
+    irCfg::Analysis analysis(module.quads);
+    for (const auto pass : passes) {
+        switch (pass) {
+            case Pass::ConstantPropagation:
+                propagateConstants(module);
+                break;
+            case Pass::CopyPropagation:
+                propagateCopies(module);
+                break;
+            case Pass::DeadCodeElimination:
+                removeDeadTemporaries(module);
+                break;
+            case Pass::ValueNumbering:
+                numberValues(module);
+                break;
+            case Pass::JumpThreading:
+                threadJumps(module);
+                break;
+            case Pass::LoopInvariantCodeMotion:
+                hoistInvariants(module, analysis);
+                break;
+        }
+    }
+}
+
+bool propagateConstants(irStruct::Module& module) {
+    return ConstantPropagation(module).run();
+}
+
+bool propagateCopies(irStruct::Module& module) {
+    auto& quads = module.quads;
+    const int symbolCount = static_cast<int>(module.symbols.size());
+    const int tempCount = static_cast<int>(module.temps.size());
+    auto variable = [symbolCount](const Operand& operand) {
+        return operand.kind == OperandKind::Symbol
+                   ? operand.index
+                   : symbolCount + operand.index;
+    };
+
+    // A copy (=, source, -, Tn) holds in its block until the source is
+    // written again; each write of a variable starts a new version of it
+    struct Copy {
+        Operand source;
+        int version = 0;  // Version of the source when it was copied
+        int block = -1;   // Block of the copy, or -1 if there is none
+    };
+    std::vector<Copy> copies(tempCount);
+    std::vector<int> versions(symbolCount + tempCount, 0);
+    std::vector<int> reads = countTempReads(quads, tempCount);
+    std::vector<int> definitions(tempCount, -1);  // Last computation of Tn
+    std::vector<int> lastAccess(symbolCount, -1);  // Last read or write
+    std::vector<bool> keep(quads.size(), true);
+    bool changed = false;
+
+    const auto blocks = irCfg::findBlocks(quads);
+    for (int b = 0; b < static_cast<int>(blocks.size()); b++) {
+        const auto [first, last] = blocks[b];
+        for (int q = first; q <= last; q++) {
+            const auto op = quads.op(q);
+            const auto& result = quads.result(q);
+            if (op == OpCode::Write) {
+                if (result.kind == OperandKind::Symbol) {
+                    lastAccess[result.index] = q;
+                }
+                continue;
+            }
+
+            // Read the sources of copies instead of the temporaries
+            for (int slot = 0; slot < 2; slot++) {
+                Operand operand = slot == 0 ? quads.arg1(q) : quads.arg2(q);
+                if (operand.kind == OperandKind::Temp) {
+                    const auto& copy = copies[operand.index];
+                    if (copy.block == b &&
+                        (!copy.source.isVariable() ||
+                         versions[variable(copy.source)] == copy.version)) {
+                        reads[operand.index]--;
+                        operand = copy.source;
+                        if (operand.kind == OperandKind::Temp) {
+                            reads[operand.index]++;
+                        }
+                        if (slot == 0) {
+                            quads.setArg1(q, operand);
+                        } else {
+                            quads.setArg2(q, operand);
+                        }
+                        changed = true;
+                    }
+                }
+                if (operand.kind == OperandKind::Symbol) {
+                    lastAccess[operand.index] = q;
+                }
+            }
+            if (op > OpCode::Not && op != OpCode::Read) {
+                continue;
+            }
+
+            // (op, a, b, Tn) (=, Tn, -, TBk) becomes (op, a, b, TBk) when
+            // Tn is read nowhere else and TBk is not used in between
+            const auto& source = quads.arg1(q);
+            if (op == OpCode::Assign && result.kind == OperandKind::Symbol &&
+                source.kind == OperandKind::Temp) {
+                const int temp = source.index;
+                const int definition = definitions[temp];
+                if (reads[temp] == 1 && definition >= first &&
+                    lastAccess[result.index] <= definition &&
+                    typeOf(module, source) == typeOf(module, result)) {
+                    quads.setResult(definition, result);
+                    keep[q] = false;
+                    reads[temp] = 0;
+                    copies[temp].block = -1;
+                    versions[variable(result)]++;
+                    lastAccess[result.index] = q;
+                    changed = true;
+                    continue;
+                }
+            }
+
+            versions[variable(result)]++;
+            if (result.kind == OperandKind::Symbol) {
+                lastAccess[result.index] = q;
+            } else if (result.kind == OperandKind::Temp) {
+                const int temp = result.index;
+                definitions[temp] = op == OpCode::Read ? -1 : q;
+                copies[temp] = Copy();
+                if (op == OpCode::Assign &&
+                    (source.isVariable() || source.isImmediate()) &&
+                    typeOf(module, source) == result.type) {
+                    copies[temp].source = source;
+                    copies[temp].version =
+                        source.isVariable() ? versions[variable(source)] : 0;
+                    copies[temp].block = b;
+                }
+            }
+        }
+    }
+
+    if (std::find(keep.begin(), keep.end(), false) != keep.end()) {
+        removeQuads(quads, std::move(keep));
+    }
+    return changed;
+}
+
+bool removeDeadTemporaries(irStruct::Module& module) {
+    auto& quads = module.quads;
+    const int count = static_cast<int>(quads.size());
+    const int tempCount = static_cast<int>(module.temps.size());
+    std::vector<int> reads = countTempReads(quads, tempCount);
+
+    // The quadruples computing each temporary
+    std::vector<int> definitionStart(tempCount + 1, 0);
+    auto isDefinition = [&quads](int q) {
+        return quads.result(q).kind == OperandKind::Temp &&
+               (quads.op(q) < OpCode::Jump || quads.op(q) == OpCode::Read);
+    };
+    for (int q = 0; q < count; q++) {
+        if (isDefinition(q)) {
+            definitionStart[quads.result(q).index + 1]++;
+        }
+    }
+    for (int t = 0; t < tempCount; t++) {
+        definitionStart[t + 1] += definitionStart[t];
+    }
+    std::vector<int> definitionList(definitionStart.back());
+    std::vector<int> fill(definitionStart.begin(), definitionStart.end() - 1);
+    for (int q = 0; q < count; q++) {
+        if (isDefinition(q)) {
+            definitionList[fill[quads.result(q).index]++] = q;
+        }
+    }
+
+    // Dropping a computation may leave the temporaries it reads unread
+    std::vector<int> worklist;
+    for (int t = 0; t < tempCount; t++) {
+        if (reads[t] == 0) {
+            worklist.push_back(t);
+        }
+    }
+    std::vector<bool> keep(count, true);
+    bool removed = false;
+    while (!worklist.empty()) {
+        const int temp = worklist.back();
+        worklist.pop_back();
+        for (int i = definitionStart[temp]; i < definitionStart[temp + 1];
+             i++) {
+            const int q = definitionList[i];
+            if (!keep[q] || !isPure(quads, q)) {
+                continue;
+            }
+            keep[q] = false;
+            removed = true;
+            forEachRead(quads, q, [&](const Operand& operand) {
+                if (operand.kind == OperandKind::Temp &&
+                    --reads[operand.index] == 0) {
+                    worklist.push_back(operand.index);
+                }
+            });
+        }
+    }
+
+    if (removed) {
+        removeQuads(quads, std::move(keep));
+    }
+    return removed;
+}
+
+bool numberValues(irStruct::Module& module) {
+    auto& quads = module.quads;
+    const int symbolCount = static_cast<int>(module.symbols.size());
+    const int variableCount =
+        symbolCount + static_cast<int>(module.temps.size());
+    auto variable = [symbolCount](const Operand& operand) {
+        return operand.kind == OperandKind::Symbol
+                   ? operand.index
+                   : symbolCount + operand.index;
+    };
+
+    // Variables get a new number when first read in a block and whenever
+    // they are written; literals are numbered -1 - their index in the pool
+    ConstantPool pool;
+    std::vector<int> numbers(variableCount, 0);
+    std::vector<int> numberBlocks(variableCount, -1);
+    int next = 0;
+    int block = 0;
+    auto numberOf = [&](const Operand& operand) {
+        if (operand.isImmediate()) {
+            return -1 - pool.intern(operand);
+        }
+        const int v = variable(operand);
+        if (numberBlocks[v] != block) {
+            numberBlocks[v] = block;
+            numbers[v] = next++;
+        }
+        return numbers[v];
+    };
+    auto define = [&](const Operand& destination, int number) {
+        const int v = variable(destination);
+        numberBlocks[v] = block;
+        numbers[v] = number;
+    };
+
+    // The number of each expression computed in the block and a variable
+    // that held it when it was computed
+    struct Available {
+        int number;
+        Operand holder;
+    };
+    std::unordered_map<Expression, Available, ExpressionHash> available;
+    bool changed = false;
+
+    const auto blocks = irCfg::findBlocks(quads);
+    for (block = 0; block < static_cast<int>(blocks.size()); block++) {
+        available.clear();
+        for (int q = blocks[block].first; q <= blocks[block].second; q++) {
+            const auto op = quads.op(q);
+            const auto& result = quads.result(q);
+            if (op == OpCode::Read) {
+                define(result, next++);
+            }
+            if (op >= OpCode::Jump) {
+                continue;
+            }
+
+            // A copy keeps the number unless the store converts the value
+            const auto& arg1 = quads.arg1(q);
+            if (op == OpCode::Assign) {
+                const int number = numberOf(arg1);
+                define(result, typeOf(module, arg1) == typeOf(module, result)
+                                   ? number
+                                   : next++);
+                continue;
+            }
+
+            Expression key{op, numberOf(arg1),
+                           op == OpCode::Not ? 0 : numberOf(quads.arg2(q))};
+            if (isCommutative(op) && key.a > key.b) {
+                std::swap(key.a, key.b);
+            }
+            const auto it = available.find(key);
+            if (it != available.end() &&
+                numberOf(it->second.holder) == it->second.number &&
+                typeOf(module, it->second.holder) == typeOf(module, result)) {
+                quads.setOp(q, OpCode::Assign);
+                quads.setArg1(q, it->second.holder);
+                quads.setArg2(q, Operand());
+                define(result, it->second.number);
+                changed = true;
+                continue;
+            }
+            const int number = next++;
+            define(result, number);
+            available.insert_or_assign(key, Available{number, result});
+        }
+    }
+    return changed;
+}
+
+bool threadJumps(irStruct::Module& module) {
+    auto& quads = module.quads;
+    const int count = static_cast<int>(quads.size());
+    if (count == 0) {
+        return false;
+    }
+    auto inRange = [count](int target) {
+        return target >= 0 && target < count;
+    };
+    auto targetOf = [&quads](int q) { return quads.result(q).index; };
+
+    // Where control goes on when it reaches each quadruple: past a chain of
+    // j, or to a j of a cycle. Chains are followed once, marking the
+    // quadruples on the current one with count
+    std::vector<int> destination(count, -1);
+    std::vector<int> chain;
+    for (int q = 0; q < count; q++) {
+        int t = q;
+        while (destination[t] == -1 && quads.op(t) == OpCode::Jump &&
+               inRange(targetOf(t))) {
+            destination[t] = count;
+            chain.push_back(t);
+            t = targetOf(t);
+        }
+        const bool open = destination[t] == -1 || destination[t] == count;
+        const int end = open ? t : destination[t];
+        destination[t] = end;
+        for (const int link : chain) {
+            destination[link] = end;
+        }
+        chain.clear();
+    }
+
+    // Retarget every jump. A j<rel> on integers over a j, (j<rel>, a, b, L1)
+    // (j, -, -, L2) where L1 is reached after the j, jumps to L2 on the
+    // opposite relation instead; the j then only falls through, unless it
+    // is where other jumps end up in a cycle
+    bool changed = false;
+    for (int q = 0; q < count; q++) {
+        const auto op = quads.op(q);
+        if (!irUtil::isJump(op) || !inRange(targetOf(q))) {
+            continue;
+        }
+        int target = destination[targetOf(q)];
+        if (irUtil::isConditionalJump(op) && op != OpCode::JumpNz &&
+            q + 2 < count && quads.op(q + 1) == OpCode::Jump &&
+            inRange(targetOf(q + 1)) && destination[q + 1] != q + 1 &&
+            target == destination[q + 2] &&
+            destination[targetOf(q + 1)] != target &&
+            typeOf(module, quads.arg1(q)) == ValueType::Int &&
+            typeOf(module, quads.arg2(q)) == ValueType::Int) {
+            quads.setOp(q, invertJump(op));
+            quads.setResult(q, Operand::target(destination[targetOf(q + 1)]));
+            quads.setResult(q + 1, Operand::target(q + 2));
+            changed = true;
+            q++;
+            continue;
+        }
+        if (target != targetOf(q)) {
+            quads.setResult(q, Operand::target(target));
+            changed = true;
+        }
+    }
+
+    // Keep the blocks that can be reached from the entry
+    const irCfg::Cfg cfg(quads);
+    const auto& blocks = cfg.blocks();
+    std::vector<bool> reached(blocks.size(), false);
+    std::vector<int> pending{0};
+    reached[0] = true;
+    while (!pending.empty()) {
+        const auto& block = blocks[pending.back()];
+        pending.pop_back();
+        for (const int succ : {block.taken, block.fallThrough}) {
+            if (succ >= 0 && !reached[succ]) {
+                reached[succ] = true;
+                pending.push_back(succ);
+            }
+        }
+    }
+    std::vector<bool> keep(count, false);
+    for (size_t b = 0; b < blocks.size(); b++) {
+        if (reached[b]) {
+            std::fill(keep.begin() + blocks[b].first,
+                      keep.begin() + blocks[b].last + 1, true);
+        }
+    }
+
+    // Drop the jumps to the next quadruple kept, from the last one back, so
+    // that a jump over jumps dropped after it is dropped as well
+    int next = count;
+    for (int q = count - 1; q >= 0; q--) {
+        if (!keep[q]) {
+            continue;
+        }
+        const int target = targetOf(q);
+        if (irUtil::isJump(quads.op(q)) && inRange(target) && target > q &&
+            target <= next) {
+            keep[q] = false;
+        } else {
+            next = q;
+        }
+    }
+
+    if (std::find(keep.begin(), keep.end() - 1, false) != keep.end() - 1) {
+        removeQuads(quads, std::move(keep));
+        return true;
+    }
+    return changed;
+}
+
+bool hoistInvariants(irStruct::Module& module, irCfg::Analysis& analysis) {
+    auto& quads = module.quads;
+    const auto& cfg = analysis.cfg();
+    const auto& nest = analysis.loops();
+    const auto& blocks = cfg.blocks();
+    const auto& loops = nest.loops();
+    const int count = static_cast<int>(quads.size());
+    const int loopCount = static_cast<int>(loops.size());
+
+    // Only a temporary written once can be followed from its definition
+    std::vector<int> writes(module.temps.size(), 0);
+    for (int q = 0; q < count; q++) {
+        const auto op = quads.op(q);
+        if ((op < OpCode::Jump || op == OpCode::Read) &&
+            quads.result(q).kind == OperandKind::Temp) {
+            writes[quads.result(q).index]++;
+        }
+    }
+
+    // Per loop, the declared variables it writes and the invariant value of
+    // its temporaries: a literal, a variable it does not write, or the
+    // variable holding a hoisted result. Both are marked with the loop
+    std::vector<int> writtenIn(module.symbols.size(), -1);
+    std::vector<int> valueIn(module.temps.size(), -1);
+    std::vector<Operand> values(module.temps.size());
+    auto invariant = [&](Operand& operand, int loop) {
+        switch (operand.kind) {
+            case OperandKind::Symbol:
+                return static_cast<size_t>(operand.index) >=
+                           writtenIn.size() ||
+                       writtenIn[operand.index] != loop;
+            case OperandKind::Temp:
+                if (valueIn[operand.index] != loop) {
+                    return false;
+                }
+                operand = values[operand.index];
+                return true;
+            default:
+                return true;
+        }
+    };
+
+    // Outer loops come first, so a result is hoisted as far as it can go
+    std::vector<std::vector<irStruct::Quad>> hoisted(loopCount);
+    std::vector<int> preheaderLoop(count, -1);
+    for (int l = loopCount - 1; l >= 0; l--) {
+        // The preheader goes right before the header, so no block of the
+        // loop may fall through into it
+        const int header = loops[l].header;
+        bool enclosed = true;
+        const auto [fromPred, toPred] = cfg.predecessors(header);
+        for (auto pred = fromPred; pred != toPred; ++pred) {
+            if (blocks[*pred].fallThrough == header &&
+                nest.contains(l, *pred)) {
+                enclosed = false;
+            }
+        }
+        if (!enclosed) {
+            continue;
+        }
+
+        const auto [first, last] = nest.blocks(l);
+        for (auto b = first; b != last; ++b) {
+            for (int q = blocks[*b].first; q <= blocks[*b].last; q++) {
+                const auto op = quads.op(q);
+                const auto& result = quads.result(q);
+                if ((op < OpCode::Jump || op == OpCode::Read) &&
+                    result.kind == OperandKind::Symbol) {
+                    writtenIn[result.index] = l;
+                }
+            }
+        }
+
+        for (auto b = first; b != last; ++b) {
+            for (int q = blocks[*b].first; q <= blocks[*b].last; q++) {
+                const auto op = quads.op(q);
+                const auto result = quads.result(q);
+                if (op >= OpCode::Jump || result.kind != OperandKind::Temp ||
+                    writes[result.index] != 1) {
+                    continue;
+                }
+                Operand arg1 = quads.arg1(q);
+                Operand arg2 = quads.arg2(q);
+                if (!invariant(arg1, l) || !invariant(arg2, l)) {
+                    continue;
+                }
+
+                // Copies are not worth a variable of their own; what they
+                // copy stands in for the temporary
+                if (op == OpCode::Assign) {
+                    if (typeOf(module, arg1) == result.type) {
+                        valueIn[result.index] = l;
+                        values[result.index] = arg1;
+                    }
+                    continue;
+                }
+                if (!isPure(op, arg2)) {
+                    continue;
+                }
+
+                // Compute the result into a new variable in the preheader,
+                // and copy it into the temporary where it was computed
+                int offset = 0;
+                if (!module.symbols.empty()) {
+                    const auto& previous = module.symbols.back();
+                    offset = previous.offset +
+                             (previous.type == ValueType::Int ? 4 : 8);
+                }
+                const auto holder = Operand::symbol(
+                    static_cast<int>(module.symbols.size()));
+                module.symbols.emplace_back(
+                    "inv" + std::to_string(holder.index), result.type,
+                    offset);
+                hoisted[l].emplace_back(op, arg1, arg2, holder);
+                quads.setOp(q, OpCode::Assign);
+                quads.setArg1(q, holder);
+                quads.setArg2(q, Operand());
+                valueIn[result.index] = l;
+                values[result.index] = holder;
+            }
+        }
+        if (!hoisted[l].empty()) {
+            preheaderLoop[blocks[header].first] = l;
+        }
+    }
+    if (std::all_of(hoisted.begin(), hoisted.end(),
+                    [](const auto& list) { return list.empty(); })) {
+        return false;
+    }
+
+    // Insert the preheaders. Jumps to a header from outside its loop enter
+    // the preheader, and those from inside go past it
+    std::vector<int> newIndex(count);
+    std::vector<int> preheaderIndex(count);
+    int shift = 0;
+    for (int q = 0; q < count; q++) {
+        preheaderIndex[q] = q + shift;
+        if (preheaderLoop[q] >= 0) {
+            shift += static_cast<int>(hoisted[preheaderLoop[q]].size());
+        }
+        newIndex[q] = q + shift;
+    }
+    irStruct::QuadList result;
+    result.reserve(count + shift);
+    for (int q = 0; q < count; q++) {
+        if (preheaderLoop[q] >= 0) {
+            for (const auto& quad : hoisted[preheaderLoop[q]]) {
+                result.push(quad);
+            }
+        }
+        auto quad = quads.at(q);
+        const int target = quad.result.index;
+        if (irUtil::isJump(quad.op) && target >= 0 && target < count) {
+            const int loop = preheaderLoop[target];
+            const int block = cfg.blockOf(q);
+            const bool inside =
+                loop >= 0 && block >= 0 && nest.contains(loop, block);
+            quad.result.index =
+                loop >= 0 && !inside ? preheaderIndex[target]
+                                     : newIndex[target];
+        }
+        result.push(quad);
+    }
+    quads = std::move(result);
+    return true;
+}
+
+}  // namespace irOpt
@@ -0,0 +1,136 @@
+#ifndef IROPT_H
+#define IROPT_H
+
+#include "irCfg.h"
+#include "irStruct.h"
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace irOpt {
+
+/**
+ * @enum Pass
+ * @brief An optimization pass over the quadruples of a module.
+ */
+enum class Pass {
+    ConstantPropagation,     ///< "sccp": propagateConstants().
+    CopyPropagation,         ///< "copy": propagateCopies().
+    DeadCodeElimination,     ///< "dce": removeDeadTemporaries().
+    ValueNumbering,          ///< "lvn": numberValues().
+    JumpThreading,           ///< "jumps": threadJumps().
+    LoopInvariantCodeMotion  ///< "licm": hoistInvariants().
+};
+
+/**
+ * @brief Parses the name of a pass as given to --opt.
+ *
+ * @param name The name, e.g. "sccp".
+ * @return std::optional<Pass> The pass, or std::nullopt if the name is
+ * unknown.
+ */
+std::optional<Pass> parsePass(std::string_view name);
+
+/**
+ * @brief Runs passes over a module, in order. The module must have resolved
+ * jump targets, as Parser::parse() and the listing readers produce.
+ *
+ * @param module The module to optimize.
+ * @param passes The passes to run; a pass may appear more than once.
+ */
+void optimize(irStruct::Module& module, const std::vector<Pass>& passes);
+
+/**
+ * @brief Sparse conditional constant propagation over the basic blocks of
+ * irCfg::Cfg. Starting from the entry, only blocks reached along edges that
+ * can be taken are evaluated, so a branch on a known value keeps the code on
+ * the other side from lowering what is known. Declared variables are tracked
+ * per block, since the quadruples are not in SSA form; a temporary written by
+ * exactly one quadruple is tracked across the whole program.
+ *
+ * Afterwards, operands known to be constant become literals (except those of
+ * R and W), operations on them become assignments of the result, branches
+ * with a known outcome become j or are removed, and blocks that cannot run
+ * are deleted.
+ *
+ * @param module The module to optimize.
+ * @return bool True if the quadruples changed.
+ */
+bool propagateConstants(irStruct::Module& module);
+
+/**
+ * @brief Copy propagation within basic blocks. After a copy (=, x, -, Tn) of
+ * a variable or literal x of the same type, the reads of Tn in the same block
+ * read x instead, for as long as x is not written again. A result computed
+ * into a temporary that only the assignment (=, Tn, -, TBk) reads is computed
+ * into TBk directly if TBk is not used in between, and the assignment is
+ * removed.
+ *
+ * Temporaries are only replaced within their block, where the code
+ * generator's next-use information follows them; removeDeadTemporaries()
+ * then drops the copies nothing reads any more.
+ *
+ * @param module The module to optimize.
+ * @return bool True if the quadruples changed.
+ */
+bool propagateCopies(irStruct::Module& module);
+
+/**
+ * @brief Removes the quadruples computing temporaries that are never read,
+ * and then those computing temporaries only they read. R is kept, and so is
+ * a division whose divisor may be 0 or -1, since it may trap.
+ *
+ * @param module The module to optimize.
+ * @return bool True if any quadruple was removed.
+ */
+bool removeDeadTemporaries(irStruct::Module& module);
+
+/**
+ * @brief Local value numbering. Within each basic block, every value gets a
+ * number and every operation is keyed by its operation and the numbers of
+ * its operands, in a fixed order for +, *, ==, !=, && and ||. An operation
+ * whose key was computed before, into a variable of the same type that
+ * still holds it, becomes a copy of that variable; propagateCopies() and
+ * removeDeadTemporaries() then clean up after it.
+ *
+ * @param module The module to optimize.
+ * @return bool True if the quadruples changed.
+ */
+bool numberValues(irStruct::Module& module);
+
+/**
+ * @brief Jump threading. Every jump goes straight to where a chain of j
+ * starting at its target leads, and a j<rel> on integers whose target
+ * follows a j, as in (j<, a, b, q + 2) (j, -, -, L), becomes (j>=, a, b, L).
+ * Blocks that can no longer be reached, and jumps to the quadruple after
+ * them, are then removed, which merges the blocks on either side.
+ *
+ * @param module The module to optimize.
+ * @return bool True if the quadruples changed.
+ */
+bool threadJumps(irStruct::Module& module);
+
+/**
+ * @brief Loop-invariant code motion. An arithmetic, relational or logical
+ * operation in a loop of irCfg::LoopNest whose operands are literals,
+ * declared variables the loop does not write, or temporaries computed that
+ * way, is computed once into a new declared variable "invN" in a preheader
+ * inserted before the loop header; the operation in the loop becomes a copy
+ * of that variable. Loops are visited from the outermost, so a result leaves
+ * every loop it is invariant in. R and W never move, nor do divisions that
+ * may trap, since the loop body may not run at all.
+ *
+ * The new variables outlive the preheader, where a temporary would not: the
+ * code generator keeps temporaries in registers only within a block. Run
+ * copy,dce afterwards to drop the copies.
+ *
+ * @param module The module to optimize.
+ * @param analysis The loops of module.quads, computed again if the
+ * quadruples changed since.
+ * @return bool True if anything was hoisted.
+ */
+bool hoistInvariants(irStruct::Module& module, irCfg::Analysis& analysis);
+
+}  // namespace irOpt
+
+#endif  // IROPT_H
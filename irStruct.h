@@ -0,0 +1,336 @@
+#ifndef IRSTRUCT_H
+#define IRSTRUCT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace irStruct {
+
+/**
+ * @enum OpCode
+ * @brief Operation of a quadruple. The relational operators and the
+ * conditional jumps are laid out in the same order so that one can be mapped
+ * onto the other by offset.
+ */
+enum class OpCode : std::uint8_t {
+    Assign,  ///< =
+    Add,     ///< +
+    Sub,     ///< -
+    Mul,     ///< *
+    Div,     ///< /
+    Eq,      ///< ==
+    Ne,      ///< !=
+    Lt,      ///< <
+    Le,      ///< <=
+    Gt,      ///< >
+    Ge,      ///< >=
+    And,     ///< &&
+    Or,      ///< ||
+    Not,     ///< !
+    Jump,    ///< j
+    JumpEq,  ///< j==
+    JumpNe,  ///< j!=
+    JumpLt,  ///< j<
+    JumpLe,  ///< j<=
+    JumpGt,  ///< j>
+    JumpGe,  ///< j>=
+    JumpNz,  ///< jnz
+    Read,    ///< R
+    Write,   ///< W
+    End      ///< End
+};
+
+/**
+ * @enum OperandKind
+ * @brief Kind of value stored in an Operand.
+ */
+enum class OperandKind : std::uint8_t {
+    None,       ///< Unused operand slot, printed as "-".
+    Symbol,     ///< Declared variable, printed as "TB<index>".
+    Temp,       ///< Temporary variable, printed as "T<index>_i" / "T<index>_d".
+    ImmInt,     ///< Integer literal.
+    ImmDouble,  ///< Floating point literal.
+    Target,     ///< Jump target (quadruple index or backpatch link).
+    ImmText     ///< Integer literal outside the int64_t range, kept as text.
+};
+
+/**
+ * @enum ValueType
+ * @brief Data type of a variable, temporary or literal. The numeric values
+ * match OpKeyMap::typr_to_int.
+ */
+enum class ValueType : std::uint8_t { Int = 0, Double = 1 };
+
+/**
+ * @struct Operand
+ * @brief A typed quadruple operand.
+ */
+struct Operand {
+    OperandKind kind;  ///< What the operand refers to.
+    ValueType type;    ///< Type of the value (temporaries and literals).
+    union {
+        std::int32_t index;   ///< Symbol, temporary, target or text index.
+        std::int64_t intValue;  ///< Value of an ImmInt operand.
+        double doubleValue;     ///< Value of an ImmDouble operand.
+    };
+
+    /**
+     * @brief Constructs an empty ("-") operand.
+     */
+    Operand() : kind(OperandKind::None), type(ValueType::Int), intValue(0) {}
+
+    static Operand symbol(int idx) {
+        Operand op;
+        op.kind = OperandKind::Symbol;
+        op.index = idx;
+        return op;
+    }
+
+    static Operand temp(int idx, ValueType t) {
+        Operand op;
+        op.kind = OperandKind::Temp;
+        op.type = t;
+        op.index = idx;
+        return op;
+    }
+
+    static Operand immInt(std::int64_t v) {
+        Operand op;
+        op.kind = OperandKind::ImmInt;
+        op.intValue = v;
+        return op;
+    }
+
+    static Operand immDouble(double v) {
+        Operand op;
+        op.kind = OperandKind::ImmDouble;
+        op.type = ValueType::Double;
+        op.doubleValue = v;
+        return op;
+    }
+
+    static Operand target(int idx) {
+        Operand op;
+        op.kind = OperandKind::Target;
+        op.index = idx;
+        return op;
+    }
+
+    /**
+     * @brief Constructs an integer literal kept as text.
+     *
+     * @param idx Index of the text in the literal pool (irUtil::textLiteral).
+     */
+    static Operand immText(int idx) {
+        Operand op;
+        op.kind = OperandKind::ImmText;
+        op.index = idx;
+        return op;
+    }
+
+    bool isNone() const { return kind == OperandKind::None; }
+    bool isVariable() const {
+        return kind == OperandKind::Symbol || kind == OperandKind::Temp;
+    }
+    bool isImmediate() const {
+        return kind == OperandKind::ImmInt ||
+               kind == OperandKind::ImmDouble || kind == OperandKind::ImmText;
+    }
+};
+
+inline bool operator==(const Operand& lhs, const Operand& rhs) {
+    if (lhs.kind != rhs.kind)
+        return false;
+    switch (lhs.kind) {
+        case OperandKind::None:
+            return true;
+        case OperandKind::ImmInt:
+            return lhs.intValue == rhs.intValue;
+        case OperandKind::ImmDouble:
+            return lhs.doubleValue == rhs.doubleValue;
+        case OperandKind::Temp:
+            return lhs.index == rhs.index && lhs.type == rhs.type;
+        default:
+            return lhs.index == rhs.index;
+    }
+}
+
+inline bool operator!=(const Operand& lhs, const Operand& rhs) {
+    return !(lhs == rhs);
+}
+
+/**
+ * @struct Quad
+ * @brief A single quadruple, used to build or copy one entry of a QuadList.
+ */
+struct Quad {
+    OpCode op;       ///< The operation.
+    Operand arg1;    ///< The first operand.
+    Operand arg2;    ///< The second operand.
+    Operand result;  ///< The destination, or the target of a jump.
+
+    Quad(OpCode o, const Operand& a1, const Operand& a2, const Operand& r)
+        : op(o), arg1(a1), arg2(a2), result(r) {}
+
+    Quad() : op(OpCode::End) {}
+};
+
+/**
+ * @class QuadList
+ * @brief Quadruples stored as a structure of arrays: one array per field.
+ *
+ * For jump quadruples the result slot holds a Target operand. While parsing
+ * it doubles as the backpatch link (the former QuadTuple::Xfour).
+ */
+class QuadList {
+public:
+    QuadList() = default;
+
+    /**
+     * @brief Constructs an empty list.
+     *
+     * @param resource Allocates the arrays.
+     */
+    explicit QuadList(std::pmr::memory_resource* resource)
+        : opcodes(resource),
+          arg1s(resource),
+          arg2s(resource),
+          results(resource) {}
+
+    QuadList(const QuadList&) = default;
+    QuadList(QuadList&&) = default;
+
+    // Replacing the quadruples is a change too, so the version moves past
+    // both lists' versions
+    QuadList& operator=(const QuadList& other) {
+        opcodes = other.opcodes;
+        arg1s = other.arg1s;
+        arg2s = other.arg2s;
+        results = other.results;
+        mutations = std::max(mutations, other.mutations) + 1;
+        return *this;
+    }
+
+    QuadList& operator=(QuadList&& other) {
+        opcodes = std::move(other.opcodes);
+        arg1s = std::move(other.arg1s);
+        arg2s = std::move(other.arg2s);
+        results = std::move(other.results);
+        mutations = std::max(mutations, other.mutations) + 1;
+        return *this;
+    }
+
+    /**
+     * @brief Counts the changes made to the list: every call of a mutator
+     * (push, clear, the setters and assignment) moves it on. Analyses of the list
+     * compare it to tell whether their results are still valid.
+     */
+    std::uint64_t version() const { return mutations; }
+
+    std::size_t size() const { return opcodes.size(); }
+    bool empty() const { return opcodes.empty(); }
+
+    void reserve(std::size_t n) {
+        opcodes.reserve(n);
+        arg1s.reserve(n);
+        arg2s.reserve(n);
+        results.reserve(n);
+    }
+
+    void clear() {
+        mutations++;
+        opcodes.clear();
+        arg1s.clear();
+        arg2s.clear();
+        results.clear();
+    }
+
+    /**
+     * @brief Appends a quadruple.
+     *
+     * @return The index of the new quadruple.
+     */
+    int push(OpCode op,
+             const Operand& arg1,
+             const Operand& arg2,
+             const Operand& result) {
+        mutations++;
+        opcodes.push_back(op);
+        arg1s.push_back(arg1);
+        arg2s.push_back(arg2);
+        results.push_back(result);
+        return static_cast<int>(opcodes.size()) - 1;
+    }
+
+    int push(const Quad& q) { return push(q.op, q.arg1, q.arg2, q.result); }
+
+    /**
+     * @brief Gathers the fields of quadruple i into a Quad.
+     */
+    Quad at(std::size_t i) const {
+        return Quad(opcodes[i], arg1s[i], arg2s[i], results[i]);
+    }
+
+    OpCode op(std::size_t i) const { return opcodes[i]; }
+    const Operand& arg1(std::size_t i) const { return arg1s[i]; }
+    const Operand& arg2(std::size_t i) const { return arg2s[i]; }
+    const Operand& result(std::size_t i) const { return results[i]; }
+
+    void setOp(std::size_t i, OpCode op) {
+        mutations++;
+        opcodes[i] = op;
+    }
+    void setArg1(std::size_t i, const Operand& x) {
+        mutations++;
+        arg1s[i] = x;
+    }
+    void setArg2(std::size_t i, const Operand& x) {
+        mutations++;
+        arg2s[i] = x;
+    }
+    void setResult(std::size_t i, const Operand& x) {
+        mutations++;
+        results[i] = x;
+    }
+
+private:
+    std::pmr::vector<OpCode> opcodes;   ///< Operation of every quadruple.
+    std::pmr::vector<Operand> arg1s;    ///< First operands.
+    std::pmr::vector<Operand> arg2s;    ///< Second operands.
+    std::pmr::vector<Operand> results;  ///< Destinations or jump targets.
+    std::uint64_t mutations = 0;        ///< See version().
+};
+
+/**
+ * @struct SymbolEntry
+ * @brief A declared variable of the compiled program.
+ */
+struct SymbolEntry {
+    std::string name;  ///< Source name of the variable.
+    ValueType type;    ///< Declared type.
+    int offset;        ///< Frame offset assigned at declaration.
+
+    SymbolEntry(std::string n, ValueType t, int off)
+        : name(std::move(n)), type(t), offset(off) {}
+
+    SymbolEntry() : type(ValueType::Int), offset(0) {}
+};
+
+/**
+ * @struct Module
+ * @brief The intermediate representation handed from the parser to the object
+ * code generator: symbol table, temporary table and quadruples.
+ */
+struct Module {
+    std::vector<SymbolEntry> symbols;  ///< Declared variables, indexed by TB.
+    std::vector<ValueType> temps;      ///< Temporary types, indexed by T.
+    QuadList quads;                    ///< The quadruples.
+};
+
+}  // namespace irStruct
+
+#endif  // IRSTRUCT_H
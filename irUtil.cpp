@@ -0,0 +1,491 @@
+#include "irUtil.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace irUtil {
+
+namespace {
+
+// Textual names indexed by OpCode
+constexpr std::array<std::string_view, 25> OPCODE_NAMES{
+    "=",  "+",   "-",   "*",  "/",   "==", "!=",  "<",   "<=",
+    ">",  ">=",  "&&",  "||", "!",   "j",  "j==", "j!=", "j<",
+    "j<=", "j>", "j>=", "jnz", "R",  "W",  "End"};
+
+// Parses the whole text as a number
+template <typename T>
+bool parseNumber(std::string_view text, T& value) {
+    const char* last = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), last, value);
+    return ec == std::errc() && ptr == last;
+}
+
+// Texts of the literals kept as ImmText operands. Parsers run on several
+// threads, so the pool is locked; such literals are rare
+struct LiteralPool {
+    std::mutex lock;
+    std::vector<std::string> texts;
+    std::unordered_map<std::string, int> indices;
+};
+
+LiteralPool& literalPool() {
+    static LiteralPool pool;
+    return pool;
+}
+
+// Reads the textual quadruple format in place; slices point into the text
+class TextReader {
+public:
+    explicit TextReader(std::string_view text, std::size_t pos = 0)
+        : text(text), pos(pos) {}
+
+    // Offset of the next character to read
+    std::size_t position() const { return pos; }
+
+    // Returns the next whitespace-separated word
+    std::string_view word() {
+        while (pos < text.size() && isSpace(text[pos])) {
+            pos++;
+        }
+        const std::size_t start = pos;
+        while (pos < text.size() && !isSpace(text[pos])) {
+            pos++;
+        }
+        return text.substr(start, pos - start);
+    }
+
+    // Returns the next word as a number
+    template <typename T>
+    T number(const char* what) {
+        auto slice = word();
+        T value{};
+        if (!parseNumber(slice, value)) {
+            fail(slice, std::string("expected ") + what);
+        }
+        return value;
+    }
+
+    // Returns the rest of the current line and moves to the next one
+    std::string_view line() {
+        const std::size_t start = pos;
+        const std::size_t end = std::min(text.find('\n', pos), text.size());
+        pos = end < text.size() ? end + 1 : end;
+        auto slice = text.substr(start, end - start);
+        if (!slice.empty() && slice.back() == '\r') {
+            slice.remove_suffix(1);
+        }
+        return slice;
+    }
+
+    // Reports an error at the start of a slice of the text
+    [[noreturn]] void fail(std::string_view at, const std::string& message) const {
+        const std::size_t offset = at.data() - text.data();
+        const std::size_t lineStart =
+            offset == 0 ? std::string_view::npos : text.rfind('\n', offset - 1);
+        const std::size_t column =
+            lineStart == std::string_view::npos ? offset + 1
+                                                : offset - lineStart;
+        const auto lineNumber =
+            std::count(text.begin(), text.begin() + offset, '\n') + 1;
+        throw std::invalid_argument(
+            "Quadruple listing, line " + std::to_string(lineNumber) +
+            ", column " + std::to_string(column) + ": " + message);
+    }
+
+private:
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    }
+
+    std::string_view text;
+    std::size_t pos = 0;
+};
+
+}  // namespace
+
+bool isJump(irStruct::OpCode op) {
+    return op >= irStruct::OpCode::Jump && op <= irStruct::OpCode::JumpNz;
+}
+
+bool isConditionalJump(irStruct::OpCode op) {
+    return op > irStruct::OpCode::Jump && op <= irStruct::OpCode::JumpNz;
+}
+
+bool isRelational(irStruct::OpCode op) {
+    return op >= irStruct::OpCode::Eq && op <= irStruct::OpCode::Ge;
+}
+
+irStruct::OpCode toJump(irStruct::OpCode op) {
+    return static_cast<irStruct::OpCode>(
+        static_cast<int>(op) - static_cast<int>(irStruct::OpCode::Eq) +
+        static_cast<int>(irStruct::OpCode::JumpEq));
+}
+
+irStruct::OpCode fromJump(irStruct::OpCode op) {
+    return static_cast<irStruct::OpCode>(
+        static_cast<int>(op) - static_cast<int>(irStruct::OpCode::JumpEq) +
+        static_cast<int>(irStruct::OpCode::Eq));
+}
+
+std::string_view opcodeName(irStruct::OpCode op) {
+    return OPCODE_NAMES[static_cast<std::size_t>(op)];
+}
+
+irStruct::OpCode parseOpcode(std::string_view name) {
+    for (std::size_t i = 0; i < OPCODE_NAMES.size(); i++) {
+        if (OPCODE_NAMES[i] == name) {
+            return static_cast<irStruct::OpCode>(i);
+        }
+    }
+    throw std::invalid_argument("Unknown quadruple operation: " +
+                                std::string(name));
+}
+
+std::string operandName(const irStruct::Operand& op) {
+    switch (op.kind) {
+        case irStruct::OperandKind::Symbol:
+            return "TB" + std::to_string(op.index);
+        case irStruct::OperandKind::Temp:
+            return "T" + std::to_string(op.index) +
+                   (op.type == irStruct::ValueType::Int ? "_i" : "_d");
+        case irStruct::OperandKind::ImmInt:
+            return std::to_string(op.intValue);
+        case irStruct::OperandKind::ImmDouble:
+            return std::to_string(op.doubleValue);
+        case irStruct::OperandKind::Target:
+            return std::to_string(op.index);
+        case irStruct::OperandKind::ImmText:
+            return literalText(op);
+        default:
+            return "-";
+    }
+}
+
+irStruct::Operand textLiteral(std::string_view text) {
+    auto& pool = literalPool();
+    std::lock_guard<std::mutex> guard(pool.lock);
+    auto [it, inserted] = pool.indices.try_emplace(
+        std::string(text), static_cast<int>(pool.texts.size()));
+    if (inserted) {
+        pool.texts.emplace_back(text);
+    }
+    return irStruct::Operand::immText(it->second);
+}
+
+std::string literalText(const irStruct::Operand& op) {
+    auto& pool = literalPool();
+    std::lock_guard<std::mutex> guard(pool.lock);
+    return pool.texts.at(op.index);
+}
+
+irStruct::Operand parseOperand(std::string_view text, bool isTarget) {
+    int index = 0;
+    if (isTarget) {
+        if (parseNumber(text, index)) {
+            return irStruct::Operand::target(index);
+        }
+    } else if (text.empty() || text == "-") {
+        return irStruct::Operand();
+    } else if (text.size() > 1 && text[0] == 'T' && text[1] == 'B') {
+        if (parseNumber(text.substr(2), index)) {
+            return irStruct::Operand::symbol(index);
+        }
+    } else if (text[0] == 'T') {
+        // The type is the suffix, _i or _d
+        auto underscore = text.find('_');
+        if (underscore != std::string_view::npos &&
+            underscore + 2 == text.size() &&
+            (text.back() == 'i' || text.back() == 'd') &&
+            parseNumber(text.substr(1, underscore - 1), index)) {
+            return irStruct::Operand::temp(
+                index, text.back() == 'i' ? irStruct::ValueType::Int
+                                          : irStruct::ValueType::Double);
+        }
+    } else if (text.find('.') != std::string_view::npos) {
+        double value = 0;
+        if (parseNumber(text, value)) {
+            return irStruct::Operand::immDouble(value);
+        }
+    } else {
+        long long value = 0;
+        if (parseNumber(text, value)) {
+            return irStruct::Operand::immInt(value);
+        }
+        // Digits that do not fit an immediate are kept as written
+        if (std::all_of(text.begin(), text.end(),
+                        [](char c) { return c >= '0' && c <= '9'; })) {
+            return textLiteral(text);
+        }
+    }
+    throw std::invalid_argument("Invalid quadruple operand: " +
+                                std::string(text));
+}
+
+// Folds an operation on two literals of the same type. Integer arithmetic
+// wraps like the 64-bit registers it would run on, and !, && and || are the
+// bitwise not, and and or instructions the code generator emits for them
+std::optional<irStruct::Operand> fold(irStruct::OpCode op,
+                                      const irStruct::Operand& a,
+                                      const irStruct::Operand& b) {
+    using irStruct::OpCode;
+    using irStruct::Operand;
+    using irStruct::OperandKind;
+
+    if (op == OpCode::Not) {
+        if (a.kind != OperandKind::ImmInt) {
+            return std::nullopt;
+        }
+        return Operand::immInt(~a.intValue);
+    }
+    // Nothing is known of the value of a literal kept as text
+    if (!a.isImmediate() || a.kind != b.kind ||
+        a.kind == OperandKind::ImmText) {
+        return std::nullopt;
+    }
+
+    if (a.kind == OperandKind::ImmInt) {
+        const std::int64_t x = a.intValue;
+        const std::int64_t y = b.intValue;
+        const auto ux = static_cast<std::uint64_t>(x);
+        const auto uy = static_cast<std::uint64_t>(y);
+        constexpr auto INT64_LOWEST = std::numeric_limits<std::int64_t>::min();
+        switch (op) {
+            case OpCode::Add:
+                return Operand::immInt(static_cast<std::int64_t>(ux + uy));
+            case OpCode::Sub:
+                return Operand::immInt(static_cast<std::int64_t>(ux - uy));
+            case OpCode::Mul:
+                return Operand::immInt(static_cast<std::int64_t>(ux * uy));
+            case OpCode::Div:
+                if (y == 0 || (y == -1 && x == INT64_LOWEST)) {
+                    return std::nullopt;
+                }
+                return Operand::immInt(x / y);
+            case OpCode::Eq:
+                return Operand::immInt(x == y);
+            case OpCode::Ne:
+                return Operand::immInt(x != y);
+            case OpCode::Lt:
+                return Operand::immInt(x < y);
+            case OpCode::Le:
+                return Operand::immInt(x <= y);
+            case OpCode::Gt:
+                return Operand::immInt(x > y);
+            case OpCode::Ge:
+                return Operand::immInt(x >= y);
+            case OpCode::And:
+                return Operand::immInt(x & y);
+            case OpCode::Or:
+                return Operand::immInt(x | y);
+            default:
+                return std::nullopt;
+        }
+    }
+
+    const double x = a.doubleValue;
+    const double y = b.doubleValue;
+    switch (op) {
+        case OpCode::Add:
+            return Operand::immDouble(x + y);
+        case OpCode::Sub:
+            return Operand::immDouble(x - y);
+        case OpCode::Mul:
+            return Operand::immDouble(x * y);
+        case OpCode::Div:
+            if (y == 0) {
+                return std::nullopt;
+            }
+            return Operand::immDouble(x / y);
+        case OpCode::Eq:
+            return Operand::immInt(x == y);
+        case OpCode::Ne:
+            return Operand::immInt(x != y);
+        case OpCode::Lt:
+            return Operand::immInt(x < y);
+        case OpCode::Le:
+            return Operand::immInt(x <= y);
+        case OpCode::Gt:
+            return Operand::immInt(x > y);
+        case OpCode::Ge:
+            return Operand::immInt(x >= y);
+        default:
+            return std::nullopt;
+    }
+}
+
+irStruct::Operand zeroLike(const irStruct::Operand& x) {
+    return x.kind == irStruct::OperandKind::ImmDouble
+               ? irStruct::Operand::immDouble(0)
+               : irStruct::Operand::immInt(0);
+}
+
+std::vector<std::string> printModule(const irStruct::Module& module) {
+    std::vector<std::string> output;
+    const auto& quads = module.quads;
+
+    // Add the size of the symbol table and its entries
+    output.push_back(std::to_string(module.symbols.size()) + "\n");
+    for (const auto& symbol : module.symbols) {
+        output.push_back(symbol.name + " " +
+                         std::to_string(static_cast<int>(symbol.type)) +
+                         " null " + std::to_string(symbol.offset) + "\n");
+    }
+
+    // Add the number of temporaries and of quadruples
+    output.push_back(std::to_string(module.temps.size()) + "\n");
+    output.push_back(std::to_string(quads.size()) + "\n");
+
+    // Add the quadruples
+    for (std::size_t i = 0; i < quads.size(); i++) {
+        output.push_back(std::to_string(i) + ": (" +
+                         std::string(opcodeName(quads.op(i))) + "," +
+                         operandName(quads.arg1(i)) + "," +
+                         operandName(quads.arg2(i)) + "," +
+                         operandName(quads.result(i)) + ")\n");
+    }
+
+    return output;
+}
+
+ListingReader::ListingReader(std::string_view text) : text(text) {
+    TextReader reader(text);
+    const int n = reader.number<int>("the symbol count");
+
+    for (int i = 0; i < n; i++) {
+        irStruct::SymbolEntry symbol;
+        symbol.name = reader.word();
+        const auto type = reader.word();
+        int value = 0;
+        if (!parseNumber(type, value) || value < 0 || value > 1) {
+            reader.fail(type, "expected a symbol type, 0 (int) or 1 (double)");
+        }
+        symbol.type = static_cast<irStruct::ValueType>(value);
+        reader.word();  // Value, always "null"
+        symbol.offset = reader.number<int>("a symbol offset");
+        symbolTable.push_back(std::move(symbol));
+    }
+
+    temporaries = std::max(reader.number<int>("the temporary count"), 0);
+    quadruples = std::max(reader.number<int>("the quadruple count"), 0);
+
+    reader.line();
+    first = reader.position();
+    rewind();
+}
+
+void ListingReader::rewind() {
+    pos = first;
+    index = 0;
+}
+
+bool ListingReader::next(irStruct::Quad& quad) {
+    if (index == quadruples) {
+        return false;
+    }
+    TextReader reader(text, pos);
+
+    // "<index>: (<op>,<arg1>,<arg2>,<result>)"
+    const auto line = reader.line();
+    std::array<std::string_view, 4> fields;
+    std::size_t at = line.find('(');
+    for (std::size_t f = 0; f < fields.size(); f++) {
+        if (at == std::string_view::npos) {
+            reader.fail(line, "expected a quadruple");
+        }
+        const char end = f + 1 < fields.size() ? ',' : ')';
+        const std::size_t next = line.find(end, at + 1);
+        if (next == std::string_view::npos) {
+            reader.fail(line.substr(at),
+                        std::string("expected '") + end + "'");
+        }
+        fields[f] = line.substr(at + 1, next - at - 1);
+        at = next;
+    }
+
+    // Operands must name a declared symbol or temporary, and targets a
+    // quadruple of the listing or the one after its end
+    auto operand = [&](std::size_t f, bool isTarget) {
+        irStruct::Operand x;
+        try {
+            x = parseOperand(fields[f], isTarget);
+        } catch (const std::invalid_argument& e) {
+            reader.fail(fields[f], e.what());
+        }
+        const char* what = nullptr;
+        long long count = 0;
+        switch (x.kind) {
+            case irStruct::OperandKind::Symbol:
+                what = "symbol";
+                count = static_cast<int>(symbolTable.size());
+                break;
+            case irStruct::OperandKind::Temp:
+                what = "temporary";
+                count = temporaries;
+                break;
+            case irStruct::OperandKind::Target:
+                what = "jump target";
+                count = quadruples + 1LL;
+                break;
+            default:
+                return x;
+        }
+        if (x.index < 0 || x.index >= count) {
+            reader.fail(fields[f], std::string(what) + " " +
+                                       std::to_string(x.index) +
+                                       " out of range [0, " +
+                                       std::to_string(count) + ")");
+        }
+        return x;
+    };
+    irStruct::OpCode op = irStruct::OpCode::End;
+    try {
+        op = parseOpcode(fields[0]);
+    } catch (const std::invalid_argument& e) {
+        reader.fail(fields[0], e.what());
+    }
+    quad = irStruct::Quad(op, operand(1, false), operand(2, false),
+                          operand(3, isJump(op)));
+
+    pos = reader.position();
+    index++;
+    return true;
+}
+
+irStruct::Module readModule(std::string_view text) {
+    ListingReader reader(text);
+    irStruct::Module module;
+    module.symbols = reader.symbols();
+    module.temps.resize(reader.temporaryCount(), irStruct::ValueType::Int);
+    module.quads.reserve(reader.quadrupleCount());
+
+    irStruct::Quad quad;
+    while (reader.next(quad)) {
+        // Temporary types are only recorded in their names
+        for (const auto* operand : {&quad.arg1, &quad.arg2, &quad.result}) {
+            if (operand->kind == irStruct::OperandKind::Temp &&
+                operand->index >= 0 &&
+                static_cast<std::size_t>(operand->index) <
+                    module.temps.size()) {
+                module.temps[operand->index] = operand->type;
+            }
+        }
+        module.quads.push(quad);
+    }
+
+    return module;
+}
+
+irStruct::Module readModule(std::istream& is) {
+    const std::string text((std::istreambuf_iterator<char>(is)),
+                           std::istreambuf_iterator<char>());
+    return readModule(std::string_view(text));
+}
+
+}  // namespace irUtil
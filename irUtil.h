@@ -0,0 +1,223 @@
+#ifndef IRUTIL_H
+#define IRUTIL_H
+
+#include "irStruct.h"
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace irUtil {
+
+/**
+ * @brief Checks whether an operation is a jump (conditional or not).
+ *
+ * @param op The operation to check.
+ * @return bool True for j, j<rel> and jnz.
+ */
+bool isJump(irStruct::OpCode op);
+
+/**
+ * @brief Checks whether an operation is a conditional jump.
+ *
+ * @param op The operation to check.
+ * @return bool True for j<rel> and jnz.
+ */
+bool isConditionalJump(irStruct::OpCode op);
+
+/**
+ * @brief Checks whether an operation is a relational operator.
+ *
+ * @param op The operation to check.
+ * @return bool True for ==, !=, <, <=, > and >=.
+ */
+bool isRelational(irStruct::OpCode op);
+
+/**
+ * @brief Maps a relational operator onto the matching conditional jump.
+ *
+ * @param op A relational operator (e.g. Lt).
+ * @return irStruct::OpCode The conditional jump (e.g. JumpLt).
+ */
+irStruct::OpCode toJump(irStruct::OpCode op);
+
+/**
+ * @brief Maps a conditional jump other than jnz onto the matching relational
+ * operator; the inverse of toJump().
+ *
+ * @param op A conditional jump (e.g. JumpLt).
+ * @return irStruct::OpCode The relational operator (e.g. Lt).
+ */
+irStruct::OpCode fromJump(irStruct::OpCode op);
+
+/**
+ * @brief Returns the textual name of an operation as used in the quadruple
+ * listing (e.g. "+", "j<", "jnz", "End").
+ *
+ * @param op The operation.
+ * @return std::string_view The name of the operation.
+ */
+std::string_view opcodeName(irStruct::OpCode op);
+
+/**
+ * @brief Parses the textual name of an operation.
+ *
+ * @param name The name to parse.
+ * @return irStruct::OpCode The operation.
+ * @throws std::invalid_argument If the name is not a known operation.
+ */
+irStruct::OpCode parseOpcode(std::string_view name);
+
+/**
+ * @brief Returns the textual form of an operand (e.g. "TB3", "T7_d", "5",
+ * "3.500000", "-").
+ *
+ * @param op The operand.
+ * @return std::string The operand as it appears in the quadruple listing.
+ */
+std::string operandName(const irStruct::Operand& op);
+
+/**
+ * @brief Returns the operand of an integer literal too large for an
+ * immediate. The text is interned in a literal pool shared by all modules of
+ * the process, so equal texts give equal operands.
+ *
+ * @param text The digits of the literal.
+ * @return irStruct::Operand An ImmText operand.
+ */
+irStruct::Operand textLiteral(std::string_view text);
+
+/**
+ * @brief Returns the text of an ImmText operand.
+ *
+ * @param op An operand returned by textLiteral().
+ * @return std::string The digits of the literal.
+ */
+std::string literalText(const irStruct::Operand& op);
+
+/**
+ * @brief Parses the textual form of an operand.
+ *
+ * @param text The operand text.
+ * @param isTarget Whether the operand is the target slot of a jump.
+ * @return irStruct::Operand The parsed operand.
+ * @throws std::invalid_argument If the text is not a valid operand.
+ */
+irStruct::Operand parseOperand(std::string_view text, bool isTarget);
+
+/**
+ * @brief Evaluates an operation on literal operands at parse time, as the
+ * target computes it: !, && and || are bitwise on integers. Only literals of
+ * the same type are folded, and operations the target would trap on
+ * (division by zero, overflowing division) are left to run time.
+ *
+ * @param op An arithmetic, relational or logical operation.
+ * @param a The first operand.
+ * @param b The second operand, or "-" for Not.
+ * @return std::optional<irStruct::Operand> The literal result, or
+ * std::nullopt if the operation cannot be folded.
+ */
+std::optional<irStruct::Operand> fold(irStruct::OpCode op,
+                                      const irStruct::Operand& a,
+                                      const irStruct::Operand& b);
+
+/**
+ * @brief Returns the zero of an operand's type, as the left operand of a
+ * unary minus or the right one of a comparison with zero.
+ *
+ * @param x The operand.
+ * @return irStruct::Operand 0.0 for a double literal, 0 otherwise.
+ */
+irStruct::Operand zeroLike(const irStruct::Operand& x);
+
+/**
+ * @brief Prints a module in the textual quadruple format: symbol table,
+ * temporary count, quadruple count and one line per quadruple.
+ *
+ * @param module The module to print.
+ * @return std::vector<std::string> The listing, one line per element.
+ */
+std::vector<std::string> printModule(const irStruct::Module& module);
+
+/**
+ * @class ListingReader
+ * @brief Reads the textual quadruple format produced by printModule one
+ * quadruple at a time, in place, so a listing can be processed without
+ * holding all of its quadruples.
+ */
+class ListingReader {
+public:
+    /**
+     * @brief Reads the symbol table and the counts at the head of a listing.
+     *
+     * @param text The listing; it must outlive the reader.
+     * @throws std::invalid_argument If the head of the listing is malformed,
+     * e.g. a symbol type is neither 0 (int) nor 1 (double).
+     */
+    explicit ListingReader(std::string_view text);
+
+    /// The symbol table of the listing.
+    const std::vector<irStruct::SymbolEntry>& symbols() const {
+        return symbolTable;
+    }
+
+    /// The number of temporaries the listing declares.
+    int temporaryCount() const { return temporaries; }
+
+    /// The number of quadruples the listing declares.
+    int quadrupleCount() const { return quadruples; }
+
+    /**
+     * @brief Reads the next quadruple.
+     *
+     * @param quad Receives the quadruple.
+     * @return bool False once all quadruples have been read.
+     * @throws std::invalid_argument If the quadruple line is malformed, or
+     * names a symbol or temporary the listing does not declare or a jump
+     * target outside [0, quadrupleCount()]; the message gives the line and
+     * column.
+     */
+    bool next(irStruct::Quad& quad);
+
+    /**
+     * @brief Goes back to the first quadruple.
+     */
+    void rewind();
+
+private:
+    std::string_view text;  ///< The listing.
+    std::vector<irStruct::SymbolEntry> symbolTable;  ///< Its symbols.
+    int temporaries = 0;     ///< Declared temporary count.
+    int quadruples = 0;      ///< Declared quadruple count.
+    std::size_t first = 0;   ///< Offset of the first quadruple line.
+    std::size_t pos = 0;     ///< Offset of the next quadruple line.
+    int index = 0;           ///< Index of the next quadruple.
+};
+
+/**
+ * @brief Reads a module from the textual quadruple format produced by
+ * printModule, in place: numbers are parsed with std::from_chars and
+ * operands from slices of the text, without copying each line.
+ *
+ * @param text The listing, e.g. a string or a mapped file.
+ * @return irStruct::Module The module.
+ * @throws std::invalid_argument If the listing is malformed or refers to
+ * undeclared symbols, temporaries or quadruples; the message gives the line
+ * and column.
+ */
+irStruct::Module readModule(std::string_view text);
+
+/**
+ * @brief Reads a module from the textual quadruple format produced by
+ * printModule.
+ *
+ * @param is The stream containing the listing; it is read to the end.
+ * @return irStruct::Module The module.
+ * @throws std::invalid_argument If a quadruple line is malformed.
+ */
+irStruct::Module readModule(std::istream& is);
+
+}  // namespace irUtil
+
+#endif  // IRUTIL_H
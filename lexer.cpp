@@ -3,26 +3,43 @@
 #include <fstream>
 #include <cctype>
 #include <algorithm>
+#include <istream>
+#include <iterator>
 
 // Constructor for Lexer class
-Lexer::Lexer() {}
+Lexer::Lexer(std::pmr::memory_resource* resource) : resource(resource) {}
 
 // This function removes comments from the input string.
 // It handles both block comments (/* ... */) and line comments (// ...).
 std::string Lexer::removeComments(std::string str) {
-    // Remove block comments (/* ... */)
+    removeBlockComments(str);
+    removeLineComments(str);
+    return str;
+}
+
+// Removes block comments (/* ... */) and reports whether a comment was left
+// open or the rest of the input was erased
+Lexer::CommentState Lexer::removeBlockComments(std::string& str) {
+    CommentState state = CommentState::Closed;
     while (str.find("/*") != std::string::npos) {
         auto pos = str.find("/*");   // Find the start of a block comment
         auto pos1 = str.find("*/");  // Find the end of a block comment
-        if (pos1 == std::string::npos)
+        if (pos1 == std::string::npos) {
             str.erase(pos);  // If no end comment is found, erase from start
+            state = CommentState::Open;
+        } else if (pos1 < pos && pos - pos1 > 2) {
+            state = CommentState::Truncated;  // The erase below wraps around
+        }
         str.erase(
             pos,
             pos1 - pos +
                 2);  // Erase the comment part (including the comment markers)
     }
+    return state;
+}
 
-    // Remove line comments (// ...)
+// Removes line comments (// ...) together with their newline
+void Lexer::removeLineComments(std::string& str) {
     while (str.find("//") != std::string::npos) {
         auto pos = str.find("//");  // Find the start of a line comment
         auto pos1 =
@@ -30,36 +47,67 @@ std::string Lexer::removeComments(std::string str) {
         str.erase(pos, pos1 - pos +
                            1);  // Erase the comment from the start to the end
     }
-    return str;
 }
 
+namespace {
+
+// Length of the operator starting at position i of str: 2 or 1, or 0 if none
+// starts there. The two-character operators are tried first, as by a lookup
+// in OpKeyMap::operators of the next two characters and then of the next one
+size_t operatorLength(const std::string& str, size_t i) {
+    // Operator characters by position, built once from OpKeyMap::operators
+    struct Table {
+        bool single[256] = {};
+        std::vector<std::pair<char, char>> pairs;
+
+        Table() {
+            for (const auto& [op, _] : OpKeyMap::operators) {
+                if (op.size() == 1) {
+                    single[static_cast<unsigned char>(op[0])] = true;
+                } else {
+                    pairs.emplace_back(op[0], op[1]);
+                }
+            }
+        }
+    };
+    static const Table table;
+
+    if (i + 1 < str.size()) {
+        for (const auto& [first, second] : table.pairs) {
+            if (str[i] == first && str[i + 1] == second) {
+                return 2;
+            }
+        }
+    }
+    return table.single[static_cast<unsigned char>(str[i])] ? 1 : 0;
+}
+
+}  // namespace
+
 // This function adds spaces around operators in the input string to separate
 // them from adjacent tokens, making it easier for tokenization.
 std::string Lexer::insertSpaces(std::string str) {
     std::string s;
     auto n = str.size();
+    s.reserve(n + n / 2);
     for (size_t i = 0; i < n; i++) {
-        // Check if the current character and the next one form an operator
-        if (i + 2 <= n && OpKeyMap::operators.count(str.substr(i, 2)))
-            s.append(" ")
-                .append(str.substr(i++, 2))
-                .append(" ");  // Add a space around the operator
-        // Check if the current character is an operator
-        else if (i + 1 <= n && OpKeyMap::operators.count(str.substr(i, 1)))
-            s.append(" ").append(1, str[i]).append(
-                " ");  // Add a space around the operator
-        else
-            s.append(1,
-                     str[i]);  // Otherwise, just append the character as it is
+        // Check if the current character, or it and the next one, form an
+        // operator
+        if (auto length = operatorLength(str, i)) {
+            s.append(" ").append(str, i, length).append(" ");
+            i += length - 1;
+        } else {
+            s.push_back(str[i]);  // Otherwise, append the character as it is
+        }
     }
     return s;
 }
 
 // This function processes an identifier (e.g., a variable or function name)
 // from the string. It assumes the identifier starts at the given index.
-std::vector<std::string> Lexer::processIdentifier(std::string& token,
-                                                  size_t& idx) {
-    std::vector<std::string> ans;
+void Lexer::processIdentifier(const std::string& token,
+                              size_t& idx,
+                              std::pmr::vector<lexerStruct::Token>& ans) {
     std::string_view str_view(token);
     // Find the first non-alphabetical character starting from the given index
     auto end = std::find_if_not(str_view.begin() + idx, str_view.end(),
@@ -67,20 +115,20 @@ std::vector<std::string> Lexer::processIdentifier(std::string& token,
     std::string identifier(str_view.substr(
         idx, end - (str_view.begin() + idx)));  // Extract the identifier
     if (!identifier.empty()) {
-        ans.push_back(
-            identifier +
-            " IDENT\n");           // Add the identifier with "IDENT" token type
         idx += identifier.size();  // Move the index forward by the length of
                                    // the identifier
+        ans.emplace_back(
+            std::move(identifier),
+            lexerStruct::TokenKind::Identifier);  // Add as an IDENT token
     }
-    return ans;
 }
 
 // This function processes a number (integer or floating-point) from the string.
-// It starts at the given index and returns a vector containing the tokenized
-// number.
-std::vector<std::string> Lexer::processNumber(std::string& token, size_t& idx) {
-    std::vector<std::string> ans;
+// It starts at the given index and adds the tokenized number, if it is well
+// formed.
+void Lexer::processNumber(const std::string& token,
+                          size_t& idx,
+                          std::pmr::vector<lexerStruct::Token>& ans) {
     std::string_view str_view(token);
     std::string h;
     bool isFloat = false;
@@ -100,14 +148,14 @@ std::vector<std::string> Lexer::processNumber(std::string& token, size_t& idx) {
             err_msg.push_back(std::make_pair(
                 1, std::string("Malformed number: More than one decimal point "
                                "in a floating point number.\n")));
-            return {};  // Return empty if malformed number
+            return;  // Add nothing if malformed number
         }
         if (h.front() == '.' || h.back() == '.') {
             err_msg.push_back(std::make_pair(
                 2,
                 std::string("Malformed number: Decimal point at the beginning "
                             "or end of a floating point number.\n")));
-            return {};  // Return empty if malformed number
+            return;  // Add nothing if malformed number
         }
     }
 
@@ -116,76 +164,67 @@ std::vector<std::string> Lexer::processNumber(std::string& token, size_t& idx) {
         err_msg.push_back(std::make_pair(
             3,
             std::string("Malformed number: Leading zeros in an integer.\n")));
-        return {};  // Return empty if malformed number
+        return;  // Add nothing if malformed number
     }
 
     // Add the number to the result vector with the appropriate token type
-    ans.push_back(h + (isFloat ? " DOUBLE\n" : " INT\n"));
     idx += h.size();  // Move the index forward by the length of the number
-    return ans;
+    ans.emplace_back(std::move(h), isFloat ? lexerStruct::TokenKind::Double
+                                           : lexerStruct::TokenKind::Integer);
 }
 
 // This function processes operators (e.g., +, -, *, /, etc.) from the string.
-// It starts at the given index and returns the corresponding operator token.
-std::vector<std::string> Lexer::processOperator(std::string& token,
-                                                size_t& idx) {
-    std::vector<std::string> ans;
-    // Check for two-character operators first (e.g., "==", "+=")
-    if (idx + 2 <= token.size() &&
-        OpKeyMap::operators.count(token.substr(idx, 2))) {
-        ans.push_back(token.substr(idx, 2) + " " +
-                      OpKeyMap::operators.at(token.substr(idx, 2)) + "\n");
-        idx += 2;
-    }
-    // Check for single-character operators (e.g., "+", "-", "*")
-    else if (OpKeyMap::operators.count(token.substr(idx, 1))) {
-        ans.push_back(token.substr(idx, 1) + " " +
-                      OpKeyMap::operators.at(token.substr(idx, 1)) + "\n");
-        idx += 1;
+// It starts at the given index and adds the corresponding operator token.
+void Lexer::processOperator(const std::string& token,
+                            size_t& idx,
+                            std::pmr::vector<lexerStruct::Token>& ans) {
+    // Two-character operators (e.g., "==", "<=") are tried first
+    if (auto length = operatorLength(token, idx)) {
+        ans.emplace_back(token.substr(idx, length),
+                         lexerStruct::TokenKind::Operator);
+        idx += length;
     }
-    return ans;
 }
 
 // This function processes a keyword (e.g., "if", "else", "while") from the
-// string. If the token matches a known keyword, it returns the keyword with its
+// string. If the token matches a known keyword, it adds the keyword with its
 // token type.
-std::vector<std::string> Lexer::processKeyword(std::string& token) {
-    std::vector<std::string> ans;
-    if (OpKeyMap::keywords.count(token)) {
-        ans.push_back(token + ' ' + OpKeyMap::keywords.at(token) + '\n');
+bool Lexer::processKeyword(const std::string& token,
+                           std::pmr::vector<lexerStruct::Token>& ans) {
+    if (!OpKeyMap::keywords.count(token)) {
+        return false;
     }
-    return ans;
+    ans.emplace_back(token, lexerStruct::TokenKind::Keyword);
+    return true;
 }
 
 // This function processes a token by categorizing it into identifiers, numbers,
-// operators, or keywords. It returns a vector of corresponding tokens.
-std::vector<std::string> Lexer::processToken(std::string token) {
-    std::vector<std::string> ans;
+// operators, or keywords, and adds the corresponding tokens. On an
+// unrecognizable character none of them is added.
+void Lexer::processToken(const std::string& token,
+                         std::pmr::vector<lexerStruct::Token>& ans) {
+    const size_t start = ans.size();
     size_t idx = 0;
     bool alp = false;
     bool dig = false;
     // First, try processing the token as a keyword
-    auto keywordResult = processKeyword(token);
-    ans.insert(ans.end(), keywordResult.begin(), keywordResult.end());
-    if (!ans.empty())
-        return ans;  // Return early if it's a keyword
+    if (processKeyword(token, ans)) {
+        return;  // Return early if it's a keyword
+    }
 
     // Otherwise, process the token character by character
     while (idx < token.size()) {
         if (isalpha(token[idx])) {
             // If it's a letter, process it as an identifier
-            auto result = processIdentifier(token, idx);
-            ans.insert(ans.end(), result.begin(), result.end());
+            processIdentifier(token, idx, ans);
             alp = true;
         } else if (isdigit(token[idx]) || token[idx] == '.') {
             // If it's a digit or a decimal point, process it as a number
-            auto result = processNumber(token, idx);
-            ans.insert(ans.end(), result.begin(), result.end());
+            processNumber(token, idx, ans);
             dig = true;
         } else if (!isdigit(token[idx]) && !isalpha(token[idx])) {
             // If it's neither a letter nor a digit, process it as an operator
-            auto result = processOperator(token, idx);
-            ans.insert(ans.end(), result.begin(), result.end());
+            processOperator(token, idx, ans);
         }
         // Handle unrecognizable characters
         if (idx < token.size() &&
@@ -193,34 +232,129 @@ std::vector<std::string> Lexer::processToken(std::string token) {
             (dig == 0 && alp == 0)) {
             err_msg.push_back(
                 std::make_pair(4, std::string("Unrecognizable characters.\n")));
-            return {};  // Return empty if unrecognizable character found
+            ans.resize(start);  // Drop the token's parts found so far
+            return;
         }
         idx++;  // Move to the next character
     }
+}
+
+// Formats a token as one line of the token listing
+std::string Lexer::formatToken(const lexerStruct::Token& token) {
+    return token.text + " " + lexerStruct::category(token) + "\n";
+}
+
+// Produces the token listing: one "text CATEGORY" line per token
+std::vector<std::string> Lexer::lexer(const std::string& str) {
+    std::vector<std::string> ans;
+    for (const auto& token : tokenize(str)) {
+        ans.push_back(formatToken(token));
+    }
     return ans;
 }
 
 // The main lexer function that processes the input string by first removing
 // comments, adding spaces around operators, and then breaking the string into
 // tokens.
-std::vector<std::string> Lexer::lexer(const std::string& str) {
-    std::vector<std::string> ans;
+std::vector<lexerStruct::Token> Lexer::tokenize(const std::string& str) {
+    std::vector<lexerStruct::Token> ans;
     std::string tempStr = removeComments(str);  // Remove comments
     tempStr = insertSpaces(tempStr);            // Add spaces around operators
     std::string token;
+    std::pmr::vector<lexerStruct::Token> run(resource);  // The word's tokens
     int n = tempStr.size();
     // Split the string into tokens based on spaces, newlines, and tabs
     for (int i = 0; i < n; i++) {
         if (tempStr[i] == ' ' || tempStr[i] == '\n' || tempStr[i] == '\t') {
             if (!token.empty()) {
                 // Process the token when a whitespace is encountered
-                auto tokens = processToken(token);
-                ans.insert(ans.end(), tokens.begin(), tokens.end());
+                processToken(token, run);
+                std::move(run.begin(), run.end(), std::back_inserter(ans));
+                run.clear();
             }
-            token = "";  // Clear the current token
+            token.clear();  // Clear the current token
         } else {
             token += tempStr[i];  // Append the current character to the token
         }
     }
     return ans;
 }
+
+TokenStream::TokenStream(std::istream& in) : input(in) {}
+
+// Hands out the next token, lexing further input when none is ready
+bool TokenStream::next(lexerStruct::Token& token) {
+    while (ready.empty()) {
+        if (finished) {
+            return false;
+        }
+        fill();
+    }
+    token = std::move(ready.front());
+    ready.pop_front();
+    handedOut++;
+    return true;
+}
+
+// Reads input lines until at least one token is ready or the input ends.
+// The text is lexed in chunks that end with a newline outside of any
+// comment, so every stage gives the same result as on the whole input.
+void TokenStream::fill() {
+    std::string line;
+    while (ready.empty()) {
+        const bool last = !std::getline(input, line);
+        if (!last) {
+            line += '\n';
+            // An open block comment can only close on a line with "*/"
+            const bool closes = line.find("*/") != std::string::npos;
+            blockBuffer += line;
+            if (blockOpen && !closes) {
+                continue;
+            }
+        }
+
+        // Block comments; an earlier "*/" is stood in for by a prefix
+        std::string text = closerSeen ? "*/\n" + blockBuffer : blockBuffer;
+        auto state = lexer.removeBlockComments(text);
+        if (state == Lexer::CommentState::Open && !last) {
+            blockOpen = true;
+            continue;
+        }
+        if (closerSeen) {
+            text.erase(0, 3);
+        }
+        blockBuffer.clear();
+        blockOpen = false;
+        truncated = truncated || state == Lexer::CommentState::Truncated;
+        closerSeen = closerSeen || text.find("*/") != std::string::npos;
+
+        // Line comments; a comment at the end joins the next line
+        lineBuffer += text;
+        lexer.removeLineComments(lineBuffer);
+        const bool end = last || truncated;  // Nothing can follow a truncation
+        // Keep the text after the last newline (npos + 1 wraps to 0)
+        size_t cut = end ? lineBuffer.size() : lineBuffer.rfind('\n') + 1;
+        std::string chunk = lexer.insertSpaces(lineBuffer.substr(0, cut));
+        lineBuffer.erase(0, cut);
+
+        // Split the chunk into tokens based on spaces, newlines, and tabs
+        for (char c : chunk) {
+            if (c == ' ' || c == '\n' || c == '\t') {
+                if (!word.empty()) {
+                    lexer.processToken(word, run);
+                    std::move(run.begin(), run.end(),
+                              std::back_inserter(ready));
+                    run.clear();
+                }
+                word.clear();
+            } else {
+                word += c;
+            }
+        }
+
+        if (end) {
+            finished = true;  // A token without trailing whitespace is dropped
+            return;
+        }
+    }
+}
@@ -1,9 +1,13 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <deque>
+#include <istream>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory_resource>
+#include "lexerStruct.h"
 #include "opkeymap.h"
 
 /**
@@ -20,8 +24,11 @@ public:
 
     /**
      * @brief Constructs a Lexer object and initializes necessary components.
+     * @param resource Allocates the lexer's scratch containers, e.g. a
+     * per-compilation arena; it must outlive the lexer.
      */
-    Lexer();
+    explicit Lexer(std::pmr::memory_resource* resource =
+                       std::pmr::get_default_resource());
 
     /**
      * @brief Analyzes the input string and generates a list of tokens.
@@ -31,7 +38,36 @@ public:
      */
     std::vector<std::string> lexer(const std::string& str);
 
+    /**
+     * @brief Analyzes the input string and returns the tokens in memory,
+     * ready to be handed to the parser.
+     *
+     * @param str The input string to be tokenized.
+     * @return A vector of tokens.
+     */
+    std::vector<lexerStruct::Token> tokenize(const std::string& str);
+
+    /**
+     * @brief Formats a token as a line of the token listing ("text CATEGORY").
+     *
+     * @param token The token to format.
+     * @return The formatted line, including the trailing newline.
+     */
+    static std::string formatToken(const lexerStruct::Token& token);
+
 private:
+    friend class TokenStream;
+
+    /**
+     * @enum CommentState
+     * @brief Outcome of removing the block comments of a piece of input.
+     */
+    enum class CommentState {
+        Closed,    ///< Every block comment was closed.
+        Open,      ///< A block comment runs to the end of the input so far.
+        Truncated  ///< A "/*" after an earlier "*/" erased the rest.
+    };
+
     /**
      * @brief Removes comments from the input string.
      * 
@@ -40,6 +76,23 @@ private:
      */
     std::string removeComments(std::string str);
 
+    /**
+     * @brief Removes the block comments from the input string.
+     *
+     * @param str The input string, modified in place.
+     * @return CommentState Whether a comment was left open or truncated the
+     * input.
+     */
+    CommentState removeBlockComments(std::string& str);
+
+    /**
+     * @brief Removes the line comments, with their newline, from the input
+     * string.
+     *
+     * @param str The input string, modified in place.
+     */
+    void removeLineComments(std::string& str);
+
     /**
      * @brief Inserts spaces where necessary to separate tokens in the input string.
      * 
@@ -53,43 +106,109 @@ private:
      * 
      * @param token The current token being analyzed.
      * @param idx The current index in the string being processed.
-     * @return A vector of strings containing the identified tokens.
+     * @param ans Receives the identified token.
      */
-    std::vector<std::string> processIdentifier(std::string& token, size_t& idx);
+    void processIdentifier(const std::string& token, size_t& idx,
+                           std::pmr::vector<lexerStruct::Token>& ans);
 
     /**
      * @brief Processes numbers, including integers and floating-point values.
      * 
      * @param token The current token being analyzed.
      * @param idx The current index in the string being processed.
-     * @return A vector of strings containing the identified number tokens.
+     * @param ans Receives the identified number token, unless it is
+     * malformed.
      */
-    std::vector<std::string> processNumber(std::string& token, size_t& idx);
+    void processNumber(const std::string& token, size_t& idx,
+                       std::pmr::vector<lexerStruct::Token>& ans);
 
     /**
      * @brief Processes operators such as '+', '-', '*', and so on.
      * 
      * @param token The current token being analyzed.
      * @param idx The current index in the string being processed.
-     * @return A vector of strings containing the identified operator tokens.
+     * @param ans Receives the identified operator token.
      */
-    std::vector<std::string> processOperator(std::string& token, size_t& idx);
+    void processOperator(const std::string& token, size_t& idx,
+                         std::pmr::vector<lexerStruct::Token>& ans);
 
     /**
      * @brief Processes keywords such as 'if', 'else', 'while', etc.
      * 
      * @param token The current token being analyzed.
-     * @return A vector of strings containing the identified keyword tokens.
+     * @param ans Receives the keyword token.
+     * @return bool True if the token is a keyword.
      */
-    std::vector<std::string> processKeyword(std::string& token);
+    bool processKeyword(const std::string& token,
+                        std::pmr::vector<lexerStruct::Token>& ans);
 
     /**
      * @brief Processes a single token and identifies its components.
      * 
      * @param token The token to be processed.
-     * @return A vector of strings representing the processed token components.
+     * @param ans Receives the token's components; nothing is added if it
+     * holds an unrecognizable character.
      */
-    std::vector<std::string> processToken(std::string token);
+    void processToken(const std::string& token,
+                      std::pmr::vector<lexerStruct::Token>& ans);
+
+    std::pmr::memory_resource* resource;  ///< Allocates the token runs.
+};
+
+/**
+ * @class TokenStream
+ * @brief Pull-based lexer: reads the input line by line and hands out the
+ * tokens one at a time, producing the same tokens as Lexer::tokenize. Only
+ * the tokens of the current line (or of a comment spanning several lines)
+ * are kept in memory.
+ */
+class TokenStream {
+public:
+    /**
+     * @brief Constructs a stream over an input.
+     *
+     * @param in The source code input.
+     */
+    explicit TokenStream(std::istream& in);
+
+    /**
+     * @brief Fetches the next token.
+     *
+     * @param token Receives the token.
+     * @return bool False once the input is exhausted.
+     */
+    bool next(lexerStruct::Token& token);
+
+    /**
+     * @brief Returns the lexical errors met so far.
+     */
+    const std::vector<std::pair<int, std::string>>& errors() const {
+        return lexer.err_msg;
+    }
+
+    /**
+     * @brief Returns the number of tokens handed out so far.
+     */
+    std::size_t count() const { return handedOut; }
+
+private:
+    /**
+     * @brief Lexes input until a token is ready or the input ends.
+     */
+    void fill();
+
+    std::istream& input;                   ///< The source code input.
+    Lexer lexer;                           ///< Tokenizer and error sink.
+    std::deque<lexerStruct::Token> ready;  ///< Tokens not yet handed out.
+    std::string blockBuffer;  ///< Lines inside an unclosed block comment.
+    std::string lineBuffer;   ///< Text joined to the next line by a comment.
+    std::string word;         ///< Token text not yet ended by whitespace.
+    std::pmr::vector<lexerStruct::Token> run;  ///< Tokens of the last word.
+    bool blockOpen = false;   ///< blockBuffer holds an unclosed comment.
+    bool closerSeen = false;  ///< A "*/" was kept in the text so far.
+    bool truncated = false;   ///< The rest of the input is erased.
+    bool finished = false;    ///< The input is exhausted.
+    std::size_t handedOut = 0;  ///< Tokens handed out so far.
 };
 
 #endif  // LEXER_H
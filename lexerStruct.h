@@ -0,0 +1,60 @@
+#ifndef LEXERSTRUCT_H
+#define LEXERSTRUCT_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "opkeymap.h"
+
+namespace lexerStruct {
+
+/**
+ * @enum TokenKind
+ * @brief Lexical category of a token.
+ */
+enum class TokenKind : std::uint8_t {
+    Identifier,  ///< Variable name, printed as IDENT.
+    Integer,     ///< Integer literal, printed as INT.
+    Double,      ///< Floating point literal, printed as DOUBLE.
+    Operator,    ///< Operator or delimiter, category from OpKeyMap::operators.
+    Keyword      ///< Reserved word, category from OpKeyMap::keywords.
+};
+
+/**
+ * @struct Token
+ * @brief A token handed from the lexer to the parser.
+ */
+struct Token {
+    std::string text;  ///< The source text of the token.
+    TokenKind kind;    ///< The lexical category of the token.
+
+    Token(std::string t, TokenKind k) : text(std::move(t)), kind(k) {}
+
+    Token() : kind(TokenKind::Operator) {}
+};
+
+/**
+ * @brief Returns the category name of a token as printed in the token
+ * listing (e.g. IDENT, INT, RO, WHILESYM).
+ *
+ * @param token The token.
+ * @return std::string The category name.
+ */
+inline std::string category(const Token& token) {
+    switch (token.kind) {
+        case TokenKind::Identifier:
+            return "IDENT";
+        case TokenKind::Integer:
+            return "INT";
+        case TokenKind::Double:
+            return "DOUBLE";
+        case TokenKind::Operator:
+            return OpKeyMap::operators.at(token.text);
+        default:
+            return OpKeyMap::keywords.at(token.text);
+    }
+}
+
+}  // namespace lexerStruct
+
+#endif  // LEXERSTRUCT_H
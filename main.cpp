@@ -1,76 +1,217 @@
-#include <algorithm>
 #include <iostream>
 #include <fstream>
-#include "lexer.h"
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "irBinary.h"
+#include "irUtil.h"
 #include "parser.h"
-#include "objectGen.h"
+#include "pipeline.h"
 
-#define TASK 3
-
-void main_lexer() {
-    std::string s, str;
+int main(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(0);
 
-#ifdef ONLINE_JUDGE
-    std::ifstream input("1in");
-    if (input.is_open()) {
-        while (getline(input, s)) {
-            str += s + '\n';
+    pipeline::Options options;
+    std::string path;
+    std::vector<std::string> versions;  // Further paths with --incremental,
+                                        // --check or --batch
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--gen-parser") {
+            // Regenerates parserDirect.inc from the grammar
+            Parser().writeDirectParser(std::cout);
+            return 0;
+        }
+        if (arg.rfind("--", 0) != 0 && path.empty()) {
+            path = arg;
+        } else if (arg.rfind("--", 0) != 0) {
+            versions.push_back(arg);
+        } else if (!pipeline::parseOption(arg, options)) {
+            std::cerr << "Unknown option: " << arg << "\n"
+                      << "Usage: " << argv[0]
+                      << " [--emit=tokens|quads|qir|asm]"
+                         " [--input=source|quads|qir]"
+                         " [--parser=table|direct|descent]"
+                         " [--stream] [--threads] [--parse-jobs=N]"
+                         " [--codegen-jobs=N] [--ast] [--fold]"
+                         " [--opt=pass,...]"
+                         " [file]\n"
+                      << "       " << argv[0]
+                      << " --incremental [--emit=...] file...\n"
+                      << "       " << argv[0] << " --check file...\n"
+                      << "       " << argv[0]
+                      << " --batch [--emit=...] file...\n"
+                      << "       " << argv[0] << " --gen-parser\n";
+            return 1;
         }
-        input.close();
-    } else {
-        std::cout << "Failed to open input file." << std::endl;
-        return;
     }
-#else
-    while (getline(std::cin, s)) {
-        str += s + '\n';
+    if (!versions.empty() && !options.incremental && !options.check &&
+        !options.batch) {
+        std::cerr << "Only --incremental, --check and --batch take several "
+                     "files\n";
+        return 1;
+    }
+    // Streaming and threaded compilation run their own sequential parser,
+    // which emits quadruples directly, over one program
+    if ((options.stream || options.threads) &&
+        (options.incremental || options.check || options.batch)) {
+        std::cerr << "--stream and --threads do not combine with "
+                     "--incremental, --check or --batch\n";
+        return 1;
+    }
+    if ((options.stream || options.threads) &&
+        (options.ast || options.parseJobs > 1)) {
+        std::cerr << "--stream and --threads do not combine with --ast or "
+                     "--parse-jobs\n";
+        return 1;
     }
-#endif
 
-#if (TASK == 3)
-    ObjectCodeGenerator ocg;
-    auto ans = ocg.generate(str);
-    std::cout << ans;
-    return;
-#else
-    Lexer lexer;
-    auto ans = lexer.lexer(str);
+    try {
+        // Each file is checked on its own, with the same parser tables
+        if (options.check && !path.empty()) {
+            versions.insert(versions.begin(), path);
+            Parser parser;
+            bool valid = true;
+            for (const auto& name : versions) {
+                std::ifstream file(name, std::ios::binary);
+                if (!file.is_open()) {
+                    std::cerr << "Failed to open input file." << std::endl;
+                    return 1;
+                }
+                std::string source((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+                std::string error = pipeline::check(source, parser);
+                std::cout << name << ": " << (error.empty() ? "OK\n" : error);
+                valid = valid && error.empty();
+            }
+            return valid ? 0 : 1;
+        }
 
-    if (ans.empty())
-        return;
+        // Each file is a separate program, compiled in a reused arena
+        if (options.batch && !path.empty()) {
+            versions.insert(versions.begin(), path);
+            std::vector<std::string> sources;
+            for (const auto& name : versions) {
+                std::ifstream file(name, std::ios::binary);
+                if (!file.is_open()) {
+                    std::cerr << "Failed to open input file." << std::endl;
+                    return 1;
+                }
+                sources.emplace_back(std::istreambuf_iterator<char>(file),
+                                     std::istreambuf_iterator<char>());
+            }
+            for (const auto& out : pipeline::runBatch(sources, options)) {
+                std::cout << out;
+            }
+            return 0;
+        }
 
-    if (lexer.err_msg.size()) {
-        std::sort(ans.begin(), ans.end());
-        std::cout << lexer.err_msg[0].second;
-        return;
-    }
+        // Each file is the next version of the same program
+        if (options.incremental && !path.empty()) {
+            versions.insert(versions.begin(), path);
+            std::vector<std::string> sources;
+            for (const auto& version : versions) {
+                std::ifstream file(version, std::ios::binary);
+                if (!file.is_open()) {
+                    std::cerr << "Failed to open input file." << std::endl;
+                    return 1;
+                }
+                sources.emplace_back(std::istreambuf_iterator<char>(file),
+                                     std::istreambuf_iterator<char>());
+            }
+            for (const auto& out : pipeline::runEdits(sources, options)) {
+                std::cout << out;
+            }
+            return 0;
+        }
 
-#if (TASK == 1)
-    for (const auto& s : ans) {
-        std::cout << s;
-    }
-#elif (TASK == 2)
-#ifdef DEBUG
-    std::cout << "[DEBUG] ===== lexer out =====\n";
-    int dbg_cnt = 0;
-    for (const auto& s : ans) {
-        std::cout << "[DEBUG] l#" << ++dbg_cnt << ": " << s;
-    }
-    std::cout << "[DEBUG] ===== lexer end =====\n\n";
-#endif
-    Parser parser;
-    ans = parser.parser(ans);
-    for (const auto& s : ans) {
-        if (s[0] == '$') exit(0);
-        std::cout << s;
-    }
+        // A binary module given by path is mapped, so that it is validated
+        // and decoded into the module without reading it into a buffer
+        if (!path.empty() && options.input == pipeline::InputKind::Binary) {
+            irBinary::MappedFile file(path);
+            std::cout << pipeline::runModule(file.view().toModule(), options);
+            return 0;
+        }
+
+        // So is a quadruple listing, which is parsed without copying it
+        if (!path.empty() && options.input == pipeline::InputKind::Quads) {
+            irBinary::MappedFile file(path);
+            const std::string_view listing(file.data(), file.size());
+            if (options.stream) {
+                pipeline::runListing(listing, options, std::cout);
+            } else {
+                std::cout << pipeline::runModule(irUtil::readModule(listing),
+                                                 options);
+            }
+            return 0;
+        }
+
+        // Source code can be compiled while it is read
+        if ((options.stream || options.threads) &&
+            options.input == pipeline::InputKind::Source) {
+            std::ifstream file;
+#ifdef ONLINE_JUDGE
+            file.open(path.empty() ? "1in" : path);
+#else
+            if (!path.empty()) {
+                file.open(path);
+            }
 #endif
+            auto compile = options.threads ? pipeline::runThreaded
+                                           : pipeline::runStream;
+            if (file.is_open()) {
+                std::cout << compile(file, options);
+            } else if (path.empty()) {
+                std::cout << compile(std::cin, options);
+            } else {
+                std::cerr << "Failed to open input file." << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+
+        std::string s, str;
+        if (!path.empty() || options.input == pipeline::InputKind::Binary) {
+            std::ifstream file;
+            if (!path.empty()) {
+                file.open(path, std::ios::binary);
+                if (!file.is_open()) {
+                    std::cerr << "Failed to open input file." << std::endl;
+                    return 1;
+                }
+            }
+            std::istream& in = path.empty() ? std::cin : file;
+            str.assign(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+        } else {
+#ifdef ONLINE_JUDGE
+            std::ifstream input("1in");
+            if (input.is_open()) {
+                while (getline(input, s)) {
+                    str += s + '\n';
+                }
+                input.close();
+            } else {
+                std::cout << "Failed to open input file." << std::endl;
+                return 0;
+            }
+#else
+            while (getline(std::cin, s)) {
+                str += s + '\n';
+            }
 #endif
-}
+        }
 
-int main() {
-    std::ios::sync_with_stdio(false);
-    std::cin.tie(0);
-    main_lexer();
+        if (options.stream && options.input == pipeline::InputKind::Quads) {
+            pipeline::runListing(str, options, std::cout);
+        } else {
+            std::cout << pipeline::run(str, options);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
     return 0;
 }
@@ -1,437 +1,837 @@
 #include "objectGen.h"
+#include "irCfg.h"
+#include "irUtil.h"
+#include <atomic>
+#include <charconv>
 #include <climits>
 #include <optional>
-
-std::string ObjectCodeGenerator::generate(const std::string& input) {
-    std::istringstream iss(input);
-    parseInput(iss);
-    if (quadruples.empty()) {
-        return "halt\n";
+#include <thread>
+
+namespace {
+
+constexpr std::size_t OPCODE_COUNT =
+    static_cast<std::size_t>(irStruct::OpCode::End) + 1;
+
+constexpr std::size_t MACHINE_OP_COUNT =
+    static_cast<std::size_t>(objectStruct::MachineOp::Halt) + 1;
+
+// Assembler names indexed by MachineOp
+constexpr std::array<std::string_view, MACHINE_OP_COUNT> MACHINE_OP_NAMES{
+    "mov",  "add",   "sub",  "mul",   "div",  "cmp",       "and",
+    "or",   "not",   "sete", "setne", "setl", "setle",     "setg",
+    "setge", "jmp",  "je",   "jne",   "jl",   "jle",       "jg",
+    "jge",  "jmp ?read", "jmp ?write", "halt"};
+
+// Instructions from OpKeyMap by OpCode, empty where there is none
+struct Mnemonics {
+    std::array<std::optional<objectStruct::MachineOp>, OPCODE_COUNT> operation;
+    std::array<std::optional<objectStruct::MachineOp>, OPCODE_COUNT> set;
+    std::array<std::optional<objectStruct::MachineOp>, OPCODE_COUNT> jump;
+
+    Mnemonics() {
+        auto fill = [](const auto& map, auto& table, std::size_t i) {
+            auto it = map.find(std::string(
+                irUtil::opcodeName(static_cast<irStruct::OpCode>(i))));
+            if (it == map.end()) {
+                return;
+            }
+            std::string_view name(it->second);
+            name = name.substr(0, name.find(' '));
+            auto op = std::find(MACHINE_OP_NAMES.begin(),
+                                MACHINE_OP_NAMES.end(), name);
+            if (op != MACHINE_OP_NAMES.end()) {
+                table[i] = static_cast<objectStruct::MachineOp>(
+                    op - MACHINE_OP_NAMES.begin());
+            }
+        };
+        for (std::size_t i = 0; i < OPCODE_COUNT; i++) {
+            fill(OpKeyMap::optAssembler, operation, i);
+            fill(OpKeyMap::setAssembler, set, i);
+            fill(OpKeyMap::jumpAssembler, jump, i);
+        }
     }
+};
 
-    analyzeBlocks();
-    analyzeVariableUsage();
-    generateCode();
-    return formatOutput();
+const Mnemonics& mnemonics() {
+    static const Mnemonics table;
+    return table;
 }
 
-void ObjectCodeGenerator::parseInput(std::istringstream& iss) {
-    int n = 0;
-    iss >> n;
+// Appends the decimal digits of a number
+void appendNumber(std::string& out, std::int64_t value) {
+    char buffer[24];
+    auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, end);
+}
 
-    for (int i = 0; i < n; i++) {
-        objectStruct::MemoryNode node;
-        std::string t;
-        iss >> node.name >> node.type >> t >> node.offset;
-        symbolTable.push_back(node);
-        variableSet.insert(node.name);
+// Appends an instruction operand as it appears in the listing
+void appendOperand(std::string& out, const objectStruct::MachineOperand& x) {
+    switch (x.kind) {
+        case objectStruct::MachineOperandKind::Register:
+            out += 'R';
+            appendNumber(out, x.value);
+            break;
+        case objectStruct::MachineOperandKind::Memory:
+            out += "[ebp-";
+            appendNumber(out, x.value);
+            out += ']';
+            break;
+        case objectStruct::MachineOperandKind::Immediate:
+            appendNumber(out, x.value);
+            break;
+        case objectStruct::MachineOperandKind::Real: {
+            // Six decimals, as std::to_string prints the quadruple listing
+            char buffer[400];
+            auto [end, ec] =
+                std::to_chars(buffer, buffer + sizeof(buffer), x.real,
+                              std::chars_format::fixed, 6);
+            out.append(buffer, end);
+            break;
+        }
+        case objectStruct::MachineOperandKind::Label:
+            out += '?';
+            appendNumber(out, x.value);
+            break;
+        case objectStruct::MachineOperandKind::Text:
+            out += irUtil::literalText(
+                irStruct::Operand::immText(static_cast<int>(x.value)));
+            break;
+        default:
+            out += '-';
     }
+}
 
-    if (!symbolTable.empty()) {
-        offset = symbolTable.back().offset;
-        offset += (symbolTable.back().type == 0) ? 4 : 8;
+// Appends one instruction line
+void appendInstruction(std::string& out,
+                       const objectStruct::Instruction& instruction) {
+    using objectStruct::MachineOp;
+    out += MACHINE_OP_NAMES[static_cast<std::size_t>(instruction.op)];
+    if (instruction.op == MachineOp::Read ||
+        instruction.op == MachineOp::Write) {
+        out += '(';
+        appendOperand(out, instruction.dst);
+        out += ')';
+    } else if (instruction.op != MachineOp::Halt) {
+        out += ' ';
+        appendOperand(out, instruction.dst);
+        if (instruction.op <= MachineOp::Or) {
+            out += ", ";
+            appendOperand(out, instruction.src);
+        }
     }
+    out += '\n';
+}
 
-    iss >> temporaryVarSize;
-    temporaryVariables.resize(temporaryVarSize);
+// Bit of a register in an address descriptor
+constexpr std::uint8_t registerBit(int reg) {
+    return static_cast<std::uint8_t>(1u << reg);
+}
 
-    iss >> numberOfQuadruples;
-    labelFlags.resize(numberOfQuadruples);
-    resultCode.resize(numberOfQuadruples);
+}  // namespace
+
+ObjectCodeGenerator::BlockState::BlockState(
+    std::pmr::memory_resource* resource)
+    : usePosition(resource),
+      availableExpressions(resource),
+      touchedVariables(resource),
+      labels(resource),
+      deferredTemps(resource),
+      deferred(resource) {
+    registerValues.fill(-1);
+}
 
-    std::string line;
-    std::getline(iss, line);
-    for (int i = 0; i < numberOfQuadruples; i++) {
-        std::getline(iss, line);
-        quadruples.push_back(parserUtil::parseQuadTuple(line));
-    }
+ObjectCodeGenerator::ObjectCodeGenerator(std::pmr::memory_resource* resource)
+    : module{{}, {}, irStruct::QuadList(resource)},
+      blocks(resource),
+      blockState(resource),
+      code(resource),
+      blockCode(resource),
+      usageTable(resource) {
+    blockState.code = &code;
 }
 
-void ObjectCodeGenerator::analyzeBlocks() {
-    std::vector<bool> basicBlockEntryPoints(quadruples.size(), false);
-    basicBlockEntryPoints[0] = true;
+void ObjectCodeGenerator::setJobs(unsigned count) {
+    jobs = std::max(count, 1u);
+}
 
-    // Identify all basic block entry points
-    for (size_t quadIndex = 0; quadIndex < quadruples.size(); ++quadIndex) {
-        const auto& currentQuad = quadruples[quadIndex];
+std::string ObjectCodeGenerator::generate(std::string_view input) {
+    parseInput(input);
+    return generate(std::move(module));
+}
 
-        // Using string_view for more efficient string operations
-        std::string_view operation{currentQuad.operation};
+std::string ObjectCodeGenerator::generate(irStruct::Module input) {
+    module = std::move(input);
+    prepareModule();
+    if (module.quads.empty()) {
+        return "halt\n";
+    }
 
-        // Check for jump instructions
-        if (operation[0] == 'j') {
-            const auto targetIndex = std::stoi(currentQuad.destination);
-            basicBlockEntryPoints[targetIndex] = true;
+    analyzeBlocks();
+    analyzeVariableUsage();
+    generateCode();
+    return formatOutput();
+}
 
-            // For conditional jumps, mark the fall-through block
-            if (operation != "j" && quadIndex < quadruples.size() - 1) {
-                basicBlockEntryPoints[quadIndex + 1] = true;
+void ObjectCodeGenerator::generateStreaming(std::string_view input,
+                                            std::ostream& out) {
+    irUtil::ListingReader reader(input);
+    module = irStruct::Module();
+    module.symbols = reader.symbols();
+    module.temps.resize(reader.temporaryCount(), irStruct::ValueType::Int);
+    prepareModule();
+
+    // First scan: block entry points and ends, as analyzeBlocks() finds
+    // them, and the types of the temporaries
+    const int count = reader.quadrupleCount();
+    std::vector<bool> entries(count), ends(count);
+    std::vector<std::pair<int, int>> jumps;
+    irStruct::Quad quad;
+    for (int i = 0; reader.next(quad); i++) {
+        if (irUtil::isJump(quad.op)) {
+            const int target = quad.result.index;
+            if (target >= 0 && target < count) {
+                entries[target] = true;
             }
+            if (quad.op != irStruct::OpCode::Jump && i < count - 1) {
+                entries[i + 1] = true;
+            }
+            jumps.emplace_back(i, target);
+        }
+        if (quad.op == irStruct::OpCode::Write ||
+            quad.op == irStruct::OpCode::Read) {
+            entries[i] = true;
         }
+        ends[i] = irUtil::isJump(quad.op) || quad.op == irStruct::OpCode::End;
 
-        // Mark I/O operations as block boundaries
-        if (operation == "W" || operation == "R") {
-            basicBlockEntryPoints[quadIndex] = true;
+        for (const auto* operand : {&quad.arg1, &quad.arg2, &quad.result}) {
+            if (operand->kind == irStruct::OperandKind::Temp &&
+                operand->index >= 0 &&
+                static_cast<size_t>(operand->index) < module.temps.size()) {
+                module.temps[operand->index] = operand->type;
+            }
         }
     }
+    if (count == 0) {
+        out << "halt\n";
+        return;
+    }
+    entries[0] = true;
 
-    // Construct basic blocks
-    blocks.clear();  // Ensure blocks container is empty
-
-    for (size_t currentIndex = 0;
-         currentIndex < basicBlockEntryPoints.size();) {
-        if (!basicBlockEntryPoints[currentIndex]) {
-            ++currentIndex;
+    // Quadruples following the end of a block without being an entry point
+    // belong to no block; the jumps of the others need labels
+    std::vector<bool> reached(count);
+    for (int i = 0; i < count; i++) {
+        reached[i] = entries[i] || (i > 0 && reached[i - 1] && !ends[i - 1]);
+    }
+    labelFlags.assign(count, false);
+    for (const auto& [source, target] : jumps) {
+        if (reached[source]) {
+            markLabel(target);
+        }
+    }
+    jumps = {};
+
+    // Second scan: generate and print each block once it is complete
+    memoryUsage.assign(module.symbols.size(), {-1, 1});
+    temporaryUsage.assign(module.temps.size(), {-1, 0});
+    reader.rewind();
+    for (int i = 0; reader.next(quad); i++) {
+        if (!reached[i]) {
+            continue;
+        }
+        if (entries[i]) {
+            firstQuad = i;
+        }
+        module.quads.push(quad);
+        if (i + 1 < count && !entries[i + 1] && !ends[i]) {
             continue;
         }
 
-        // Find the end of the current basic block
-        auto blockEndIndex = currentIndex + 1;
-        for (; blockEndIndex < basicBlockEntryPoints.size(); ++blockEndIndex) {
-            const auto& prevQuad = quadruples[blockEndIndex - 1];
-            if (basicBlockEntryPoints[blockEndIndex] ||
-                prevQuad.operation[0] == 'j' || prevQuad.operation == "End") {
-                break;
+        const std::pair<int, int> block(firstQuad, i);
+        usageTable.assign(module.quads.size(), {});
+        analyzeBlockUsage(block);
+        blocks.assign(1, block);
+        blockCode.clear();
+        code.clear();
+        generateInOrder(block);
+        out << formatOutput();
+        module.quads.clear();
+    }
+}
+
+void ObjectCodeGenerator::begin(std::vector<irStruct::SymbolEntry> symbols) {
+    module = irStruct::Module();
+    module.symbols = std::move(symbols);
+    prepareModule();
+    memoryUsage.resize(module.symbols.size(), {-1, 1});
+}
+
+void ObjectCodeGenerator::addBlock(const std::vector<irStruct::Quad>& quads,
+                                   int start) {
+    for (const auto& quad : quads) {
+        module.quads.push(quad);
+
+        // Temporary types are only recorded in the operands
+        for (const auto* operand : {&quad.arg1, &quad.arg2, &quad.result}) {
+            if (operand->kind == irStruct::OperandKind::Temp) {
+                const size_t index = operand->index;
+                if (index >= module.temps.size()) {
+                    module.temps.resize(index + 1);
+                }
+                module.temps[operand->index] = operand->type;
             }
         }
+    }
+
+    const size_t size = module.quads.size();
+    usageTable.resize(size);
+    labelFlags.resize(std::max(labelFlags.size(), size));
+    temporaryVariables.resize(module.temps.size(), -1);
+    temporaryUsage.resize(module.temps.size(), {-1, 0});
+
+    blocks.emplace_back(start, static_cast<int>(size) - 1);
+    analyzeBlockUsage(blocks.back());
+    generateInOrder(blocks.back());
+}
 
-        // Create the basic block
-        blocks.emplace_back(currentIndex, blockEndIndex - 1);
-        currentIndex = blockEndIndex;
+std::string ObjectCodeGenerator::finish() {
+    if (module.quads.empty()) {
+        return "halt\n";
     }
+    return formatOutput();
+}
+
+void ObjectCodeGenerator::parseInput(std::string_view input) {
+    module = irUtil::readModule(input);
+}
+
+void ObjectCodeGenerator::prepareModule() {
+    if (!module.symbols.empty()) {
+        offset = module.symbols.back().offset;
+        offset +=
+            (module.symbols.back().type == irStruct::ValueType::Int) ? 4 : 8;
+    }
+
+    temporaryVariables.resize(module.temps.size(), -1);
+    labelFlags.resize(module.quads.size());
+}
+
+void ObjectCodeGenerator::analyzeBlocks() {
+    const auto found = irCfg::findBlocks(module.quads);
+    blocks.assign(found.begin(), found.end());
 }
 
 void ObjectCodeGenerator::analyzeVariableUsage() {
     // Initialize data structures with meaningful names
-    usageTable.resize(quadruples.size());
-    memoryUsage.resize(symbolTable.size(), {-1, 1});
-    temporaryUsage.resize(temporaryVarSize, {-1, 0});
+    usageTable.resize(module.quads.size());
+    memoryUsage.resize(module.symbols.size(), {-1, 1});
+    temporaryUsage.resize(module.temps.size(), {-1, 0});
 
     // Process each basic block
     for (const auto& block : blocks) {
-        // Analyze instructions in reverse order within each block
-        for (int quadIndex = block.second; quadIndex >= block.first;
-             --quadIndex) {
-            const auto& quad = quadruples[quadIndex];
+        analyzeBlockUsage(block);
+    }
+}
 
-            // Create array of arguments for uniform processing
-            const std::array<std::string_view, 3> quadArguments{
-                quad.argument1, quad.argument2, quad.destination};
+void ObjectCodeGenerator::analyzeBlockUsage(const std::pair<int, int>& block) {
+    const auto& quads = module.quads;
 
-            // Process each argument in reverse order
-            for (int argIndex = 2; argIndex >= 0; --argIndex) {
-                const auto& currentArg = quadArguments[argIndex];
+    // Analyze instructions in reverse order within the block
+    for (int quadIndex = block.second; quadIndex >= block.first; --quadIndex) {
+        // Create array of arguments for uniform processing
+        const int local = quadIndex - firstQuad;
+        const std::array<const irStruct::Operand*, 3> quadArguments{
+            &quads.arg1(local), &quads.arg2(local), &quads.result(local)};
 
-                if (currentArg.empty() || currentArg[0] != 'T') {
-                    continue;
-                }
+        // Process each argument in reverse order
+        for (int argIndex = 2; argIndex >= 0; --argIndex) {
+            const auto& currentArg = *quadArguments[argIndex];
 
-                const bool isDestination = (argIndex == 2);
-
-                if (currentArg[1] == 'B') {  // Symbol table variable
-                    const auto symbolIndex =
-                        std::stoi(std::string(currentArg.substr(2)));
-                    usageTable[quadIndex][argIndex] = memoryUsage[symbolIndex];
-                    memoryUsage[symbolIndex] = {isDestination ? -1 : quadIndex,
-                                                isDestination ? 0 : 1};
-                } else {  // Temporary variable
-                    const auto underscore_pos = currentArg.find('_');
-                    const auto tempIndex = std::stoi(
-                        std::string(currentArg.substr(1, underscore_pos - 1)));
-                    usageTable[quadIndex][argIndex] = temporaryUsage[tempIndex];
-                    temporaryUsage[tempIndex] = {isDestination ? -1 : quadIndex,
-                                                 isDestination ? 0 : 1};
-                }
+            if (!currentArg.isVariable()) {
+                continue;
+            }
+
+            const bool isDestination = (argIndex == 2);
+            auto& usage = (currentArg.kind == irStruct::OperandKind::Symbol)
+                              ? memoryUsage[currentArg.index]
+                              : temporaryUsage[currentArg.index];
+            usageTable[local][argIndex] = usage;
+            usage = {isDestination ? -1 : quadIndex, isDestination ? 0 : 1};
+        }
+    }
+
+    // Declared variables are live again at the end of the previous block
+    for (int quadIndex = block.first; quadIndex <= block.second; ++quadIndex) {
+        const int local = quadIndex - firstQuad;
+        for (const auto* operand :
+             {&quads.arg1(local), &quads.arg2(local), &quads.result(local)}) {
+            if (operand->kind == irStruct::OperandKind::Symbol) {
+                memoryUsage[operand->index] = {-1, 1};
             }
         }
     }
 }
 
 void ObjectCodeGenerator::generateCode() {
-    for (const auto& [blockStart, blockEnd] : blocks) {
-        // Clear register allocation state for new block
-        for (auto& pair : registerValues) {
-            pair.second.clear();
-        }
-        for (auto& pair : availableExpressions) {
-            pair.second.clear();
+    if (jobs > 1 && blocks.size() > 1) {
+        generateParallel();
+        return;
+    }
+    for (const auto& block : blocks) {
+        generateInOrder(block);
+    }
+}
+
+void ObjectCodeGenerator::generateInOrder(const std::pair<int, int>& block) {
+    blockCode.push_back(code.size());
+    generateBlock(blockState, block);
+    for (const int target : blockState.labels) {
+        markLabel(target);
+    }
+}
+
+void ObjectCodeGenerator::generateParallel() {
+    // The code of each block, generated with placeholder temporary slots
+    struct BlockOutput {
+        std::pmr::vector<objectStruct::Instruction> code{
+            std::pmr::new_delete_resource()};
+        std::vector<int> labels;
+        std::vector<int> temps;
+    };
+    std::vector<BlockOutput> outputs(blocks.size());
+
+    // Threads take the next block until none is left; the arena resource is
+    // not thread-safe, so their state is allocated from the heap
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        BlockState state(std::pmr::new_delete_resource());
+        state.deferTemps = true;
+        for (size_t i = next++; i < blocks.size(); i = next++) {
+            state.code = &outputs[i].code;
+            generateBlock(state, blocks[i]);
+            outputs[i].labels.assign(state.labels.begin(), state.labels.end());
+            outputs[i].temps.assign(state.deferredTemps.begin(),
+                                    state.deferredTemps.end());
         }
-        usePosition.clear();
+    };
+    std::vector<std::thread> threads;
+    for (unsigned k = 1; k < jobs; k++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
 
-        // Process each quadruple in the block
-        for (int i = blockStart; i <= blockEnd; i++) {
-            const auto& quad = quadruples[i];
+    // Append the blocks in order, assigning the slots as a sequential run
+    for (size_t i = 0; i < blocks.size(); i++) {
+        auto& output = outputs[i];
+        const bool placed =
+            std::any_of(output.temps.begin(), output.temps.end(),
+                        [this](int t) { return temporaryVariables[t] >= 0; });
+        if (placed) {
+            generateInOrder(blocks[i]);
+            continue;
+        }
 
-            if (quad.operation[0] != 'j' && quad.operation != "W" &&
-                quad.operation != "R" && quad.operation != "End") {
-                handleArithmeticOperation(quad, i);
-            } else if (quad.operation == "R" || quad.operation == "W") {
-                handleIOOperation(quad, i);
+        for (const int t : output.temps) {
+            assignTemporary(t);
+        }
+        blockCode.push_back(code.size());
+        for (auto instruction : output.code) {
+            for (auto* operand : {&instruction.dst, &instruction.src}) {
+                if (operand->kind ==
+                    objectStruct::MachineOperandKind::Temporary) {
+                    *operand = objectStruct::MachineOperand::memory(
+                        temporaryVariables[operand->value]);
+                }
             }
+            code.push_back(instruction);
+        }
+        for (const int target : output.labels) {
+            markLabel(target);
         }
-        saveActiveVariables(blockEnd);
-        handleJumpOperation(quadruples[blockEnd], blockEnd);
     }
 }
 
-void ObjectCodeGenerator::handleArithmeticOperation(
-    const parserStruct::QuadTuple& quad,
-    int index) {
+void ObjectCodeGenerator::generateBlock(BlockState& state,
+                                        const std::pair<int, int>& block) {
+    const auto [blockStart, blockEnd] = block;
+
+    // Clear register allocation state for new block
+    const size_t variableCount =
+        REGISTER_COUNT + module.symbols.size() + module.temps.size();
+    if (state.availableExpressions.size() < variableCount) {
+        state.availableExpressions.resize(variableCount);
+        state.usePosition.resize(variableCount);
+    }
+    for (const auto var : state.touchedVariables) {
+        state.availableExpressions[var] = 0;
+        state.usePosition[var] = 0;
+    }
+    state.touchedVariables.clear();
+    state.registerValues.fill(-1);
+    state.labels.clear();
+    for (const auto temp : state.deferredTemps) {
+        state.deferred[temp] = false;
+    }
+    state.deferredTemps.clear();
+    if (state.deferTemps && state.deferred.size() < module.temps.size()) {
+        state.deferred.resize(module.temps.size());
+    }
+
+    // Process each quadruple in the block
+    for (int i = blockStart; i <= blockEnd; i++) {
+        const auto quad = module.quads.at(i - firstQuad);
+
+        if (quad.op == irStruct::OpCode::Read ||
+            quad.op == irStruct::OpCode::Write) {
+            handleIOOperation(state, quad);
+        } else if (!irUtil::isJump(quad.op) &&
+                   quad.op != irStruct::OpCode::End) {
+            handleArithmeticOperation(state, quad, i);
+        }
+    }
+    saveActiveVariables(state);
+    handleJumpOperation(state, module.quads.at(blockEnd - firstQuad),
+                        blockEnd);
+}
+
+void ObjectCodeGenerator::handleArithmeticOperation(BlockState& state,
+                                                    const irStruct::Quad& quad,
+                                                    int index) {
+    const int argument1 = variableId(quad.arg1);
+    const int argument2 = variableId(quad.arg2);
+    const int destination = variableId(quad.result);
+
     // Update usage status of arguments and destination
-    updateUsePosition(quad.argument1, usageTable[index][0].usageStatus);
-    updateUsePosition(quad.argument2, usageTable[index][1].usageStatus);
-    updateUsePosition(quad.destination, usageTable[index][2].usageStatus);
+    const auto& usage = usageTable[index - firstQuad];
+    updateUsePosition(state, argument1, usage[0].usageStatus);
+    updateUsePosition(state, argument2, usage[1].usageStatus);
+    updateUsePosition(state, destination, usage[2].usageStatus);
 
     // Get target register to allocate
-    const std::string targetReg = allocateRegister(quad, index);
+    const int targetReg = allocateRegister(state, quad, index);
 
     // Find the registers for arguments
-    const std::string arg1 = findRegister(quad.argument1);
-    std::optional<std::string> arg2 =
-        (quad.argument2 != "-")
-            ? std::make_optional(findRegister(quad.argument2))
-            : std::nullopt;
-
-    // Lambda to determine the address of an operand if it's a temporary
-    // variable
-    auto getRegisterOrImmediate = [&](const std::string_view operand) {
-        return (operand[0] == 'T') ? getAddress(std::string(operand))
-                                   : std::string(operand);
-    };
+    const int arg1 = findRegister(state, argument1);
+    std::optional<int> arg2 = (!quad.arg2.isNone())
+                                  ? std::make_optional(
+                                        findRegister(state, argument2))
+                                  : std::nullopt;
+    const auto target = getLocation(state, quad.result, targetReg);
 
     // If source register is the same as target register, handle accordingly
     if (arg1 == targetReg) {
         if (arg2) {
             // If the second argument exists, handle the operation
-            const std::string operand2 = getRegisterOrImmediate(*arg2);
-            transferOperation(quad.operation, targetReg, operand2, index);
+            transferOperation(state, quad.op, target,
+                              getLocation(state, quad.arg2, *arg2));
         }
 
         // Special handling for NOT operation
-        if (quad.operation == "!") {
-            resultCode[index].emplace_back("not " + arg1);
+        if (quad.op == irStruct::OpCode::Not) {
+            emit(state, objectStruct::MachineOp::Not, target);
         }
 
-        availableExpressions[quad.argument1].erase(targetReg);
+        locations(state, argument1) &= ~registerBit(targetReg);
     } else {
         // Move the value of arg1 to target register
-        const std::string operand1 = getRegisterOrImmediate(arg1);
-        resultCode[index].emplace_back("mov " + targetReg + ", " + operand1);
+        emit(state, objectStruct::MachineOp::Mov, target,
+             getLocation(state, quad.arg1, arg1));
 
         // Handle second argument if present
         if (arg2) {
-            const std::string operand2 = getRegisterOrImmediate(*arg2);
-            transferOperation(quad.operation, targetReg, operand2, index);
+            transferOperation(state, quad.op, target,
+                              getLocation(state, quad.arg2, *arg2));
         }
     }
 
     // Update the state of the register allocation
     if (arg2 && *arg2 == targetReg) {
-        availableExpressions[quad.argument2].erase(targetReg);
-    }
-
-    registerValues[targetReg].clear();
-    registerValues[targetReg].insert(quad.destination);
-    availableExpressions[quad.destination].clear();
-    availableExpressions[quad.destination].insert(targetReg);
-
-    updateUsePosition(quad.destination, usageTable[index][2].usageStatus, 1);
-
-    // Clean up temporary variables if needed
-    auto cleanupTempVariables = [this](const std::string& var) {
-        if (var[1] != 'B') {  // Only process temporary variables
-            auto& availableRegs = availableExpressions[var];
-            for (auto it = availableRegs.begin(); it != availableRegs.end();
-                 /* no increment here */) {
-                if (it->front() == 'R') {  // If it is a register
-                    registerValues[it->data()].erase(var);
-                    it = availableRegs.erase(it);  // Remove and update iterator
-                } else {
-                    ++it;  // Otherwise move to next
+        locations(state, argument2) &= ~registerBit(targetReg);
+    }
+
+    // A register still holding the old value of the destination is free
+    if (destination >= 0) {
+        for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+            if (state.registerValues[reg] == destination) {
+                state.registerValues[reg] = -1;
+            }
+        }
+        locations(state, destination) = registerBit(targetReg);
+    }
+    state.registerValues[targetReg] = destination;
+
+    updateUsePosition(state, destination, usage[2].usageStatus);
+
+    // Clean up temporary variables that are not read again in the block
+    auto cleanupTempVariables = [this, &state](
+                                    const irStruct::Operand& operand,
+                                    const objectStruct::UsageInfo& info) {
+        if (operand.kind == irStruct::OperandKind::Temp &&
+            info.usageStatus < 0) {
+            const int var = variableId(operand);
+            auto& mask = locations(state, var);
+            for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+                if (mask & registerBit(reg)) {
+                    if (state.registerValues[reg] == var) {
+                        state.registerValues[reg] = -1;
+                    }
+                    mask &= ~registerBit(reg);
                 }
             }
         }
     };
 
-    cleanupTempVariables(quad.argument1);
-    std::string argument2_value = quad.argument2.empty() ? "" : quad.argument2;
-    cleanupTempVariables(argument2_value);
+    cleanupTempVariables(quad.arg1, usage[0]);
+    cleanupTempVariables(quad.arg2, usage[1]);
 }
 
-void ObjectCodeGenerator::handleJumpOperation(
-    const parserStruct::QuadTuple& quad,
-    int index) {
-    if (quad.operation == "j") {
-        resultCode[index].push_back("jmp ?" + quad.destination);
-        if (!labelFlags[std::stoi(quad.destination)]) {
-            labelFlags[std::stoi(quad.destination)] = true;
-        }
-    } else if (quad.operation == "jnz") {
-        std::string reg = quad.argument1;
-        reg = findRegister(reg);
-
-        if (reg == quad.argument1) {
-            reg = allocateRegister(quad, index);
-            resultCode[index].push_back("mov " + reg + ", " +
-                                        getAddress(quad.argument1));
-        }
-
-        resultCode[index].push_back("cmp " + reg + ", 0");
-        resultCode[index].push_back("jne ?" + quad.destination);
-
-        if (!labelFlags[std::stoi(quad.destination)]) {
-            labelFlags[std::stoi(quad.destination)] = true;
-        }
-    } else if (quad.operation == "End") {
-        resultCode[index].push_back("halt");
-    } else if (OpKeyMap::jumpAssembler.find(quad.operation) != OpKeyMap::jumpAssembler.end()){  // Other conditional jumps
-        std::string arg1 = findRegister(quad.argument1);
-        std::string arg2 = findRegister(quad.argument2);
-
-        if (arg1 == quad.argument1) {
-            arg1 = allocateRegister(quad, index);
-            resultCode[index].push_back("mov " + arg1 + ", " +
-                                        getAddress(quad.argument1));
+void ObjectCodeGenerator::handleJumpOperation(BlockState& state,
+                                              const irStruct::Quad& quad,
+                                              int index) {
+    using objectStruct::MachineOp;
+    const int target = quad.result.index;
+    const auto label = objectStruct::MachineOperand::label(target);
+
+    if (quad.op == irStruct::OpCode::Jump) {
+        emit(state, MachineOp::Jmp, label);
+        state.labels.push_back(target);
+    } else if (quad.op == irStruct::OpCode::JumpNz) {
+        int reg = findRegister(state, variableId(quad.arg1));
+        objectStruct::MachineOperand operand;
+
+        if (reg < 0) {
+            reg = allocateRegister(state, quad, index);
+            operand = getLocation(state, quad.arg1, reg);
+            emit(state, MachineOp::Mov, operand,
+                 getLocation(state, quad.arg1, -1));
+        } else {
+            operand = getLocation(state, quad.arg1, reg);
         }
 
-        if (arg2[0] == 'T') {
-            resultCode[index].push_back("cmp " + arg1 + ", " +
-                                        getAddress(arg2));
+        emit(state, MachineOp::Cmp, operand,
+             objectStruct::MachineOperand::immediate(std::int64_t{0}));
+        emit(state, MachineOp::Jne, label);
+        state.labels.push_back(target);
+    } else if (quad.op == irStruct::OpCode::End) {
+        emit(state, MachineOp::Halt);
+    } else if (irUtil::isConditionalJump(quad.op)) {  // Other conditional jumps
+        int arg1 = findRegister(state, variableId(quad.arg1));
+        const int arg2 = findRegister(state, variableId(quad.arg2));
+        objectStruct::MachineOperand operand1;
+
+        if (arg1 < 0) {
+            arg1 = allocateRegister(state, quad, index);
+            operand1 = getLocation(state, quad.arg1, arg1);
+            emit(state, MachineOp::Mov, operand1,
+                 getLocation(state, quad.arg1, -1));
         } else {
-            resultCode[index].push_back("cmp " + arg1 + ", " + arg2);
+            operand1 = getLocation(state, quad.arg1, arg1);
         }
-        resultCode[index].push_back(OpKeyMap::jumpAssembler.at(quad.operation) +
-                                    " ?" + quad.destination);
 
-        if (!labelFlags[std::stoi(quad.destination)]) {
-            labelFlags[std::stoi(quad.destination)] = true;
-        }
+        emit(state, MachineOp::Cmp, operand1,
+             getLocation(state, quad.arg2, arg2));
+        emit(state, *mnemonics().jump[static_cast<std::size_t>(quad.op)],
+             label);
+        state.labels.push_back(target);
     }
 }
 
-void ObjectCodeGenerator::handleIOOperation(const parserStruct::QuadTuple& quad,
-                                            int index) {
-    if (quad.operation == "R") {
-        resultCode[index].push_back("jmp ?read(" +
-                                    getAddress(quad.destination) + ")");
-    } else {  // quad.operation == "W"
-        resultCode[index].push_back("jmp ?write(" +
-                                    getAddress(quad.destination) + ")");
+void ObjectCodeGenerator::handleIOOperation(BlockState& state,
+                                            const irStruct::Quad& quad) {
+    emit(state,
+         quad.op == irStruct::OpCode::Read ? objectStruct::MachineOp::Read
+                                           : objectStruct::MachineOp::Write,
+         getLocation(state, quad.result, -1));
+}
+
+int ObjectCodeGenerator::variableId(const irStruct::Operand& operand) const {
+    if (operand.kind == irStruct::OperandKind::Symbol) {
+        return REGISTER_COUNT + operand.index;
+    }
+    if (operand.kind == irStruct::OperandKind::Temp) {
+        return REGISTER_COUNT + static_cast<int>(module.symbols.size()) +
+               operand.index;
     }
+    return -1;
 }
 
-std::string ObjectCodeGenerator::getAddress(const std::string& variable) {
-    std::string result = "[ebp-";
+int ObjectCodeGenerator::assignTemporary(int temp) {
+    const int slot = offset;
+    offset += (module.temps[temp] == irStruct::ValueType::Int) ? 4 : 8;
+    temporaryVariables[temp] = slot;
+    return slot;
+}
+
+objectStruct::MachineOperand ObjectCodeGenerator::getAddress(BlockState& state,
+                                                             int variable) {
     int varOffset = 0;
+    const int idx = variable - REGISTER_COUNT;
+    const int symbolCount = static_cast<int>(module.symbols.size());
 
-    if (variable[0] == 'T' && variable[1] == 'B') {
-        int idx = std::stoi(variable.substr(2));
-        varOffset = symbolTable[idx].offset;
+    if (idx < symbolCount) {
+        varOffset = module.symbols[idx].offset;
     } else {
-        size_t pos = variable.find('_');
-        int idx = std::stoi(variable.substr(1, pos - 1));
-
-        if (temporaryVariables[idx] != 0) {
-            varOffset = temporaryVariables[idx];
-        } else {
-            if (variable[variable.size() - 1] == 'i') {
-                offset += 4;
-                varOffset = offset - 4;
-            } else {
-                offset += 8;
-                varOffset = offset - 8;
+        const int tempIdx = idx - symbolCount;
+
+        if (temporaryVariables[tempIdx] >= 0) {
+            varOffset = temporaryVariables[tempIdx];
+        } else if (state.deferTemps) {
+            // The slot is assigned when the blocks are put in order
+            if (!state.deferred[tempIdx]) {
+                state.deferred[tempIdx] = true;
+                state.deferredTemps.push_back(tempIdx);
+                locations(state, variable) |= IN_MEMORY;
             }
-            availableExpressions[variable].insert(variable);
-            temporaryVariables[idx] = varOffset;
+            return objectStruct::MachineOperand::temporary(tempIdx);
+        } else {
+            varOffset = assignTemporary(tempIdx);
+            locations(state, variable) |= IN_MEMORY;
         }
     }
 
-    return result + std::to_string(varOffset) + "]";
+    return objectStruct::MachineOperand::memory(varOffset);
+}
+
+objectStruct::MachineOperand ObjectCodeGenerator::getLocation(
+    BlockState& state,
+    const irStruct::Operand& operand,
+    int reg) {
+    if (reg >= 0) {
+        return objectStruct::MachineOperand::reg(reg);
+    }
+    if (operand.isVariable()) {
+        return getAddress(state, variableId(operand));
+    }
+    switch (operand.kind) {
+        case irStruct::OperandKind::ImmInt:
+            return objectStruct::MachineOperand::immediate(operand.intValue);
+        case irStruct::OperandKind::ImmDouble:
+            return objectStruct::MachineOperand::immediate(
+                operand.doubleValue);
+        case irStruct::OperandKind::Target:
+            return objectStruct::MachineOperand::immediate(
+                std::int64_t{operand.index});
+        case irStruct::OperandKind::ImmText:
+            return objectStruct::MachineOperand::text(operand.index);
+        default:
+            return objectStruct::MachineOperand();
+    }
+}
+
+void ObjectCodeGenerator::emit(BlockState& state,
+                               objectStruct::MachineOp op,
+                               const objectStruct::MachineOperand& dst,
+                               const objectStruct::MachineOperand& src) {
+    state.code->push_back({op, dst, src});
 }
 
 std::string ObjectCodeGenerator::formatOutput() const {
-    std::ostringstream oss;
+    // Most lines are short, e.g. "mov [ebp-12], R1"
+    std::string out;
+    out.reserve(code.size() * 20 + blocks.size() * 8);
 
     for (size_t i = 0; i < blocks.size(); ++i) {
-        const auto& [start, end] = blocks[i];
+        const int start = blocks[i].first;
 
         if (labelFlags[start]) {
-            oss << "?" << start << ":\n";
+            out += '?';
+            appendNumber(out, start);
+            out += ":\n";
         }
 
-        for (int j = start; j <= end; ++j) {
-            for (const auto& instruction : resultCode[j]) {
-                oss << instruction << "\n";
-            }
+        const size_t end =
+            i + 1 < blockCode.size() ? blockCode[i + 1] : code.size();
+        for (size_t j = blockCode[i]; j < end; ++j) {
+            appendInstruction(out, code[j]);
         }
     }
 
-    return oss.str();
+    return out;
 }
 
-void ObjectCodeGenerator::updateUsePosition(const std::string& variable,
-                                            int status,
-                                            int mask) {
-    if (variable[0] == 'T' || mask) {
-        usePosition[variable] = (status == -1) ? SHRT_MAX : status;
+void ObjectCodeGenerator::markLabel(int target) {
+    if (static_cast<size_t>(target) >= labelFlags.size()) {
+        labelFlags.resize(target + 1);
     }
+    labelFlags[target] = true;
 }
 
-void ObjectCodeGenerator::saveActiveVariables(int blockEnd) {
-    for (size_t i = 0; i < symbolTable.size(); i++) {
-        std::string var = "TB" + std::to_string(i);
-        if (!availableExpressions[var].empty() &&
-            availableExpressions[var].count(var) == 0) {
-            for (const auto& reg : availableExpressions[var]) {
-                if (reg[0] == 'R') {
-                    resultCode[blockEnd].push_back(
-                        "mov [ebp-" + std::to_string(symbolTable[i].offset) +
-                        "], " + reg);
-                    break;
-                }
-            }
-        }
+void ObjectCodeGenerator::updateUsePosition(BlockState& state,
+                                            int variable,
+                                            int status) {
+    if (variable >= 0) {
+        state.usePosition[variable] = (status == -1) ? SHRT_MAX : status;
+        state.touchedVariables.push_back(variable);
     }
 }
 
-void ObjectCodeGenerator::transferOperation(const std::string& operation,
-                                            const std::string& x,
-                                            const std::string& y,
-                                            int index) {
-    auto it = OpKeyMap::optAssembler.find(operation);
-    if (it != OpKeyMap::optAssembler.end()) {
-        resultCode[index].push_back(it->second + x + ", " + y);
+void ObjectCodeGenerator::saveActiveVariables(BlockState& state) {
+    for (size_t i = 0; i < module.symbols.size(); i++) {
+        const int var = REGISTER_COUNT + static_cast<int>(i);
+        const int reg = findRegister(state, var);
+        if (reg >= 0 && !(state.availableExpressions[var] & IN_MEMORY)) {
+            emit(state, objectStruct::MachineOp::Mov,
+                 objectStruct::MachineOperand::memory(module.symbols[i].offset),
+                 objectStruct::MachineOperand::reg(reg));
+        }
+    }
+}
 
-        it = OpKeyMap::setAssembler.find(operation);
-        if (it != OpKeyMap::setAssembler.end()) {
-            resultCode[index].push_back(OpKeyMap::setAssembler.at(operation) +
-                                        x);
+void ObjectCodeGenerator::transferOperation(
+    BlockState& state,
+    irStruct::OpCode operation,
+    const objectStruct::MachineOperand& x,
+    const objectStruct::MachineOperand& y) {
+    const auto& table = mnemonics();
+    const auto op = static_cast<std::size_t>(operation);
+    if (table.operation[op]) {
+        emit(state, *table.operation[op], x, y);
+
+        if (table.set[op]) {
+            emit(state, *table.set[op], x);
         }
     }
 }
 
-std::string ObjectCodeGenerator::findRegister(const std::string& variable) {
-    for (const auto& s : availableExpressions[variable]) {
-        if (s[0] == 'R') {
-            return s;
+int ObjectCodeGenerator::findRegister(BlockState& state, int variable) {
+    if (variable < 0) {
+        return -1;
+    }
+    for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+        if (state.availableExpressions[variable] & registerBit(reg)) {
+            return reg;
         }
     }
-    return variable;
+    return -1;
+}
+
+std::uint8_t& ObjectCodeGenerator::locations(BlockState& state, int variable) {
+    state.touchedVariables.push_back(variable);
+    return state.availableExpressions[variable];
 }
 
-std::string ObjectCodeGenerator::allocateRegister(
-    const parserStruct::QuadTuple& quad,
-    int quadIndex) {
+int ObjectCodeGenerator::allocateRegister(BlockState& state,
+                                          const irStruct::Quad& quad,
+                                          int quadIndex) {
+    const int argument1 = variableId(quad.arg1);
+    const int destination = variableId(quad.result);
+
     // Check for non-arithmetic operations
-    if (quad.operation[0] != 'j' && quad.operation != "W" &&
-        quad.operation != "R" && quad.operation != "End") {
+    if (!irUtil::isJump(quad.op) && quad.op != irStruct::OpCode::Write &&
+        quad.op != irStruct::OpCode::Read && quad.op != irStruct::OpCode::End &&
+        argument1 >= 0) {
         // Try to reuse register containing argument1
-        for (const auto& reg : availableExpressions[quad.argument1]) {
-            const auto& regValues = registerValues[reg];
-            bool isSingleRef =
-                (regValues.size() == 1 && *regValues.begin() == quad.argument1);
-            bool isNotLiving = (quad.argument1 == quad.destination ||
-                                usageTable[quadIndex][0].lifetime == 0);
+        for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+            if (!(state.availableExpressions[argument1] & registerBit(reg))) {
+                continue;
+            }
+            bool isSingleRef = state.registerValues[reg] == argument1;
+            bool isNotLiving =
+                (argument1 == destination ||
+                 usageTable[quadIndex - firstQuad][0].lifetime == 0);
 
             if (isSingleRef && isNotLiving) {
                 return reg;
@@ -440,66 +840,46 @@ std::string ObjectCodeGenerator::allocateRegister(
     }
 
     // Try to find empty register
-    std::string emptyReg = "R0";
-    if (registerValues[emptyReg].empty())
-        return emptyReg;
-    emptyReg = "R1";
-    if (registerValues[emptyReg].empty())
-        return emptyReg;
-    emptyReg = "R2";
-    if (registerValues[emptyReg].empty())
-        return emptyReg;
+    for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+        if (state.registerValues[reg] < 0)
+            return reg;
+    }
 
     // No empty register found, need to select one to spill
-    std::vector<std::string> registers{"R0", "R1", "R2"};
-
-    // First try: find register with all variables in memory
-    auto isInMemory = [this](const std::string& var) -> bool {
-        return availableExpressions[var].count(var) > 0;
-    };
 
-    std::string selectedReg;
-    for (const auto& reg : registers) {
-        bool allInMemory = std::all_of(registerValues[reg].begin(),
-                                       registerValues[reg].end(), isInMemory);
-
-        if (allInMemory) {
+    // First try: find register whose variable is in memory
+    int selectedReg = -1;
+    for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+        if (state.availableExpressions[state.registerValues[reg]] & IN_MEMORY) {
             selectedReg = reg;
             break;
         }
     }
 
-    // Second try: find register with variables used farthest in future
-    if (selectedReg.empty()) {
+    // Second try: find register with the variable used farthest in future
+    if (selectedReg < 0) {
         int maxUseDistance = -1;
-        for (const auto& reg : registers) {
-            int minUseDistance = std::numeric_limits<int>::max();
-            for (const auto& var : registerValues[reg]) {
-                minUseDistance = std::min(minUseDistance, usePosition[var]);
-            }
-            if (minUseDistance > maxUseDistance) {
+        for (int reg = 0; reg < REGISTER_COUNT; reg++) {
+            if (state.usePosition[state.registerValues[reg]] > maxUseDistance) {
                 selectedReg = reg;
-                maxUseDistance = minUseDistance;
+                maxUseDistance = state.usePosition[state.registerValues[reg]];
             }
         }
     }
 
-    // Save current register contents to memory if needed
-    for (auto var : registerValues[selectedReg]) {
-        if (!availableExpressions[var].count(var) && var != quad.destination) {
-            resultCode[quadIndex].push_back("mov " + getAddress(var) + ", " +
-                                            selectedReg);
-        }
-
-        if (var == quad.argument1 ||
-            (var == quad.argument2 &&
-             registerValues[selectedReg].count(quad.argument1))) {
-            availableExpressions[var] = {var, selectedReg};
-        } else {
-            availableExpressions[var] = {var};
+    // Save current register contents to memory if needed; a register the
+    // variable has left holds nothing worth saving
+    const int var = state.registerValues[selectedReg];
+    if (state.availableExpressions[var] & registerBit(selectedReg)) {
+        if (!(state.availableExpressions[var] & IN_MEMORY) &&
+            var != destination) {
+            emit(state, objectStruct::MachineOp::Mov, getAddress(state, var),
+                 objectStruct::MachineOperand::reg(selectedReg));
         }
+        locations(state, var) =
+            IN_MEMORY | (var == argument1 ? registerBit(selectedReg) : 0);
     }
 
-    registerValues[selectedReg].clear();
+    state.registerValues[selectedReg] = -1;
     return selectedReg;
-}
\ No newline at end of file
+}
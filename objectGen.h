@@ -6,12 +6,14 @@
 #include <cstring>
 #include <utility>
 #include <limits>
+#include <memory_resource>
 #include <vector>
-#include <set>
+#include <array>
+#include <cstdint>
 #include <sstream>
+#include <string_view>
+#include "irStruct.h"
 #include "objectStruct.h"
-#include "parserStruct.h"
-#include "parserUtil.h"
 #include "opkeymap.h"
 
 /**
@@ -27,62 +29,162 @@
 class ObjectCodeGenerator {
 public:
     /**
-     * @brief Default constructor.
+     * @brief Constructs a generator.
+     *
+     * @param resource Allocates the register state and the generated lines,
+     * e.g. a per-compilation arena; it must outlive the generator.
      */
-    ObjectCodeGenerator() = default;
+    explicit ObjectCodeGenerator(std::pmr::memory_resource* resource =
+                                     std::pmr::get_default_resource());
 
     /**
      * @brief Generates object code from the provided intermediate
      * representation.
      *
-     * @param input The intermediate representation as a string.
+     * @param input The textual quadruple listing, e.g. a string or a mapped
+     * file; it is read in place.
+     * @return A formatted string containing the generated object code.
+     */
+    std::string generate(std::string_view input);
+
+    /**
+     * @brief Generates object code from an in-memory module, as handed over
+     * by the parser.
+     *
+     * @param input The module to translate.
+     * @return A formatted string containing the generated object code.
+     */
+    std::string generate(irStruct::Module input);
+
+    /**
+     * @brief Generates object code from a quadruple listing one basic block
+     * at a time, writing the code of each block as soon as it is generated.
+     * A first scan over the listing finds the blocks and the labels, keeping
+     * a few bits per quadruple; after that only the quadruples, usage
+     * information and code of the current block are held. The output is the
+     * same as that of generate().
+     *
+     * @param input The textual quadruple listing; it is read in place.
+     * @param out Receives the object code.
+     */
+    void generateStreaming(std::string_view input, std::ostream& out);
+
+    /**
+     * @brief Starts incremental generation, where the quadruples arrive one
+     * basic block at a time.
+     *
+     * @param symbols The complete symbol table of the program.
+     */
+    void begin(std::vector<irStruct::SymbolEntry> symbols);
+
+    /**
+     * @brief Appends quadruples and generates code for the basic block at
+     * their end. Blocks must arrive in program order and every jump in them
+     * must already have its final target.
+     *
+     * @param quads The quadruples following the ones added so far; those
+     * before start are unreachable and get no code.
+     * @param start The index of the first quadruple of the block.
+     */
+    void addBlock(const std::vector<irStruct::Quad>& quads, int start);
+
+    /**
+     * @brief Ends incremental generation.
+     *
      * @return A formatted string containing the generated object code.
      */
-    std::string generate(const std::string& input);
+    std::string finish();
+
+    /**
+     * @brief Sets the number of threads generate() spreads the basic blocks
+     * over, including the calling one. The output does not depend on it.
+     *
+     * @param count The number of threads; 1 (the default) generates the
+     * blocks one after the other.
+     */
+    void setJobs(unsigned count);
 
 private:
     // Data members
 
-    /// Symbol table containing memory nodes representing variables and their
-    /// attributes.
-    std::vector<objectStruct::MemoryNode> symbolTable;
+    /// Number of general purpose registers (R0, R1, R2). Registers and
+    /// variables share one id space: ids below REGISTER_COUNT are registers,
+    /// the symbols follow, then the temporaries.
+    static constexpr int REGISTER_COUNT = 3;
 
-    /// Set of all variable names encountered during code generation.
-    std::set<std::string> variableSet;
-
-    /// Vector of quadruples representing the intermediate representation.
-    std::vector<parserStruct::QuadTuple> quadruples;
+    /// The intermediate representation: symbol table, temporaries and
+    /// quadruples.
+    irStruct::Module module;
 
     /// Basic blocks represented as pairs of start and end indices.
-    std::vector<std::pair<int, int>> blocks;
+    std::pmr::vector<std::pair<int, int>> blocks;
+
+    /// Bit of an address descriptor telling that the value is in memory; the
+    /// bits below it are the registers holding the value.
+    static constexpr std::uint8_t IN_MEMORY = 1 << REGISTER_COUNT;
+
+    /**
+     * @struct BlockState
+     * @brief Register allocation state of the block being generated, and
+     * where its code goes. Every code generation thread has its own.
+     */
+    struct BlockState {
+        explicit BlockState(std::pmr::memory_resource* resource);
 
-    /// Tracks the last usage position of variables for optimization purposes.
-    std::unordered_map<std::string, int> usePosition;
+        /// Tracks the next use of each variable in the block, by id.
+        std::pmr::vector<int> usePosition;
 
-    /// Maps available expressions to their respective sets of variables for
-    /// reuse.
-    std::unordered_map<std::string, std::set<std::string>> availableExpressions;
+        /// Address descriptor of each variable, by id: a mask of the
+        /// registers holding its value, plus IN_MEMORY.
+        std::pmr::vector<std::uint8_t> availableExpressions;
 
-    /// Maps registers to their currently held variable values.
-    std::unordered_map<std::string, std::set<std::string>> registerValues;
+        /// Register descriptors: the variable each register holds, or -1.
+        std::array<int, REGISTER_COUNT> registerValues;
 
-    /// Vector to store the generated object code, organized by lines.
-    std::vector<std::vector<std::string>> resultCode;
+        /// Variables whose descriptors were changed in the block.
+        std::pmr::vector<int> touchedVariables;
+
+        /// Receives the instructions of the block.
+        std::pmr::vector<objectStruct::Instruction>* code = nullptr;
+
+        /// Jump targets of the block, to be marked as labels.
+        std::pmr::vector<int> labels;
+
+        /// Whether temporaries without a frame slot get a placeholder
+        /// operand instead of being assigned one.
+        bool deferTemps = false;
+
+        /// Temporaries given a placeholder, in the order of their first use.
+        std::pmr::vector<int> deferredTemps;
+
+        /// Flags of the temporaries in deferredTemps, by index.
+        std::pmr::vector<bool> deferred;
+    };
+
+    /// State of the blocks generated on the calling thread.
+    BlockState blockState;
+
+    /// The generated object code of all blocks, in program order.
+    std::pmr::vector<objectStruct::Instruction> code;
+
+    /// Index in code of the first instruction of each block.
+    std::pmr::vector<std::size_t> blockCode;
 
     /// Flags indicating whether a label exists at a given quadruple index.
     std::vector<bool> labelFlags;
 
-    /// Temporary variables used during code generation.
+    /// Frame offsets of the temporary variables (-1 while unassigned).
     std::vector<int> temporaryVariables;
 
     /// Offset for memory allocation during symbol table processing.
     int offset = 0;
 
-    /// Total number of quadruples in the intermediate representation.
-    int numberOfQuadruples = 0;
+    /// Index of the quadruple held first in module.quads and usageTable:
+    /// 0, except when streaming, where they only hold the current block.
+    int firstQuad = 0;
 
-    /// Size of the temporary variable pool.
-    int temporaryVarSize = 0;
+    /// Number of code generation threads.
+    unsigned jobs = 1;
 
     // Utility functions
 
@@ -90,10 +192,15 @@ private:
      * @brief Parses the input string into intermediate structures such as
      * quadruples.
      *
-     * @param iss Input string stream containing the intermediate
-     * representation.
+     * @param input The textual quadruple listing.
+     */
+    void parseInput(std::string_view input);
+
+    /**
+     * @brief Sets up the frame offset and the per-quadruple tables for the
+     * current module.
      */
-    void parseInput(std::istringstream& iss);
+    void prepareModule();
 
     /**
      * @brief Analyzes basic blocks within the intermediate representation.
@@ -107,7 +214,62 @@ private:
     void generateCode();
 
     /**
-     * @brief Formats the generated object code into a final string output.
+     * @brief Generates one basic block on the calling thread and appends its
+     * code.
+     *
+     * @param block The first and last quadruple of the block.
+     */
+    void generateInOrder(const std::pair<int, int>& block);
+
+    /**
+     * @brief Generates the basic blocks on several threads, each with its own
+     * BlockState. Temporaries first used in a block get placeholder slots;
+     * the blocks are then appended in order, and the placeholders replaced
+     * by the slots a sequential run would assign. A block using a
+     * temporary that an earlier block already placed in memory is generated
+     * again on the calling thread, since its register state depends on it.
+     */
+    void generateParallel();
+
+    /**
+     * @brief Gives a temporary the next frame slot.
+     *
+     * @param temp The temporary's index.
+     * @return The frame offset of the slot.
+     */
+    int assignTemporary(int temp);
+
+    /**
+     * @brief Generates object code for one basic block.
+     *
+     * @param state The state of the block being generated.
+     * @param block The first and last quadruple of the block.
+     */
+    void generateBlock(BlockState& state, const std::pair<int, int>& block);
+
+    /**
+     * @brief Records that a label is needed in front of a quadruple.
+     *
+     * @param target The index of the jump target.
+     */
+    void markLabel(int target);
+
+    /**
+     * @brief Appends an instruction to the generated code.
+     *
+     * @param state The state of the block being generated.
+     * @param op The operation.
+     * @param dst The first operand, or the jump target.
+     * @param src The second operand.
+     */
+    void emit(BlockState& state,
+              objectStruct::MachineOp op,
+              const objectStruct::MachineOperand& dst = {},
+              const objectStruct::MachineOperand& src = {});
+
+    /**
+     * @brief Prints the generated instructions and labels into one string,
+     * reserved up front.
      *
      * @return The formatted object code as a string.
      */
@@ -115,72 +277,111 @@ private:
 
     // Register allocation and variable handling
 
+    /**
+     * @brief Maps a variable operand onto its id.
+     *
+     * @param operand The operand.
+     * @return The variable id, or -1 if the operand is not a variable.
+     */
+    int variableId(const irStruct::Operand& operand) const;
+
     /**
      * @brief Retrieves the memory address of a given variable.
      *
-     * @param variable The variable name.
-     * @return A string representation of the variable's memory address.
+     * @param state The state of the block being generated.
+     * @param variable The variable id.
+     * @return The variable's frame slot.
      */
-    std::string getAddress(const std::string& variable);
+    objectStruct::MachineOperand getAddress(BlockState& state, int variable);
+
+    /**
+     * @brief Maps an operand onto an instruction operand: the register
+     * holding it, its memory address, or the literal itself.
+     *
+     * @param state The state of the block being generated.
+     * @param operand The operand.
+     * @param reg The register holding the operand, or -1.
+     * @return The instruction operand.
+     */
+    objectStruct::MachineOperand getLocation(BlockState& state,
+                                             const irStruct::Operand& operand,
+                                             int reg);
 
     /**
      * @brief Allocates a register for a specific quadruple operation.
      *
+     * @param state The state of the block being generated.
      * @param quad The quadruple requiring a register.
      * @param quadIndex The index of the quadruple in the list.
-     * @return The name of the allocated register.
+     * @return The allocated register.
+     */
+    int allocateRegister(BlockState& state,
+                         const irStruct::Quad& quad,
+                         int quadIndex);
+
+    /**
+     * @brief Returns the address descriptor of a variable and records it for
+     * the reset at the end of the block.
+     *
+     * @param state The state of the block being generated.
+     * @param variable The variable id.
+     * @return The descriptor.
      */
-    std::string allocateRegister(const parserStruct::QuadTuple& quad,
-                                 int quadIndex);
+    std::uint8_t& locations(BlockState& state, int variable);
 
     /**
      * @brief Finds the register currently holding a specific variable's value.
      *
-     * @param variable The variable name.
-     * @return The name of the register holding the variable, or an empty string
-     * if none.
+     * @param state The state of the block being generated.
+     * @param variable The variable id.
+     * @return The register holding the variable, or -1 if none.
      */
-    std::string findRegister(const std::string& variable);
+    int findRegister(BlockState& state, int variable);
 
     // Code generation helpers
 
     /**
      * @brief Handles the generation of object code for arithmetic operations.
      *
+     * @param state The state of the block being generated.
      * @param quad The quadruple representing the arithmetic operation.
      * @param index The index of the quadruple in the list.
      */
-    void handleArithmeticOperation(const parserStruct::QuadTuple& quad,
+    void handleArithmeticOperation(BlockState& state,
+                                   const irStruct::Quad& quad,
                                    int index);
 
     /**
      * @brief Handles the generation of object code for jump operations.
      *
+     * @param state The state of the block being generated.
      * @param quad The quadruple representing the jump operation.
      * @param index The index of the quadruple in the list.
      */
-    void handleJumpOperation(const parserStruct::QuadTuple& quad, int index);
+    void handleJumpOperation(BlockState& state,
+                             const irStruct::Quad& quad,
+                             int index);
 
     /**
      * @brief Handles the generation of object code for input/output operations.
      *
+     * @param state The state of the block being generated.
      * @param quad The quadruple representing the I/O operation.
-     * @param index The index of the quadruple in the list.
      */
-    void handleIOOperation(const parserStruct::QuadTuple& quad, int index);
+    void handleIOOperation(BlockState& state, const irStruct::Quad& quad);
 
     /**
      * @brief Transfers an operation to object code with the given operands.
      *
+     * @param state The state of the block being generated.
      * @param operation The operation type (e.g., ADD, SUB).
      * @param x The first operand.
      * @param y The second operand.
-     * @param index The index of the operation in the quadruples list.
      */
-    void transferOperation(const std::string& operation,
-                           const std::string& x,
-                           const std::string& y,
-                           int index);
+    void transferOperation(BlockState& state,
+                           irStruct::OpCode operation,
+                           const objectStruct::MachineOperand& x,
+                           const objectStruct::MachineOperand& y);
 
     // Usage analysis
 
@@ -189,28 +390,37 @@ private:
      */
     void analyzeVariableUsage();
 
+    /**
+     * @brief Records the next use of every variable operand of one basic
+     * block, continuing from the state left by the previous block.
+     *
+     * @param block The first and last quadruple of the block.
+     */
+    void analyzeBlockUsage(const std::pair<int, int>& block);
+
     /**
      * @brief Updates the usage position of a variable in the usePosition map.
      *
-     * @param variable The variable name.
+     * @param state The state of the block being generated.
+     * @param variable The variable id, or -1 for non-variable operands.
      * @param status The new usage position of the variable.
      */
-    void updateUsePosition(const std::string& variable, int status, int mask=0);
+    void updateUsePosition(BlockState& state, int variable, int status);
 
     // Memory management
 
     /**
      * @brief Saves active variables to memory at the end of a block.
      *
-     * @param blockEnd The index marking the end of the block.
+     * @param state The state of the block being generated.
      */
-    void saveActiveVariables(int blockEnd);
+    void saveActiveVariables(BlockState& state);
 
     // Variable tracking
 
     /// Tracks variable usage information for registers, memory, and
     /// temporaries.
-    std::vector<std::array<objectStruct::UsageInfo, 3>> usageTable;
+    std::pmr::vector<std::array<objectStruct::UsageInfo, 3>> usageTable;
 
     /// Usage information for memory variables.
     std::vector<objectStruct::UsageInfo> memoryUsage;
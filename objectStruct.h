@@ -1,6 +1,7 @@
 #ifndef OBJECTSTRUCT_H
 #define OBJECTSTRUCT_H
 
+#include <cstdint>
 #include <string>
 #include <utility>
 
@@ -68,6 +69,120 @@ struct UsageInfo {
     UsageInfo() : usageStatus(-1), lifetime(-1) {}
 };
 
+/**
+ * @enum MachineOp
+ * @brief Operation of an object code instruction.
+ */
+enum class MachineOp : std::uint8_t {
+    Mov,    ///< mov x, y
+    Add,    ///< add x, y
+    Sub,    ///< sub x, y
+    Mul,    ///< mul x, y
+    Div,    ///< div x, y
+    Cmp,    ///< cmp x, y
+    And,    ///< and x, y
+    Or,     ///< or x, y
+    Not,    ///< not x
+    Sete,   ///< sete x
+    Setne,  ///< setne x
+    Setl,   ///< setl x
+    Setle,  ///< setle x
+    Setg,   ///< setg x
+    Setge,  ///< setge x
+    Jmp,    ///< jmp label
+    Je,     ///< je label
+    Jne,    ///< jne label
+    Jl,     ///< jl label
+    Jle,    ///< jle label
+    Jg,     ///< jg label
+    Jge,    ///< jge label
+    Read,   ///< jmp ?read(x)
+    Write,  ///< jmp ?write(x)
+    Halt    ///< halt
+};
+
+/**
+ * @enum MachineOperandKind
+ * @brief Kind of value stored in a MachineOperand.
+ */
+enum class MachineOperandKind : std::uint8_t {
+    None,       ///< No operand; printed as "-".
+    Register,   ///< Register R<value>.
+    Memory,     ///< Frame slot [ebp-<value>].
+    Immediate,  ///< Integer literal.
+    Real,       ///< Floating-point literal.
+    Label,      ///< Jump target ?<value>.
+    Temporary,  ///< Frame slot of temporary <value>, not yet assigned.
+    Text        ///< Integer literal kept as text, literal pool entry <value>.
+};
+
+/**
+ * @struct MachineOperand
+ * @brief An operand of an object code instruction.
+ */
+struct MachineOperand {
+    MachineOperandKind kind;  ///< What the operand refers to.
+    union {
+        std::int64_t value;  ///< Register, frame offset, integer or label.
+        double real;         ///< Value of a Real operand.
+    };
+
+    /**
+     * @brief Constructs an absent operand.
+     */
+    MachineOperand() : kind(MachineOperandKind::None), value(0) {}
+
+    static MachineOperand reg(int r) {
+        return make(MachineOperandKind::Register, r);
+    }
+
+    static MachineOperand memory(int offset) {
+        return make(MachineOperandKind::Memory, offset);
+    }
+
+    static MachineOperand immediate(std::int64_t v) {
+        return make(MachineOperandKind::Immediate, v);
+    }
+
+    static MachineOperand immediate(double v) {
+        MachineOperand op;
+        op.kind = MachineOperandKind::Real;
+        op.real = v;
+        return op;
+    }
+
+    static MachineOperand label(int target) {
+        return make(MachineOperandKind::Label, target);
+    }
+
+    static MachineOperand temporary(int temp) {
+        return make(MachineOperandKind::Temporary, temp);
+    }
+
+    static MachineOperand text(int index) {
+        return make(MachineOperandKind::Text, index);
+    }
+
+private:
+    static MachineOperand make(MachineOperandKind k, std::int64_t v) {
+        MachineOperand op;
+        op.kind = k;
+        op.value = v;
+        return op;
+    }
+};
+
+/**
+ * @struct Instruction
+ * @brief An object code instruction. Binary operations use both operands,
+ * unary ones and jumps only the first, halt none.
+ */
+struct Instruction {
+    MachineOp op;        ///< The operation.
+    MachineOperand dst;  ///< The first operand, or the jump target.
+    MachineOperand src;  ///< The second operand.
+};
+
 }  // namespace objectStruct
 
 #endif  // OBJECTSTRUCT_H
@@ -0,0 +1,208 @@
+#include "parallelParser.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// Ends (one past the ';') of the statements of the outermost block from
+// token `from` on that another statement follows, or nothing if the block
+// does not close at the last token
+std::vector<size_t> statementEnds(
+    const std::vector<lexerStruct::Token>& tokens,
+    size_t from) {
+    std::vector<size_t> ends;
+    int depth = 1;
+    for (size_t i = from; i < tokens.size(); i++) {
+        const auto& token = tokens[i];
+        if (token.kind != lexerStruct::TokenKind::Operator) {
+            continue;
+        }
+        if (token.text == "{") {
+            depth++;
+        } else if (token.text == "}" && --depth == 0) {
+            if (i + 1 != tokens.size()) {
+                return {};
+            }
+            // The jumps leaving the last statement are never patched
+            if (!ends.empty() && ends.back() == i) {
+                ends.pop_back();
+            }
+            return ends;
+        } else if (token.text == ";" && depth == 1) {
+            ends.push_back(i + 1);
+        }
+    }
+    return {};
+}
+
+}  // namespace
+
+ParallelParser::ParallelParser(unsigned jobs) : jobs(jobs) {}
+
+void ParallelParser::setFolding(bool enabled) {
+    folding = enabled;
+}
+
+std::optional<irStruct::Module> ParallelParser::parse(
+    const std::vector<lexerStruct::Token>& tokens) {
+    Parser parser(Parser::Engine::Table);
+    parser.setFolding(folding);
+    parser.buildTables();
+    parser.stateStack.push(0);
+
+    size_t consumed = 0;
+    auto nextToken = [&](lexerStruct::Token& token) {
+        if (consumed == tokens.size()) {
+            return false;
+        }
+        token = tokens[consumed++];
+        return true;
+    };
+
+    // Parse the declarations and the statements of the outermost block up to
+    // the first one that produces a quadruple: segments are numbered from 1,
+    // so a list link of 0 keeps meaning the end of the list
+    bool paused = false;
+    parser.boundaryHook = [&]() {
+        paused = parser.nxt > 0;
+        return paused;
+    };
+    bool accepted = parser.runTable(nextToken);
+    parser.boundaryHook = nullptr;
+    if (!paused) {
+        return accepted ? std::optional(parser.buildModule()) : std::nullopt;
+    }
+
+    // Cut the rest into one segment per thread, of about the same number of
+    // tokens
+    std::vector<Segment> segments;
+    const std::vector<size_t> ends = statementEnds(tokens, consumed);
+    size_t begin = consumed;
+    auto end = ends.begin();
+    for (unsigned k = 1; k < jobs && end != ends.end(); k++) {
+        const size_t target = consumed + (tokens.size() - consumed) * k / jobs;
+        end = std::lower_bound(end, ends.end(), std::max(target, begin + 1));
+        if (end != ends.end()) {
+            Segment segment;
+            segment.begin = begin;
+            segment.end = *end;
+            segments.push_back(std::move(segment));
+            begin = *end;
+        }
+    }
+    if (!segments.empty()) {
+        Segment segment;
+        segment.begin = begin;
+        segment.end = tokens.size();
+        segment.last = true;
+        segments.push_back(std::move(segment));
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t k = 1; k < segments.size(); k++) {
+        threads.emplace_back(parseSegment, std::cref(parser), std::cref(tokens),
+                             std::ref(segments[k]));
+    }
+    if (!segments.empty()) {
+        parseSegment(parser, tokens, segments[0]);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Without segments, or if one failed, finish the parse sequentially so
+    // that the error is the one a sequential parse finds
+    bool failed = segments.empty();
+    for (const auto& segment : segments) {
+        failed = failed || !segment.accepted;
+    }
+    if (failed) {
+        return parser.runTable(nextToken) ? std::optional(parser.buildModule())
+                                          : std::nullopt;
+    }
+
+    // Concatenate the segments, shifting their quadruple and temporary
+    // numbers. The jumps leaving the last statement before a segment go to
+    // its first quadruple, as L -> L ; N STATEMENT would patch them
+    int pending = parser.attributeStack.top().nextlist;
+    for (const auto& segment : segments) {
+        const int base = parser.nxt;
+        const int tempBase =
+            static_cast<int>(parser.tempVariableIndices.size());
+        auto shift = [&](irStruct::Operand operand) {
+            if (operand.kind == irStruct::OperandKind::Temp) {
+                operand.index += tempBase;
+            } else if (operand.kind == irStruct::OperandKind::Target &&
+                       operand.index > 0) {
+                operand.index += base - 1;
+            }
+            return operand;
+        };
+
+        parser.patch(pending, base);
+        const auto& quads = segment.quads;
+        for (size_t i = 1; i < quads.size(); i++) {
+            parser.quadruples.push(quads.op(i), shift(quads.arg1(i)),
+                                   shift(quads.arg2(i)),
+                                   shift(quads.result(i)));
+        }
+        parser.nxt += static_cast<int>(quads.size()) - 1;
+        parser.tempVariableIndices.insert(parser.tempVariableIndices.end(),
+                                          segment.temps.begin(),
+                                          segment.temps.end());
+        pending = segment.nextlist > 0 ? segment.nextlist + base - 1
+                                       : segment.nextlist;
+    }
+    return parser.buildModule();
+}
+
+void ParallelParser::parseSegment(const Parser& first,
+                                  const std::vector<lexerStruct::Token>& tokens,
+                                  Segment& segment) {
+    // Share the tables and the declarations of the first parser
+    Parser parser(Parser::Engine::Table);
+    parser.symbolToIdMap = first.symbolToIdMap;
+    parser.gotoTable = first.gotoTable;
+    parser.ruleLhs = first.ruleLhs;
+    parser.ruleLength = first.ruleLength;
+    parser.unitRules = first.unitRules;
+    parser.defaultReductions = first.defaultReductions;
+    parser.symbolTable = first.symbolTable;
+    parser.offset = first.offset;
+    parser.folding = first.folding;
+
+    // Start right after "L ;", with an L whose jumps are patched on merging
+    parser.stateStack = first.stateStack;
+    parser.attributeStack = first.attributeStack;
+    parser.attributeStack.pop();
+    parserStruct::Attribute previous;
+    previous.nextlist = -1;
+    parser.attributeStack.push(previous);
+    parser.quadruples.push(irStruct::Quad());
+    parser.nxt = 1;
+
+    size_t position = segment.begin;
+    auto nextToken = [&](lexerStruct::Token& token) {
+        if (position == segment.end) {
+            return false;
+        }
+        token = tokens[position++];
+        return true;
+    };
+    bool paused = false;
+    if (!segment.last) {
+        parser.boundaryHook = [&]() {
+            paused = position == segment.end;
+            return paused;
+        };
+    }
+    const bool accepted = parser.runTable(nextToken);
+    segment.accepted = segment.last ? accepted : paused;
+    if (!segment.accepted) {
+        return;
+    }
+
+    segment.quads = std::move(parser.quadruples);
+    segment.temps = std::move(parser.tempVariableIndices);
+    segment.nextlist = parser.attributeStack.top().nextlist;
+}
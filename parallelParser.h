@@ -0,0 +1,84 @@
+#ifndef PARALLELPARSER_H
+#define PARALLELPARSER_H
+
+#include "irStruct.h"
+#include "lexerStruct.h"
+#include "parser.h"
+#include <optional>
+#include <vector>
+
+/**
+ * @class ParallelParser
+ * @brief Parses a program whose statement is one large block on several
+ * threads.
+ *
+ * The declarations and the first statement of the outermost block are parsed
+ * on the calling thread. The remaining statements are split at ';' tokens of
+ * the outermost block into one segment per thread. Every such boundary leaves
+ * the LR parser in the same state, right after "L ;", so each segment is
+ * parsed from that state with its own quadruple and temporary numbering.
+ * The segments are then concatenated with their numbers shifted, and the
+ * jumps leaving the last statement of each segment are backpatched to the
+ * start of the next, as L -> L ; N STATEMENT would. The module is identical
+ * to that of a sequential parse; if the program does not have this shape or
+ * a segment fails, the parse continues sequentially.
+ */
+class ParallelParser {
+public:
+    /**
+     * @brief Constructs a parallel parser.
+     *
+     * @param jobs The number of threads, including the calling one.
+     */
+    explicit ParallelParser(unsigned jobs);
+
+    /**
+     * @brief Turns constant folding on or off for all segments, as
+     * Parser::setFolding() does.
+     *
+     * @param enabled Whether to fold.
+     */
+    void setFolding(bool enabled);
+
+    /**
+     * @brief Parses the tokens with the table-driven engine.
+     *
+     * @param tokens The tokens produced by the lexer.
+     * @return The module, or std::nullopt on a syntax error.
+     */
+    std::optional<irStruct::Module> parse(
+        const std::vector<lexerStruct::Token>& tokens);
+
+private:
+    /**
+     * @struct Segment
+     * @brief The tokens of a run of statements and what parsing them gave.
+     */
+    struct Segment {
+        size_t begin = 0;  ///< Index of the first token.
+        size_t end = 0;    ///< One past the last token (after its ';').
+        bool last = false;  ///< Runs to the end of the program.
+        bool accepted = false;  ///< The segment parsed without errors.
+        /// Quadruples; number 0 is a placeholder, so that no list link is 0.
+        irStruct::QuadList quads;
+        std::vector<irStruct::ValueType> temps;  ///< Temporary types.
+        int nextlist = -1;  ///< Jumps leaving its last statement.
+    };
+
+    /**
+     * @brief Parses a segment from the state after a statement boundary.
+     *
+     * @param first The parser that parsed the declarations; its tables,
+     * symbol table and stacks are copied.
+     * @param tokens All tokens.
+     * @param segment The segment to parse.
+     */
+    static void parseSegment(const Parser& first,
+                             const std::vector<lexerStruct::Token>& tokens,
+                             Segment& segment);
+
+    unsigned jobs;  ///< Number of threads.
+    bool folding = false;  ///< Whether the semantic actions fold constants.
+};
+
+#endif  // PARALLELPARSER_H
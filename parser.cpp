@@ -1,35 +1,65 @@
 #include "parser.h"
+#include "blockTracker.h"
+#include "irUtil.h"
+#include "lexer.h"
 #include "opkeymap.h"
 #include "parserUtil.h"
+#include <algorithm>
 #include <cassert>
-#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
 
 constexpr int BUFFER = 1000;
 
+// Depth of the state stack right after shifting the ';' that ends a
+// statement of the outermost block: 0, M, VARIABLES, {, L and ;
+constexpr size_t BOUNDARY_DEPTH = 6;
+
+namespace {
+
+// Tells whether a grammar symbol is a terminal
+bool isTerminal(std::string_view symbol) {
+    return OpKeyMap::terminal.count(std::string(symbol)) != 0;
+}
+
+}  // namespace
+
 // Constructor for the Parser class
-Parser::Parser()
-    : parserState(0), gotoTable(BUFFER, std::vector<int>(BUFFER, 0)) {}
+Parser::Parser(Engine engine, std::pmr::memory_resource* resource)
+    : parserState(0),
+      engine(engine),
+      resource(resource),
+      symbolToIdMap(resource),
+      gotoTable(resource),
+      firstSets(resource),
+      grammarRules(resource),
+      flattenedGrammarRules(resource),
+      itemSets(resource),
+      attributeStack(std::pmr::vector<parserStruct::Attribute>(resource)),
+      symbolTable(resource),
+      quadruples(resource) {}
 
 // Computes the suffix for a given expression I
-std::set<std::string> Parser::compute_suffix(const Expression& I) {
-    std::set<std::string> suffix;
+std::pmr::set<std::pmr::string> Parser::compute_suffix(const Expression& I) {
+    std::pmr::set<std::pmr::string> suffix(resource);
     bool is_empty = true;
     size_t i = I.pos + 1;  // Start looking after the current position in I.S
 
     // Iterate through the symbols in I starting from the position I.pos + 1
     while (is_empty && i < I.S.size()) {
         is_empty = false;
-        const std::string& symbol = I.S[i];
+        const std::pmr::string& symbol = I.S[i];
 
         // If the symbol is a terminal, add it to the suffix set
-        if (OpKeyMap::terminal.count(symbol)) {
+        if (isTerminal(symbol)) {
             suffix.emplace(symbol);
             continue;
         }
 
         // If the symbol is non-terminal, add its corresponding first set to the
         // suffix set
-        for (const std::string& w : firstSets[symbol]) {
+        for (const std::pmr::string& w : firstSets[symbol]) {
             if (w == "^") {
                 is_empty = true;  // If the symbol is epsilon, mark as empty
             } else {
@@ -45,7 +75,7 @@ std::set<std::string> Parser::compute_suffix(const Expression& I) {
 
     // If we still have an empty suffix, add the suffix from expression I
     if (is_empty) {
-        for (const std::string& w : I.suffix) {
+        for (const std::pmr::string& w : I.suffix) {
             suffix.emplace(w);
         }
     }
@@ -55,34 +85,32 @@ std::set<std::string> Parser::compute_suffix(const Expression& I) {
 
 // Adds the non-terminal closure for the current expression I
 void Parser::add_non_terminal_closure(const Expression& I,
-                                      std::set<Expression>& pre,
-                                      const std::string& cur_str) {
+                                      std::pmr::set<Expression>& pre,
+                                      const std::pmr::string& cur_str) {
     // Loop through the grammar rules for the current non-terminal
-    for (const auto& X : grammarRules[cur_str]) {
-        auto x = X.first;
-        auto y = X.second;
-
+    for (const auto& [x, y] : grammarRules[cur_str]) {
         // If the position is at the end of the expression, add closure with the
         // suffix
         if (I.pos == I.S.size() - 1) {
             pre.emplace(cur_str, x, 0, y, I.suffix);
         } else {
-            std::string nxt_str = I.S[I.pos + 1];
+            const std::pmr::string& nxt_str = I.S[I.pos + 1];
 
             // If the next symbol is terminal, use its first set; otherwise,
             // compute suffix
             pre.emplace(cur_str, x, 0, y,
-                        OpKeyMap::terminal.count(nxt_str) ? firstSets[nxt_str]
-                                                          : compute_suffix(I));
+                        isTerminal(nxt_str) ? firstSets[nxt_str]
+                                            : compute_suffix(I));
         }
     }
 }
 
-std::set<Expression> Parser::get_closure(const std::set<Expression>& cur) {
-    auto pre = cur;
-    auto result = cur;
+std::pmr::set<Expression> Parser::get_closure(
+    const std::pmr::set<Expression>& cur) {
+    std::pmr::set<Expression> pre(cur, resource);
+    std::pmr::set<Expression> result(cur, resource);
 
-    auto merge_closures = [&](const std::set<Expression>& pre) {
+    auto merge_closures = [&](const std::pmr::set<Expression>& pre) {
         for (auto I : pre) {
             // Check if the expression already exists in the result set
             auto it = std::find_if(result.begin(), result.end(),
@@ -115,10 +143,10 @@ std::set<Expression> Parser::get_closure(const std::set<Expression>& cur) {
                 continue;
             }
 
-            std::string cur_str = I.S[I.pos];
+            const std::pmr::string& cur_str = I.S[I.pos];
 
             // If the current symbol is non-terminal, add its closure
-            if (!OpKeyMap::terminal.count(cur_str)) {
+            if (!isTerminal(cur_str)) {
                 add_non_terminal_closure(I, pre, cur_str);
             }
         }
@@ -145,45 +173,59 @@ void Parser::init_symbol_mapping() {
 
     // Map non-terminal symbols to unique IDs
     for (const auto& [x, _] : OpKeyMap::Non_terminal) {
-        symbolToIdMap[x] = cnt++;
+        symbolToIdMap.emplace(x, cnt++);
     }
 
     // Map terminal symbols to unique IDs
     for (const auto& [x, _] : OpKeyMap::terminal) {
-        symbolToIdMap[x] = cnt++;
+        symbolToIdMap.emplace(x, cnt++);
     }
 }
 
+int Parser::symbolId(std::string_view symbol) {
+    auto it = symbolToIdMap.find(symbol);
+    if (it == symbolToIdMap.end()) {
+        it = symbolToIdMap.emplace(std::pmr::string(symbol, resource), 0).first;
+    }
+    return it->second;
+}
+
 // Parses a list of expressions and updates the grammar rules
-void Parser::parse_expressions(std::vector<std::string>& tmp) {
-    std::string str;
+void Parser::parse_expressions(const std::vector<std::string>& tmp) {
     int cnt = 1;
 
     // Loop through each expression in the input vector
     for (const auto& x : tmp) {
-        std::stringstream S(x);
-        std::string K, _;
-        std::vector<std::string> h;
-
-        // Read the left-hand side of the rule and discard the separator
-        S >> K >> _;
-
-        // Read the right-hand side of the rule and store the symbols
-        while (S >> str) {
-            h.emplace_back(str);
+        std::pmr::vector<std::pmr::string> words(resource);
+        for (size_t i = 0; i < x.size();) {
+            const size_t start = x.find_first_not_of(' ', i);
+            if (start == std::string::npos) {
+                break;
+            }
+            const size_t end = std::min(x.find(' ', start), x.size());
+            words.emplace_back(std::string_view(x).substr(start, end - start));
+            i = end;
         }
 
+        // The left-hand side and the separator come first, then the
+        // right-hand side of the rule
+        std::pmr::vector<std::pmr::string> h(words.begin() + 2, words.end(),
+                                             resource);
+
         // Add the parsed rule to the grammar rules and the flattened grammar
-        grammarRules[K].emplace_back(h, cnt++);
-        flattenedGrammarRules.emplace_back(K, h);
+        auto& rules = grammarRules.try_emplace(words[0]).first->second;
+        rules.emplace_back(h, cnt++);
+        flattenedGrammarRules.emplace_back(words[0], std::move(h));
     }
 }
 
 // Computes the FIRST sets for all non-terminal symbols in the grammar
-void Parser::compute_first_set(std::vector<std::string>& tmp) {
+void Parser::compute_first_set() {
+    std::pmr::vector<std::pmr::string> tmp(resource);
+
     // Initialize FIRST sets for terminal symbols by adding the terminal itself
     for (const auto& [x, _] : OpKeyMap::terminal) {
-        firstSets[x].emplace(x);
+        firstSets[std::pmr::string(x, resource)].emplace(x);
     }
     auto check_empty = [&](const auto& s) -> bool {
         bool ret = true;
@@ -211,7 +253,8 @@ void Parser::compute_first_set(std::vector<std::string>& tmp) {
     auto compute_step = [&]() -> bool {
         // Iterate through all grammar rules
         for (const auto& [x, y] : grammarRules) {
-            size_t prev_size = firstSets[x].size();
+            auto& first = firstSets[x];
+            size_t prev_size = first.size();
 
             // Process each production in the grammar rule
             for (const auto& [s, _] : y) {
@@ -223,13 +266,13 @@ void Parser::compute_first_set(std::vector<std::string>& tmp) {
                 // Add the symbols in tmp to the FIRST set of the current
                 // non-terminal
                 for (const auto& xx : tmp) {
-                    firstSets[x].insert(xx);
+                    first.insert(xx);
                 }
                 tmp.clear();
             }
 
             // If the FIRST set size increased, continue processing
-            if (prev_size < firstSets[x].size()) {
+            if (prev_size < first.size()) {
                 return true;
             }
         }
@@ -241,14 +284,15 @@ void Parser::compute_first_set(std::vector<std::string>& tmp) {
 }
 
 // Retrieves the item sets and symbols for a given index in itemSets
-std::pair<std::vector<std::set<Expression>>, std::vector<std::string>>
+std::pair<std::pmr::vector<std::pmr::set<Expression>>,
+          std::pmr::vector<std::pmr::string>>
 Parser::get_Items(int idx) {
-    std::set<std::string> symbols_to_process;
-    std::vector<std::set<Expression>> item_sets;
-    std::vector<std::string> symbols;
+    std::pmr::set<std::pmr::string> symbols_to_process(resource);
+    std::pmr::vector<std::pmr::set<Expression>> item_sets(resource);
+    std::pmr::vector<std::pmr::string> symbols(resource);
 
     // Collect symbols that are yet to be processed in the current item set
-    for (auto I : itemSets[idx]) {
+    for (const auto& I : itemSets[idx]) {
         if (I.pos < I.S.size() && I.S[I.pos] != "^") {
             symbols_to_process.insert(I.S[I.pos]);
         }
@@ -256,7 +300,7 @@ Parser::get_Items(int idx) {
 
     // For each symbol to process, create new item sets
     for (const auto& symbol : symbols_to_process) {
-        std::set<Expression> tmp_set;
+        std::pmr::set<Expression> tmp_set(resource);
         for (const auto& I : itemSets[idx]) {
             if (I.pos < I.S.size() && I.S[I.pos] == symbol) {
                 tmp_set.emplace(I.T, I.S, I.pos + 1, I.idx,
@@ -273,13 +317,13 @@ Parser::get_Items(int idx) {
 
 // Constructs the LR parsing table
 void Parser::get_LR_table() {
-    std::set<std::string> suffix;
-    suffix.insert("#");      // End-of-input symbol
-    std::string s = "PROG";  // Start symbol
-    Expression e(s, grammarRules[s][0].first, 0, grammarRules[s][0].second,
-                 suffix);
-    std::set<Expression> st;
+    std::pmr::set<std::pmr::string> suffix(resource);
+    suffix.emplace("#");  // End-of-input symbol
+    const auto& start = grammarRules.find("PROG")->second[0];  // Start symbol
+    Expression e("PROG", start.first, 0, start.second, suffix, resource);
+    std::pmr::set<Expression> st(resource);
     st.insert(e);
+    gotoTable.assign(BUFFER, std::pmr::vector<int>(BUFFER, 0, resource));
 
     // Get the closure for the start symbol and initialize itemSets
     auto e1 = get_closure(st);
@@ -293,7 +337,7 @@ void Parser::get_LR_table() {
         int cnt = 0;
         // Process each set of items
         for (const auto& x : sets) {
-            auto do_word = sets_words[cnt++];
+            const auto& do_word = sets_words[cnt++];
 
             // Get the closure of the current set of items
             auto nowset = get_closure(x);
@@ -307,7 +351,7 @@ void Parser::get_LR_table() {
             }
 
             // Update the goto table with the index of the new set
-            gotoTable[i][symbolToIdMap[do_word]] = idx;
+            gotoTable[i][symbolId(do_word)] = idx;
             CN++;
         }
     }
@@ -320,7 +364,7 @@ void Parser::get_LR_table() {
             // suffix symbols
             if (I.pos >= I.S.size() || I.S[0] == "^") {
                 for (const auto& y : I.suffix) {
-                    gotoTable[i][symbolToIdMap[y]] =
+                    gotoTable[i][symbolId(y)] =
                         -I.idx;  // Negative index for reductions
                 }
             }
@@ -329,52 +373,125 @@ void Parser::get_LR_table() {
     }
 }
 
-// Generates the output for the parser, including symbol table, quadruples, and
-// other details
-std::vector<std::string> Parser::generateParserOutput(
-    int nxt,
-    const std::vector<parserStruct::QuadTuple>& quadruples,
-    const std::vector<parserStruct::Symbol>& symbolTable,
-    const std::vector<int>& tempVariableIndices) {
-    std::vector<std::string> output;
+// Summarises the rules for the parse loop and picks the default reductions
+void Parser::compress_LR_table() {
+    // Rule numbers start at 1, as in the goto table
+    ruleLhs.assign(flattenedGrammarRules.size() + 1, 0);
+    ruleLength.assign(flattenedGrammarRules.size() + 1, 0);
+    unitRules.assign(flattenedGrammarRules.size() + 1, false);
+
+    // The check a rule's action makes follows from its symbols: a declared
+    // identifier, another identifier, or a double literal
+    auto checkOf = [](std::string_view lhs, const auto& rhs) {
+        if (rhs.size() == 1 && rhs[0] == "id") {
+            return RuleCheck::Name;
+        }
+        if (std::find(rhs.begin(), rhs.end(), "ID") != rhs.end()) {
+            return lhs == "VARIABLE" ? RuleCheck::Declare : RuleCheck::Lookup;
+        }
+        if (rhs.size() == 1 && rhs[0] == "UFLOAT") {
+            return RuleCheck::DoubleLiteral;
+        }
+        return RuleCheck::None;
+    };
+    for (size_t rule = 1; rule <= flattenedGrammarRules.size(); rule++) {
+        const auto& [lhs, rhs] = flattenedGrammarRules[rule - 1];
+        ruleLhs[rule] = symbolId(lhs);
+        ruleLength[rule] = rhs[0] == "^" ? 0 : rhs.size();
+        unitRules[rule] = rhs.size() == 1 && !isTerminal(rhs[0]) &&
+                          hasEmptyAction(rule);
+
+        // The checks are listed by rule number, so a rule that moves in
+        // OpKeyMap::language has to move in the lists too
+        if (ruleCheck(static_cast<int>(rule)) != checkOf(lhs, rhs)) {
+            throw std::logic_error("Rule " + std::to_string(rule) + " (" +
+                                   std::string(lhs) +
+                                   " -> ...) is listed with the wrong check");
+        }
+    }
 
-    // Add the size of the symbol table
-    output.push_back(std::to_string(symbolTable.size()) + "\n");
+    // A state whose reductions all use the same rule reduces by it on any
+    // lookahead it has no entry for. The error is then found in a later
+    // state, before the offending token is shifted
+    defaultReductions.assign(itemSets.size(), 0);
+    for (size_t state = 0; state < itemSets.size(); state++) {
+        std::set<int> rules;
+        for (const auto& [name, _] : OpKeyMap::terminal) {
+            int act = gotoTable[state][symbolId(name)];
+            if (act < -1) {
+                rules.insert(-act);
+            }
+        }
+        if (rules.size() == 1) {
+            defaultReductions[state] = *rules.begin();
+        }
+    }
+}
 
-    // Add the symbol table entries
+// Moves the symbol table, temporaries and quadruples into an IR module. Jumps
+// that were never backpatched are resolved to the End quadruple here, so the
+// module is complete without any further text processing
+std::vector<irStruct::SymbolEntry> Parser::symbols() const {
+    std::vector<irStruct::SymbolEntry> entries;
     for (const auto& symbol : symbolTable) {
-        output.push_back(symbol.name + " " +
-                         std::to_string(OpKeyMap::typr_to_int.at(symbol.type)) +
-                         " " + "null " + std::to_string(symbol.offset) + "\n");
+        entries.emplace_back(symbol.name,
+                             static_cast<irStruct::ValueType>(
+                                 OpKeyMap::typr_to_int.at(symbol.type)),
+                             symbol.offset);
     }
+    return entries;
+}
 
-    // Add the size of temporary variables
-    output.push_back(std::to_string(tempVariableIndices.size()) + "\n");
+void Parser::setBlockTracker(BlockTracker* tracker) {
+    blockTracker = tracker;
+}
 
-    // Add the next available temporary variable index
-    output.push_back(std::to_string(nxt) + "\n");
+void Parser::setFolding(bool enabled) {
+    folding = enabled;
+}
 
-    // Add the quadruples to the output
-    for (std::size_t i = 0; i < quadruples.size(); i++) {
-        std::string line = std::to_string(i) + ": (" + quadruples[i].operation +
-                           "," + quadruples[i].argument1 + "," +
-                           quadruples[i].argument2 + ",";
+std::optional<irStruct::Operand> Parser::foldConstant(
+    irStruct::OpCode op,
+    const irStruct::Operand& a,
+    const irStruct::Operand& b) const {
+    if (!folding) {
+        return std::nullopt;
+    }
+    return irUtil::fold(op, a, b);
+}
 
-        // Handle jump operations in quadruples
-        if (quadruples[i].operation[0] == 'j') {
-            if (quadruples[i].Xfour > 0)
-                line += std::to_string(quadruples[i].Xfour);
-            else
-                line += std::to_string(quadruples.size() - 1);
-        } else {
-            line += quadruples[i].destination;
+irStruct::Operand Parser::materialize(const irStruct::Operand& place) {
+    if (!place.isImmediate()) {
+        return place;
+    }
+    const auto temp = parserUtil::Temp_New(
+        place.kind == irStruct::OperandKind::ImmDouble, tempVariableIndices);
+    quadruples.push(irStruct::Quad(irStruct::OpCode::Assign, place,
+                                   irStruct::Operand(), temp));
+    nxt++;
+    return temp;
+}
+
+// Backpatches a jump list, telling the block tracker which jumps got their
+// target (the walk stops where parserUtil::backpatch stops)
+void Parser::patch(int list, int target) {
+    if (blockTracker) {
+        for (int i = list; i > 0; i = quadruples.result(i).index) {
+            blockTracker->resolved(i, target);
         }
+    }
+    parserUtil::backpatch(list, target, quadruples);
+}
 
-        line += ")\n";
-        output.push_back(line);
+irStruct::Module Parser::buildModule() {
+    parserUtil::resolveJumps(quadruples);
+    if (blockTracker) {
+        blockTracker->finish(quadruples);
     }
 
-    return output;  // Return the generated output as a vector of strings
+    // The quadruples keep the parser's memory resource
+    return irStruct::Module{symbols(), std::move(tempVariableIndices),
+                            std::move(quadruples)};
 }
 
 #define POP_STACK_1()            \
@@ -400,342 +517,496 @@ std::vector<std::string> Parser::generateParserOutput(
     } while (0)
 // Macro to save an element (r) to the stack and also add the current quadruple
 // to the 'quadruples' vector
-#define SAVE_STACK(r)             \
-    do {                          \
-        quadruples.push_back(qt); \
-        nxt++;                    \
-        attributeStack.push(r);   \
+#define SAVE_STACK(r)           \
+    do {                        \
+        quadruples.push(qt);    \
+        nxt++;                  \
+        attributeStack.push(r); \
     } while (0)
-#define MAKE_QUAD(a, b, c, d) qt = parserStruct::QuadTuple((a), (b), (c), (d))
-#define _GEN_EMPTY_CASE(t) auto case##t = [&](){}
-#define _GEN_SYM_CASE(t, s) \
-    auto case##t = [&](){attd.op = s; attributeStack.push(attd);}
-#define _GEN_IO_CASE(t, p, f)                                               \
-    auto case##t = [&](){                                                   \
-        POP_STACK(p);                                                       \
-        MAKE_QUAD(f, "-", "-", parserUtil::lookup(att1.name, symbolTable)); \
-        SAVE_STACK(attd);}
-std::vector<std::string> Parser::parser(std::vector<std::string>& res) {
+#define MAKE_QUAD(a, b, c, d) qt = irStruct::Quad((a), (b), (c), (d))
+#define _GEN_EMPTY_CASE(t) case t:
+// Rules whose semantic action does nothing; the attribute of the right-hand
+// side is left on the stack for the left-hand side
+#define EMPTY_ACTION_RULES(X)                                          \
+    X(6) X(16) X(21) X(23) X(25) X(26) X(29) X(31) X(32) X(37) X(40) \
+    X(42) X(43) X(60) X(63)
+// Rules whose semantic action can reject the program, by the check it makes.
+// The numbers are checked against the grammar when the tables are built
+#define NAME_RULES(X) X(9)
+#define DECLARE_RULES(X) X(10) X(11)
+#define LOOKUP_RULES(X) X(19) X(34) X(49) X(61) X(62) X(64) X(65)
+#define INT_LITERAL_RULES(X) X(35) X(47)
+#define DOUBLE_LITERAL_RULES(X) X(36) X(48)
+#define _GEN_SYM_CASE(t, s)         \
+    case t:                         \
+        attd.op = s;                \
+        attributeStack.push(attd);  \
+        break
+#define _GEN_IO_CASE(t, p, f)                                        \
+    case t:                                                          \
+        POP_STACK(p);                                                \
+        MAKE_QUAD(f, NONE, NONE,                                     \
+                  parserUtil::lookup(att1.name, symbolTable));       \
+        SAVE_STACK(attd);                                            \
+        break
+// Runs the semantic action of a rule (numbered from 1 as in
+// OpKeyMap::language) on the attribute stack. Rule 1 accepts and never gets
+// here. The rule's symbols are still on the parse stacks, so lexeme is the
+// text of the last token shifted.
+void Parser::reduce(int rule) {
     parserStruct::Attribute att1, att2, att3, att4, att5, attd;
-    parserStruct::QuadTuple qt;
+    irStruct::Quad qt;
     parserStruct::Symbol symb;
+    const irStruct::Operand NONE;  // The "-" operand
+
+    switch (rule) {
+        case 2:
+            POP_STACK(3);
+            MAKE_QUAD(irStruct::OpCode::End, NONE, NONE, NONE);
+            quadruples.push(qt);
+            nxt++;
+            att2.name = "SUBPROG";
+            attributeStack.push(att2);
+            break;
+        case 3:
+            offset = 0;
+            attributeStack.push(att1);
+            break;
+        case 4:
+            att1.quad = nxt;
+            attributeStack.push(att1);
+            break;
+        case 5:
+            attributeStack.pop();
+            break;
+        case 7:
+            att1.type = "int";
+            att1.width = 4;
+            attributeStack.push(att1);
+            break;
+        case 8:
+            att1.type = "double";
+            att1.width = 8;
+            attributeStack.push(att1);
+            break;
+        NAME_RULES(_GEN_EMPTY_CASE)
+            att1.name = lexeme;
+            attributeStack.push(att1);
+            break;
+        DECLARE_RULES(_GEN_EMPTY_CASE) {
+            POP_STACK(2);
+            symb = parserStruct::Symbol(att1.name, att2.type, offset);
+
+            bool isSameName = 0;
+            for (auto& i : symbolTable) {
+                if (symb.name == i.name) {
+                    isSameName = 1;
+                    break;
+                }
+            }
+            if (isSameName) {
+                throw parserStruct::SyntaxError();
+            }
+            symbolTable.push_back(symb);
+            offset += att2.width;
+            att3.type = att2.type;
+            att3.width = att2.width;
+            attributeStack.push(att3);
+            break;
+        }
+        case 12:
+        case 13:
+        case 14:
+            att1.nextlist = -1;
+            attributeStack.pop();
+            attributeStack.push(att1);
+            break;
+        case 15:
+            att1.nextlist = -1;
+            attributeStack.push(att1);
+            break;
+        case 17:
+            POP_STACK(4);
+            patch(att1.nextlist, att4.quad);
+            patch(att3.truelist, att2.quad);
+            att5.nextlist = att3.falselist;
+            attributeStack.push(att5);
+            MAKE_QUAD(irStruct::OpCode::Jump, NONE, NONE,
+                      irStruct::Operand::target(att4.quad));
+            quadruples.push(qt);
+            nxt++;
+            break;
+        case 18:
+            POP_STACK(3);
+            patch(att3.truelist, att2.quad);
+            att4.nextlist =
+                parserUtil::merge(att3.falselist, att1.nextlist, quadruples);
+            attributeStack.push(att4);
+            break;
+        case 19:
+            POP_STACK(2);
+            MAKE_QUAD(irStruct::OpCode::Assign, att1.place, NONE,
+                      parserUtil::lookup(att2.name, symbolTable));
+            SAVE_STACK(att1);
+            break;
+        case 20:
+            POP_STACK(3);
+            patch(att3.nextlist, att2.quad);
+            att4.nextlist = att1.nextlist;
+            attributeStack.push(att4);
+            break;
+        case 22:
+            POP_STACK(2);
+            att3.type = "int";
+            if (auto value = foldConstant(irStruct::OpCode::Or,
+                                          att2.place, att1.place)) {
+                att3.place = *value;
+                attributeStack.push(att3);
+                break;
+            }
+            att3.place = parserUtil::Temp_New(0, tempVariableIndices);
+            MAKE_QUAD(irStruct::OpCode::Or, att2.place, att1.place,
+                      att3.place);
+            SAVE_STACK(att3);
+            break;
+        case 24:
+            POP_STACK(2);
+            att3.type = "int";
+            if (auto value = foldConstant(irStruct::OpCode::And,
+                                          att2.place, att1.place)) {
+                att3.place = *value;
+                attributeStack.push(att3);
+                break;
+            }
+            att3.place = parserUtil::Temp_New(0, tempVariableIndices);
+            MAKE_QUAD(irStruct::OpCode::And, att2.place, att1.place,
+                      att3.place);
+            SAVE_STACK(att3);
+            break;
+        case 27:
+            POP_STACK(1);
+            att3.type = "int";
+            if (auto value =
+                    foldConstant(irStruct::OpCode::Not, att1.place, NONE)) {
+                att3.place = *value;
+                attributeStack.push(att3);
+                break;
+            }
+            att3.place = parserUtil::Temp_New(0, tempVariableIndices);
+            MAKE_QUAD(irStruct::OpCode::Not, att1.place, NONE, att3.place);
+            SAVE_STACK(att3);
+            break;
+        case 28:
+            POP_STACK(3);
+            attd.type = "int";
+            if (auto value = foldConstant(att2.op, att3.place, att1.place)) {
+                attd.place = *value;
+                attributeStack.push(attd);
+                break;
+            }
+            attd.place = parserUtil::Temp_New(0, tempVariableIndices);
+            MAKE_QUAD(att2.op, att3.place, att1.place, attd.place);
+            SAVE_STACK(attd);
+            break;
+        case 30:
+            POP_STACK(3);
+            attd.type = att3.type;
+            if (auto value = foldConstant(att2.op, att3.place, att1.place)) {
+                attd.place = *value;
+                attributeStack.push(attd);
+                break;
+            }
+            attd.place = parserUtil::Temp_New(
+                OpKeyMap::typr_to_int.at(att3.type), tempVariableIndices);
+            MAKE_QUAD(att2.op, att3.place, att1.place, attd.place);
+            SAVE_STACK(attd);
+            break;
+        case 33:
+            POP_STACK(3);
+            attd.type = att1.type;
+            if (auto value = foldConstant(att2.op, att3.place, att1.place)) {
+                attd.place = *value;
+                attributeStack.push(attd);
+                break;
+            }
+            attd.place = parserUtil::Temp_New(
+                OpKeyMap::typr_to_int.at(att1.type), tempVariableIndices);
+            MAKE_QUAD(att2.op, att3.place, att1.place, attd.place);
+            SAVE_STACK(attd);
+            break;
+        case 34:
+        case 49:
+            POP_STACK(1);
+            attd.place = parserUtil::lookup(att1.name, symbolTable);
+            attd.type = parserUtil::look_up_type(att1.name, symbolTable);
+            attributeStack.push(attd);
+            break;
+        INT_LITERAL_RULES(_GEN_EMPTY_CASE)
+            attd.type = "int";
+            if (folding) {
+                attd.place = parserUtil::intLiteral(lexeme);
+                attributeStack.push(attd);
+                break;
+            }
+            attd.place = parserUtil::Temp_New(0, tempVariableIndices);
+            MAKE_QUAD(irStruct::OpCode::Assign,
+                      parserUtil::intLiteral(lexeme), NONE, attd.place);
+            SAVE_STACK(attd);
+            break;
+        DOUBLE_LITERAL_RULES(_GEN_EMPTY_CASE)
+            attd.type = "double";
+            if (folding) {
+                attd.place = irStruct::Operand::immDouble(stof(lexeme));
+                attributeStack.push(attd);
+                break;
+            }
+            attd.place = parserUtil::Temp_New(1, tempVariableIndices);
+            MAKE_QUAD(irStruct::OpCode::Assign,
+                      irStruct::Operand::immDouble(stof(lexeme)), NONE,
+                      attd.place);
+            SAVE_STACK(attd);
+            break;
+        case 38:
+            POP_STACK(2);
+            attd.type = att1.type;
+            if (auto value = foldConstant(
+                    att2.op, irUtil::zeroLike(att1.place), att1.place)) {
+                attd.place = *value;
+                attributeStack.push(attd);
+                break;
+            }
+            attd.place = parserUtil::Temp_New(
+                OpKeyMap::typr_to_int.at(att1.type), tempVariableIndices);
+            MAKE_QUAD(att2.op, irStruct::Operand::immInt(0), att1.place,
+                      attd.place);
+            SAVE_STACK(attd);
+            break;
+        case 39:
+            POP_STACK(3);
+            patch(att3.falselist, att2.quad);
+            attd.truelist =
+                parserUtil::merge(att3.truelist, att1.truelist, quadruples);
+            attd.falselist = att1.falselist;
+            attributeStack.push(attd);
+            break;
+        case 41:
+            POP_STACK(3);
+            patch(att3.truelist, att2.quad);
+            attd.falselist =
+                parserUtil::merge(att3.falselist, att1.falselist, quadruples);
+            attd.truelist = att1.truelist;
+            attributeStack.push(attd);
+            break;
+        case 44:
+            POP_STACK(1);
+            attd.falselist = att1.truelist;
+            attd.truelist = att1.falselist;
+            attributeStack.push(attd);
+            break;
+        case 45:
+            POP_STACK(3);
+            // A jump list starting at quadruple 0 reads as empty, so a
+            // condition there keeps a literal in a temporary before it
+            if (nxt == 0) {
+                att3.place = materialize(att3.place);
+                att1.place = materialize(att1.place);
+            }
+            attd.truelist = nxt;
+            attd.falselist = nxt + 1;
+            if (auto value = foldConstant(att2.op, att3.place, att1.place)) {
+                // The first jump goes where the known outcome leads; the
+                // second one is unreachable
+                if (value->intValue == 0) {
+                    std::swap(attd.truelist, attd.falselist);
+                }
+                MAKE_QUAD(irStruct::OpCode::Jump, NONE, NONE,
+                          irStruct::Operand::target(-1));
+            } else {
+                MAKE_QUAD(irUtil::toJump(att2.op), att3.place, att1.place,
+                          irStruct::Operand::target(-1));
+            }
+            quadruples.push(qt);
+            nxt++;
+            MAKE_QUAD(irStruct::OpCode::Jump, NONE, NONE,
+                      irStruct::Operand::target(-1));
+            SAVE_STACK(attd);
+            break;
+        case 46:
+            POP_STACK(1);
+            if (nxt == 0) {
+                att1.place = materialize(att1.place);
+            }
+            attd.truelist = nxt;
+            attd.falselist = nxt + 1;
+            if (auto value = foldConstant(irStruct::OpCode::Ne, att1.place,
+                                          irUtil::zeroLike(att1.place))) {
+                if (value->intValue == 0) {
+                    std::swap(attd.truelist, attd.falselist);
+                }
+                MAKE_QUAD(irStruct::OpCode::Jump, NONE, NONE,
+                          irStruct::Operand::target(-1));
+            } else {
+                MAKE_QUAD(irStruct::OpCode::JumpNz, att1.place, NONE,
+                          irStruct::Operand::target(-1));
+            }
+            quadruples.push(qt);
+            nxt++;
+            MAKE_QUAD(irStruct::OpCode::Jump, NONE, NONE,
+                      irStruct::Operand::target(-1));
+            SAVE_STACK(attd);
+            break;
+        _GEN_SYM_CASE(50, irStruct::OpCode::Add);
+        _GEN_SYM_CASE(51, irStruct::OpCode::Sub);
+        _GEN_SYM_CASE(52, irStruct::OpCode::Mul);
+        _GEN_SYM_CASE(53, irStruct::OpCode::Div);
+        _GEN_SYM_CASE(54, irStruct::OpCode::Eq);
+        _GEN_SYM_CASE(55, irStruct::OpCode::Ne);
+        _GEN_SYM_CASE(56, irStruct::OpCode::Lt);
+        _GEN_SYM_CASE(57, irStruct::OpCode::Le);
+        _GEN_SYM_CASE(58, irStruct::OpCode::Gt);
+        _GEN_SYM_CASE(59, irStruct::OpCode::Ge);
+
+        _GEN_IO_CASE(61, 2, irStruct::OpCode::Read);
+        _GEN_IO_CASE(62, 1, irStruct::OpCode::Read);
+        _GEN_IO_CASE(64, 1, irStruct::OpCode::Write);
+        _GEN_IO_CASE(65, 2, irStruct::OpCode::Write);
+
+        EMPTY_ACTION_RULES(_GEN_EMPTY_CASE)
+        default:
+            break;
+    }
+}
+
+Parser::RuleCheck Parser::ruleCheck(int rule) {
+    switch (rule) {
+        NAME_RULES(_GEN_EMPTY_CASE)
+        return RuleCheck::Name;
+        DECLARE_RULES(_GEN_EMPTY_CASE)
+        return RuleCheck::Declare;
+        LOOKUP_RULES(_GEN_EMPTY_CASE)
+        return RuleCheck::Lookup;
+        DOUBLE_LITERAL_RULES(_GEN_EMPTY_CASE)
+        return RuleCheck::DoubleLiteral;
+        default:
+            return RuleCheck::None;
+    }
+}
+
+bool Parser::hasEmptyAction(int rule) {
+    switch (rule) {
+        EMPTY_ACTION_RULES(_GEN_EMPTY_CASE)
+        return true;
+        default:
+            return false;
+    }
+}
+
+// Tells the block tracker about a reduction
+void Parser::trackReduction(int rule) {
+    if (flattenedGrammarRules.empty()) {
+        parse_expressions(OpKeyMap::language);
+    }
+    const auto& [lhs, rhs] = flattenedGrammarRules[rule - 1];
+    blockTracker->reduced(lhs, rhs, quadruples);
+}
+
+std::optional<irStruct::Module> Parser::parse(
+    const std::vector<lexerStruct::Token>& tokens) {
+    size_t cur = 0;  // Index of the next token to hand out
+    return parse([&](lexerStruct::Token& token) {
+        if (cur == tokens.size()) {
+            return false;
+        }
+        token = tokens[cur++];
+        return true;
+    });
+}
+
+std::optional<irStruct::Module> Parser::parse(TokenStream& stream) {
+    return parse(
+        [&](lexerStruct::Token& token) { return stream.next(token); });
+}
+
+std::optional<irStruct::Module> Parser::parse(
+    const std::function<bool(lexerStruct::Token&)>& nextToken) {
+    reset();
+    if (engine == Engine::Direct) {
+        return parseDirect(nextToken);
+    }
+    if (engine == Engine::Descent) {
+        return parseDescent(nextToken);
+    }
+
+    buildTables();
+    stateStack.push(0);
+    if (!runTable(nextToken)) {
+        return std::nullopt;
+    }
+
+    // After parsing is complete, hand over the symbol table, temporaries and
+    // quadruples
+    return buildModule();
+}
+
+// Builds the LR parsing table, once per parser
+void Parser::buildTables() {
+    if (!gotoTable.empty()) {
+        return;
+    }
     init_symbol_mapping();  // Initialize the symbol mappings (e.g., for
                             // tokenization)
-    std::vector<std::string> tmp =
-        OpKeyMap::language;  // Retrieve the language's operation key mappings
-    parse_expressions(tmp);  // Parse expressions based on language rules
-    tmp.clear();
-    compute_first_set(tmp);  // Compute the first set for parsing
+    parse_expressions(OpKeyMap::language);  // Parse the language's rules
+    compute_first_set();  // Compute the first set for parsing
     get_LR_table();          // Get the LR parsing table for syntax analysis
+    compress_LR_table();     // Add default reductions and rule summaries
+}
 
-    std::vector<std::pair<std::string, std::string>> temp(res.size());
-    for (size_t i = 0; i < res.size(); i++) {
-        std::stringstream S(res[i]);
-        S >> temp[i].first;
-        S >> temp[i].second;
-    }
+void Parser::reset() {
+    stateStack = std::stack<int>();
+    attributeStack = parserStruct::AttributeStack();
+    symbolTable.clear();
+    quadruples.clear();
+    tempVariableIndices.clear();
+    nxt = 0;
+    offset = 0;
+}
 
-    temp.emplace_back(
-        "#", "$");  // Add a special symbol to mark the end of the input
-    stateStack.push(0);
-    symbolStack.emplace("#");
-    int offset = 0;  // Initialize offset (typically used for error handling or
-                     // lookahead)
-    int nxt = 0;     // Initialize the next quadruple index
-    auto clear_attributes = [&]() {
-        att1 = parserStruct::Attribute();
-        att2 = parserStruct::Attribute();
-        att3 = parserStruct::Attribute();
-        att4 = parserStruct::Attribute();
-        att5 = parserStruct::Attribute();
-        attd = parserStruct::Attribute();
-        qt = parserStruct::QuadTuple();
-        symb = parserStruct::Symbol();
-    };
-    _GEN_EMPTY_CASE(0);
-    _GEN_EMPTY_CASE(1);
-    auto case2 = [&]() {
-        POP_STACK(3);
-        MAKE_QUAD("End", "-", "-", "-");
-        quadruples.push_back(qt);
-        nxt++;
-        att2.name = "SUBPROG";
-        attributeStack.push(att2);
-    };
-    auto case3 = [&]() {
-        offset = 0;
-        attributeStack.push(att1);
-    };
-    auto case4 = [&]() {
-        att1.quad = nxt;
-        attributeStack.push(att1);
-    };
-    auto case5 = [&]() { attributeStack.pop(); };
-    _GEN_EMPTY_CASE(6);
-    auto case7 = [&]() {
-        att1.type = "int";
-        att1.width = 4;
-        attributeStack.push(att1);
-    };
-    auto case8 = [&]() {
-        att1.type = "double";
-        att1.width = 8;
-        attributeStack.push(att1);
-    };
-    auto case9 = [&]() {
-        att1.name = symbolStack.top();
-        attributeStack.push(att1);
-    };
-    auto case11 = [&]() {
-        POP_STACK(2);
-        symb = parserStruct::Symbol(att1.name, att2.type, offset);
-
-        bool isSameName = 0;
-        for (auto& i : symbolTable) {
-            if (symb.name == i.name) {
-                isSameName = 1;
-                break;
-            }
+bool Parser::runTable(
+    const std::function<bool(lexerStruct::Token&)>& nextToken) {
+    const lexerStruct::Token endOfInput(
+        "#", lexerStruct::TokenKind::Operator);  // Marks the end of the input
+
+    // Pull the lookahead token, or the end marker once the input is
+    // exhausted, and look up its symbol ID once; an unknown operator gets
+    // ID 0
+    lexerStruct::Token token;
+    int nxtsymbol{};
+    const int idSymbol = symbolToIdMap.find("id")->second;
+    const int intSymbol = symbolToIdMap.find("UINT")->second;
+    const int doubleSymbol = symbolToIdMap.find("UFLOAT")->second;
+    auto advance = [&]() {
+        if (!nextToken(token)) {
+            token = endOfInput;
         }
-        if (isSameName) {
-            std::cout << "Syntax Error\n";
-            exit(0);
+        if (token.kind == lexerStruct::TokenKind::Identifier) {
+            nxtsymbol = idSymbol;
+        } else if (token.kind == lexerStruct::TokenKind::Integer) {
+            nxtsymbol = intSymbol;
+        } else if (token.kind == lexerStruct::TokenKind::Double) {
+            nxtsymbol = doubleSymbol;
+        } else {
+            auto it = symbolToIdMap.find(token.text);
+            nxtsymbol = it == symbolToIdMap.end() ? 0 : it->second;
         }
-        symbolTable.push_back(symb);
-        offset += att2.width;
-        att3.type = att2.type;
-        att3.width = att2.width;
-        attributeStack.push(att3);
-    };
-    auto case14 = [&]() {
-        att1.nextlist = -1;
-        attributeStack.pop();
-        attributeStack.push(att1);
-    };
-    auto case15 = [&]() {
-        att1.nextlist = -1;
-        attributeStack.push(att1);
-    };
-    _GEN_EMPTY_CASE(16);
-    auto case17 = [&]() {
-        POP_STACK(4);
-        parserUtil::backpatch(att1.nextlist, att4.quad, quadruples);
-        parserUtil::backpatch(att3.truelist, att2.quad, quadruples);
-        att5.nextlist = att3.falselist;
-        attributeStack.push(att5);
-        MAKE_QUAD("j", "-", "-", "");
-        qt.Xfour = att4.quad;
-        quadruples.push_back(qt);
-        nxt++;
     };
-    auto case18 = [&]() {
-        POP_STACK(3);
-        parserUtil::backpatch(att3.truelist, att2.quad, quadruples);
-        att4.nextlist =
-            parserUtil::merge(att3.falselist, att1.nextlist, quadruples);
-        attributeStack.push(att4);
-    };
-    auto case19 = [&]() {
-        POP_STACK(2);
-        MAKE_QUAD("=", att1.place, "-",
-                  parserUtil::lookup(att2.name, symbolTable));
-        SAVE_STACK(att1);
-    };
-    auto case20 = [&]() {
-        POP_STACK(3);
-        parserUtil::backpatch(att3.nextlist, att2.quad, quadruples);
-        att4.nextlist = att1.nextlist;
-        attributeStack.push(att4);
-    };
-    _GEN_EMPTY_CASE(21);
-    auto case22 = [&]() {
-        POP_STACK(2);
-        att3.place = parserUtil::Temp_New(0, tempVariableIndices);
-        att3.type = "int";
-        MAKE_QUAD("||", att2.place, att1.place, att3.place);
-        SAVE_STACK(att3);
-    };
-    _GEN_EMPTY_CASE(23);
-    auto case24 = [&]() {
-        POP_STACK(2);
-        att3.place = parserUtil::Temp_New(0, tempVariableIndices);
-        att3.type = "int";
-        MAKE_QUAD("&&", att2.place, att1.place, att3.place);
-        SAVE_STACK(att3);
-    };
-    _GEN_EMPTY_CASE(25);
-    _GEN_EMPTY_CASE(26);
-    auto case27 = [&]() {
-        POP_STACK(1);
-        att3.place = parserUtil::Temp_New(0, tempVariableIndices);
-        att3.type = "int";
-        MAKE_QUAD("!", att1.place, "-", att3.place);
-        SAVE_STACK(att3);
-    };
-    auto case28 = [&]() {
-        POP_STACK(3);
-        attd.place = parserUtil::Temp_New(0, tempVariableIndices);
-        attd.type = "int";
-        MAKE_QUAD(att2.op, att3.place, att1.place, attd.place);
-        SAVE_STACK(attd);
-    };
-    _GEN_EMPTY_CASE(29);
-    auto case30 = [&]() {
-        POP_STACK(3);
-        attd.place = parserUtil::Temp_New(OpKeyMap::typr_to_int.at(att3.type),
-                                          tempVariableIndices);
-        attd.type = att3.type;
-        MAKE_QUAD(att2.op, att3.place, att1.place, attd.place);
-        SAVE_STACK(attd);
-    };
-    _GEN_EMPTY_CASE(31);
-    _GEN_EMPTY_CASE(32);
-    auto case33 = [&]() {
-        POP_STACK(3);
-        attd.place = parserUtil::Temp_New(OpKeyMap::typr_to_int.at(att1.type),
-                                          tempVariableIndices);
-        attd.type = att1.type;
-        MAKE_QUAD(att2.op, att3.place, att1.place, attd.place);
-        SAVE_STACK(attd);
-    };
-    auto case34 = [&]() {
-        POP_STACK(1);
-        attd.place = parserUtil::lookup(att1.name, symbolTable);
-        attd.type = parserUtil::look_up_type(att1.name, symbolTable);
-        attributeStack.push(attd);
-    };
-    auto case35 = [&]() {
-        attd.place = parserUtil::Temp_New(0, tempVariableIndices);
-        attd.type = "int";
-        MAKE_QUAD("=", symbolStack.top(), "-", attd.place);
-        SAVE_STACK(attd);
-    };
-    auto case36 = [&]() {
-        attd.place = parserUtil::Temp_New(1, tempVariableIndices);
-        attd.type = "double";
-        MAKE_QUAD("=", std::to_string(stof(symbolStack.top())), "-",
-                  attd.place);
-        SAVE_STACK(attd);
-    };
-    _GEN_EMPTY_CASE(37);
-    auto case38 = [&]() {
-        POP_STACK(2);
-        attd.place = parserUtil::Temp_New(OpKeyMap::typr_to_int.at(att1.type),
-                                          tempVariableIndices);
-        attd.type = att1.type;
-        MAKE_QUAD(att2.op, "0", att1.place, attd.place);
-        SAVE_STACK(attd);
-    };
-    auto case39 = [&]() {
-        POP_STACK(3);
-        parserUtil::backpatch(att3.falselist, att2.quad, quadruples);
-        attd.truelist =
-            parserUtil::merge(att3.truelist, att1.truelist, quadruples);
-        attd.falselist = att1.falselist;
-        attributeStack.push(attd);
-    };
-    _GEN_EMPTY_CASE(40);
-    auto case41 = [&]() {
-        POP_STACK(3);
-        parserUtil::backpatch(att3.truelist, att2.quad, quadruples);
-        attd.falselist =
-            parserUtil::merge(att3.falselist, att1.falselist, quadruples);
-        attd.truelist = att1.truelist;
-        attributeStack.push(attd);
-    };
-    _GEN_EMPTY_CASE(42);
-    _GEN_EMPTY_CASE(43);
-    auto case44 = [&]() {
-        POP_STACK(1);
-        attd.falselist = att1.truelist;
-        attd.truelist = att1.falselist;
-        attributeStack.push(attd);
-    };
-    auto case45 = [&]() {
-        POP_STACK(3);
-        attd.truelist = nxt;
-        attd.falselist = nxt + 1;
-        MAKE_QUAD("j" + att2.op, att3.place, att1.place, "0");
-        quadruples.push_back(qt);
-        nxt++;
-        MAKE_QUAD("j", "-", "-", "0");
-        SAVE_STACK(attd);
-    };
-    auto case46 = [&]() {
-        POP_STACK(1);
-        attd.truelist = nxt;
-        attd.falselist = nxt + 1;
-        MAKE_QUAD("jnz", att1.place, "-", "0");
-        quadruples.push_back(qt);
-        nxt++;
-        MAKE_QUAD("j", "-", "-", "0");
-        SAVE_STACK(attd);
-    };
-    auto case47 = [&]() {
-        attd.place = parserUtil::Temp_New(0, tempVariableIndices);
-        attd.type = "int";
-        MAKE_QUAD("=", symbolStack.top(), "-", attd.place);
-        SAVE_STACK(attd);
-    };
-    auto case48 = [&]() {
-        attd.place = parserUtil::Temp_New(1, tempVariableIndices);
-        attd.type = "double";
-        MAKE_QUAD("=", std::to_string(stof(symbolStack.top())), "-",
-                  attd.place);
-        SAVE_STACK(attd);
-    };
-    auto case49 = [&]() {
-        POP_STACK(1);
-        attd.place = parserUtil::lookup(att1.name, symbolTable);
-        attd.type = parserUtil::look_up_type(att1.name, symbolTable);
-        attributeStack.push(attd);
-    };
-    _GEN_SYM_CASE(50, "+");
-    _GEN_SYM_CASE(51, "-");
-    _GEN_SYM_CASE(52, "*");
-    _GEN_SYM_CASE(53, "/");
-    _GEN_SYM_CASE(54, "==");
-    _GEN_SYM_CASE(55, "!=");
-    _GEN_SYM_CASE(56, "<");
-    _GEN_SYM_CASE(57, "<=");
-    _GEN_SYM_CASE(58, ">");
-    _GEN_SYM_CASE(59, ">=");
-
-    _GEN_IO_CASE(61, 2, "R");
-    _GEN_IO_CASE(62, 1, "R");
-    _GEN_IO_CASE(64, 1, "W");
-    _GEN_IO_CASE(65, 2, "W");
-
-    _GEN_EMPTY_CASE(60);
-    _GEN_EMPTY_CASE(63);
-    _GEN_EMPTY_CASE(66);
-    _GEN_EMPTY_CASE(67);
-
-    auto reduce = [&](int idx) {
-        // Initialize attribute structures to store data during parsing
-        clear_attributes();
-
-#define MIN_CASE_VALUE 2
-#define MAX_CASE_VALUE 65
-
-        std::vector<std::function<void()>> switchFunc = {
-            case0,  case1,  case2,  case3,  case4,  case5,  case6,  case7,
-            case8,  case9,  case11, case11, case14, case14, case14, case15,
-            case16, case17, case18, case19, case20, case21, case22, case23,
-            case24, case25, case26, case27, case28, case29, case30, case31,
-            case32, case33, case34, case35, case36, case37, case38, case39,
-            case40, case41, case42, case43, case44, case45, case46, case47,
-            case48, case49, case50, case51, case52, case53, case54, case55,
-            case56, case57, case58, case59, case60, case61, case62, case63,
-            case64, case65, case66, case67};
-
-        // Execute the corresponding case if the index is valid
-        if (idx >= MIN_CASE_VALUE && idx <= MAX_CASE_VALUE &&
-            switchFunc[idx] != nullptr) {
-            switchFunc[idx]();  // Call the corresponding case function
-        }
+    advance();
+
+    // The action of a state on the lookahead; a state with a default
+    // reduction takes it wherever the table has no entry
+    auto action = [&](int state) {
+        int act = gotoTable[state][nxtsymbol];
+        return act ? act : -defaultReductions[state];
     };
-    int cur = 0;  // Initialize current index for processing temp elements
 
 #ifdef DEBUG
     int dbg_cnt = 0;
@@ -743,26 +1014,8 @@ std::vector<std::string> Parser::parser(std::vector<std::string>& res) {
 
     // Start parsing loop
     while (true) {
-        auto [x, y] = temp[cur];  // Get current element from temp (x is the
-                                  // symbol, y is its type)
-        int nxtsymbol{};          // Initialize the next symbol identifier
-
-        // Determine the symbol ID based on its type (IDENT, INT, DOUBLE, etc.)
-        if (y == "IDENT") {
-            nxtsymbol =
-                symbolToIdMap["id"];  // Map IDENT to corresponding symbol ID
-        } else if (y == "INT") {
-            nxtsymbol = symbolToIdMap["UINT"];  // Map INT to UINT ID
-        } else if (y == "DOUBLE") {
-            nxtsymbol = symbolToIdMap["UFLOAT"];  // Map DOUBLE to UFLOAT ID
-        } else {
-            nxtsymbol =
-                symbolToIdMap[x];  // Map any other symbol to its respective ID
-        }
-
-        // Retrieve the action to be taken (goto state) from the goto table
-        // using the current state and symbol
-        auto to_be_gone = gotoTable[stateStack.top()][nxtsymbol];
+        const std::string& x = token.text;  // The text of the current token
+        auto to_be_gone = action(stateStack.top());
 
         // If the action is -1, it means we are at the end or error state
         if (to_be_gone == -1) {
@@ -771,56 +1024,69 @@ std::vector<std::string> Parser::parser(std::vector<std::string>& res) {
 
         // If no valid action exists for this symbol, report a syntax error
         if (!to_be_gone) {
-            std::cout << "Syntax Error" << "\n";
-            return {"$"};  // Return error code
+            return false;  // Report the error to the caller
         }
 
         // If the action is negative, it indicates a reduction (negative value
         // represents reduction rule index)
         if (to_be_gone < 0) {
-            reduce(-to_be_gone);  // Call the reduce function to apply the
-                                  // corresponding reduction rule
+            const int rule = -to_be_gone;
 
-            // Retrieve the production rule (left-hand side and right-hand side)
-            auto [e1, e2] = flattenedGrammarRules[-to_be_gone - 1];
-            size_t accept_size =
-                e2.size();  // Get the size of the RHS of the rule
-
-            // If the RHS is empty (epsilon rule), set accept_size to 0
-            if (e2[0] == "^") {
-                accept_size = 0;
+            // Call the reduce function to apply the corresponding reduction
+            // rule; a semantic action may reject the program
+            try {
+                if (astBuilder) {
+                    buildNode(rule);
+                } else {
+                    reduce(rule);
+                }
+            } catch (const parserStruct::SyntaxError&) {
+                return false;
             }
 
-            // Pop symbols and states from the stacks based on the reduction's
-            // RHS size
-            for (size_t i = 0; i < accept_size; i++) {
-                stateStack.pop();   // Pop the state stack
-                symbolStack.pop();  // Pop the symbol stack
+            // Pop the states of the rule's right-hand side
+            for (int i = 0; i < ruleLength[rule]; i++) {
+                stateStack.pop();
             }
 
 #ifdef DEBUG
             std::cout << "[DEBUG] reduce#" << ++dbg_cnt
-                      << ": idx = " << -to_be_gone << ", x = " << x
-                      << ", y = " << y << "\n";
+                      << ": idx = " << rule << ", x = " << x
+                      << ", kind = " << static_cast<int>(token.kind) << "\n";
 #endif
 
-            // Push the LHS symbol of the reduction rule to the symbol stack
-            symbolStack.push(e1);
-            // Push the new state corresponding to the LHS symbol to the state
-            // stack
-            stateStack.push(
-                gotoTable[stateStack.top()][symbolToIdMap[symbolStack.top()]]);
+            // Go to the state for the left-hand side. When that state would
+            // only reduce a unit rule with an empty action on this lookahead
+            // (e.g. ITEM -> FACTOR), go to the state for the unit rule's
+            // left-hand side instead, as popping it would
+            int next = gotoTable[stateStack.top()][ruleLhs[rule]];
+            for (int unit = -action(next); unit > 1 && unitRules[unit];
+                 unit = -action(next)) {
+                next = gotoTable[stateStack.top()][ruleLhs[unit]];
+            }
+            stateStack.push(next);
+
+            // Hand the basic blocks that can no longer change to the tracker
+            if (blockTracker) {
+                trackReduction(rule);
+            }
         } else {
             // If the action is positive, it indicates a shift (shift to new
             // state)
             stateStack.push(to_be_gone);  // Push the new state onto the stack
-            symbolStack.push(x);          // Push the symbol onto the stack
-            cur++;  // Move to the next symbol in the input
+            lexeme = x;
+
+            // The ';' after a statement of the outermost block
+            if (boundaryHook && stateStack.size() == BOUNDARY_DEPTH &&
+                x == ";" && boundaryHook()) {
+                return false;
+            }
+            advance();  // Move to the next symbol in the input
         }
     }
+    return true;
+}
 
-    // After parsing is complete, generate the parser output (quadruples, symbol
-    // table, etc.)
-    return generateParserOutput(nxt, quadruples, symbolTable,
-                                tempVariableIndices);
-}
\ No newline at end of file
+// The directly-coded engine lives in this translation unit so that the
+// constant-rule reduce() calls at its reduction sites can be inlined
+#include "parserDirect.inc"
@@ -1,15 +1,37 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include "ast.h"
 #include "expression.h"
+#include "irStruct.h"
+#include "lexerStruct.h"
 #include "parserStruct.h"
 #include <map>
+#include <memory_resource>
+#include <ostream>
+#include <optional>
 #include <set>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <functional>
 
+class BlockTracker;
+class TokenStream;
+
+/**
+ * @brief Orders grammar symbols by their text, so a map keyed by symbol can
+ * be searched with any string type without building a key.
+ */
+struct SymbolLess {
+    using is_transparent = void;
+
+    bool operator()(std::string_view a, std::string_view b) const {
+        return a < b;
+    }
+};
+
 /**
  * @class Parser
  * @brief Encapsulates the entire parsing process, including grammar rules, symbol 
@@ -17,47 +39,303 @@
  */
 class Parser {
 public:
+    /**
+     * @enum Engine
+     * @brief How the LR(1) automaton is executed.
+     */
+    enum class Engine {
+        Table,  ///< Builds the LR(1) table at run time and interprets it.
+        Direct, ///< Runs the generated directly-coded automaton (parserDirect.inc).
+        Descent ///< Hand-written recursive descent with precedence climbing (parserDescent.cpp).
+    };
+
     /**
      * @brief Constructs a Parser object and initializes the necessary components.
+     *
+     * @param engine The parsing engine to use.
+     * @param resource Allocates the grammar, the LR(1) item sets and the
+     * table, e.g. a per-compilation arena; it must outlive the parser.
      */
-    Parser();
+    explicit Parser(Engine engine = Engine::Table,
+                    std::pmr::memory_resource* resource =
+                        std::pmr::get_default_resource());
 
     /**
-     * @brief Main function to process the input and generate parsed output.
-     * 
-     * @param res A reference to a vector of strings containing the input data.
-     * @return A vector of strings representing the parsed output.
+     * @brief Main function to parse the tokens and generate intermediate code.
+     *
+     * @param tokens The tokens produced by the lexer.
+     * @return The module holding the symbol table, temporaries and
+     * quadruples, or std::nullopt on a syntax error.
+     */
+    std::optional<irStruct::Module> parse(
+        const std::vector<lexerStruct::Token>& tokens);
+
+    /**
+     * @brief Parses tokens pulled from a stream as the parser needs them, so
+     * quadruples are produced while the input is still being read.
+     *
+     * @param stream The token stream.
+     * @return The module, or std::nullopt on a syntax error. The stream is
+     * left where the error was found.
+     */
+    std::optional<irStruct::Module> parse(TokenStream& stream);
+
+    /**
+     * @brief Runs the LR(1) parse, calling nextToken whenever a new lookahead
+     * token is needed.
+     *
+     * @param nextToken Fills in the next token; returns false at the end.
+     * @return The module, or std::nullopt on a syntax error.
+     */
+    std::optional<irStruct::Module> parse(
+        const std::function<bool(lexerStruct::Token&)>& nextToken);
+
+    /**
+     * @brief Parses the tokens into an abstract syntax tree instead of
+     * quadruples, with the table-driven engine. ast::lower() translates the
+     * tree into the module parse() would produce.
+     *
+     * @param tokens The tokens produced by the lexer.
+     * @return The tree and symbol table, or std::nullopt on a syntax error.
+     */
+    std::optional<ast::Program> parseAst(
+        const std::vector<lexerStruct::Token>& tokens);
+
+    /**
+     * @brief Checks whether a program is valid without translating it: runs
+     * the table-driven automaton and checks duplicate and undeclared
+     * identifiers and literal ranges, but builds no attributes, quadruples
+     * or temporaries. The tables are built on the first call, so one parser
+     * can check many programs.
+     *
+     * @param tokens The tokens produced by the lexer.
+     * @return bool True if parse() would accept the tokens.
+     */
+    bool recognize(const std::vector<lexerStruct::Token>& tokens);
+
+    /**
+     * @brief Turns constant folding in the semantic actions on or off (off by
+     * default). With folding, literals become immediate operands instead of
+     * temporaries, operations on literals are evaluated at parse time, and a
+     * comparison of literals jumps unconditionally to its outcome.
+     *
+     * @param enabled Whether to fold.
      */
-    std::vector<std::string> parser(std::vector<std::string>& res);
+    void setFolding(bool enabled);
+
+    /**
+     * @brief Reports the basic blocks to a tracker while parsing, so that
+     * code generation can start before the parse ends.
+     *
+     * @param tracker The tracker, or nullptr to stop reporting.
+     */
+    void setBlockTracker(BlockTracker* tracker);
+
+    /**
+     * @brief Returns the symbol table in IR form. It is complete once the
+     * first quadruple has been produced.
+     *
+     * @return The declared variables, indexed by TB.
+     */
+    std::vector<irStruct::SymbolEntry> symbols() const;
+
+    /**
+     * @brief Writes the directly-coded parser for OpKeyMap::language: one
+     * labelled block per LR(1) state, with shifts, reductions and gotos as
+     * direct jumps and each reduction's semantic action called with a
+     * constant rule number. The output is the contents of parserDirect.inc.
+     *
+     * @param os The stream to write the C++ code to.
+     */
+    void writeDirectParser(std::ostream& os);
 
 private:
+    friend class IncrementalParser;
+    friend class ParallelParser;
+
     int parserState; ///< Tracks the current state of the parser.
 
-    std::map<std::string, int> symbolToIdMap; ///< Maps symbols to integer IDs for efficient lookup.
+    Engine engine; ///< The parsing engine used by parse().
 
-    std::vector<std::vector<int>> gotoTable; ///< LR(1) parsing table defining state transitions.
+    std::pmr::memory_resource* resource; ///< Allocates the containers below.
 
-    std::map<std::string, std::set<std::string>> firstSets; ///< Stores first sets for grammar symbols.
+    std::pmr::map<std::pmr::string, int, SymbolLess> symbolToIdMap; ///< Maps symbols to integer IDs for efficient lookup.
 
-    std::map<std::string, std::vector<std::pair<std::vector<std::string>, int>>> grammarRules; 
+    std::pmr::vector<std::pmr::vector<int>> gotoTable; ///< LR(1) parsing table defining state transitions.
+
+    std::pmr::map<std::pmr::string, std::pmr::set<std::pmr::string>, SymbolLess> firstSets; ///< Stores first sets for grammar symbols.
+
+    std::pmr::map<std::pmr::string, std::pmr::vector<std::pair<std::pmr::vector<std::pmr::string>, int>>, SymbolLess> grammarRules; 
     ///< Contains grammar rules with non-terminal symbols and their production rules.
 
-    std::vector<std::pair<std::string, std::vector<std::string>>> flattenedGrammarRules; 
+    std::pmr::vector<std::pair<std::pmr::string, std::pmr::vector<std::pmr::string>>> flattenedGrammarRules; 
     ///< Stores flattened grammar rules for easier parsing operations.
 
-    std::vector<std::set<Expression>> itemSets; ///< Item sets used for LR parsing.
+    std::pmr::vector<std::pmr::set<Expression>> itemSets; ///< Item sets used for LR parsing.
+
+    std::vector<int> ruleLhs; ///< Symbol ID of each rule's left-hand side, by rule number.
 
-    std::stack<parserStruct::Attribute> attributeStack; ///< Stack of attributes for semantic analysis.
+    std::vector<int> ruleLength; ///< Number of symbols each rule pops, by rule number.
 
-    std::vector<parserStruct::Symbol> symbolTable; ///< Symbol table for terminals and non-terminals.
+    std::vector<bool> unitRules; ///< Rules A -> B with an empty action, which the parse loop bypasses.
+
+    std::vector<int> defaultReductions; ///< Default reduction rule of each state, or 0.
+
+    parserStruct::AttributeStack attributeStack; ///< Stack of attributes for semantic analysis.
+
+    std::pmr::vector<parserStruct::Symbol> symbolTable; ///< Symbol table for terminals and non-terminals.
 
     std::stack<int> stateStack; ///< Tracks parser states during parsing.
 
-    std::stack<std::string> symbolStack; ///< Tracks symbols used in parsing operations.
+    irStruct::QuadList quadruples; ///< Intermediate code generated during parsing.
+
+    std::vector<irStruct::ValueType> tempVariableIndices; ///< Types of the temporary variables, by index.
+
+    BlockTracker* blockTracker = nullptr; ///< Receives the basic blocks while parsing, if set.
+
+    bool folding = false; ///< Whether the semantic actions fold constants.
+
+    int offset = 0; ///< Offset of the next declared variable.
+
+    int nxt = 0; ///< Number of the next quadruple.
+
+    std::string lexeme; ///< Text of the last token shifted.
+
+    class AstBuilder;
+
+    /// Builds the tree instead of running the semantic actions, if set.
+    AstBuilder* astBuilder = nullptr;
+
+    /**
+     * @brief Adds the node of a reduction to the tree being built.
+     *
+     * @param rule The rule number.
+     * @throws parserStruct::SyntaxError If the program is rejected.
+     */
+    void buildNode(int rule);
+
+    /// Called by the table-driven loop after it shifts the ';' that ends a
+    /// statement of the outermost block; returning true pauses the parse.
+    std::function<bool()> boundaryHook;
+
+    /**
+     * @brief Builds the LR(1) table and the rule summaries, once per parser.
+     */
+    void buildTables();
+
+    /**
+     * @brief Clears the stacks, symbol table, quadruples and temporaries a
+     * previous parse left, so one parser can parse many programs.
+     */
+    void reset();
+
+    /**
+     * @brief Runs the table-driven loop from the current parser state until
+     * the input is accepted, rejected or the boundary hook pauses it.
+     *
+     * @param nextToken Fills in the next token; returns false at the end.
+     * @return bool True if the input was accepted.
+     */
+    bool runTable(const std::function<bool(lexerStruct::Token&)>& nextToken);
+
+    /**
+     * @brief Runs the semantic action of a grammar rule.
+     *
+     * @param rule The rule number, counted from 1 in OpKeyMap::language.
+     * @throws parserStruct::SyntaxError If the action rejects the program.
+     */
+    void reduce(int rule);
+
+    /**
+     * @brief Folds an operation of a semantic action when folding is on.
+     *
+     * @param op The operation.
+     * @param a The first operand.
+     * @param b The second operand, or "-".
+     * @return The literal result, or std::nullopt if the operation has to be
+     * emitted.
+     */
+    std::optional<irStruct::Operand> foldConstant(
+        irStruct::OpCode op,
+        const irStruct::Operand& a,
+        const irStruct::Operand& b) const;
+
+    /**
+     * @brief Stores a literal in a new temporary, as the literal's own action
+     * does without folding.
+     *
+     * @param place A place.
+     * @return The temporary, or the place itself if it is no literal.
+     */
+    irStruct::Operand materialize(const irStruct::Operand& place);
+
+    /**
+     * @enum RuleCheck
+     * @brief How the semantic action of a rule can reject a program. reduce()
+     * checks as part of the action, recognize() checks alone.
+     */
+    enum class RuleCheck {
+        None,          ///< The action accepts any program.
+        Name,          ///< ID -> id: names the identifier of the next check.
+        Declare,       ///< Declares the identifier; rejects a redeclaration.
+        Lookup,        ///< Uses the identifier; rejects an undeclared one.
+        DoubleLiteral  ///< Rejects a double literal outside float.
+    };
+
+    /**
+     * @brief Tells how the semantic action of a rule can reject a program.
+     *
+     * @param rule The rule number.
+     * @return The check the action makes.
+     */
+    static RuleCheck ruleCheck(int rule);
 
-    std::vector<parserStruct::QuadTuple> quadruples; ///< Intermediate code generated during parsing.
+    /**
+     * @brief Tells whether the semantic action of a rule does nothing.
+     *
+     * @param rule The rule number.
+     * @return True if reduce() leaves the attribute stack unchanged.
+     */
+    static bool hasEmptyAction(int rule);
+
+    /**
+     * @brief Reports a reduction to the block tracker.
+     *
+     * @param rule The rule number.
+     */
+    void trackReduction(int rule);
 
-    std::vector<int> tempVariableIndices; ///< Tracks indices for temporary variables.
+    /**
+     * @brief Runs the directly-coded LR(1) parser generated into
+     * parserDirect.inc. It behaves exactly like the table-driven parse.
+     *
+     * @param nextToken Fills in the next token; returns false at the end.
+     * @return The module, or std::nullopt on a syntax error.
+     */
+    std::optional<irStruct::Module> parseDirect(
+        const std::function<bool(lexerStruct::Token&)>& nextToken);
+
+    class Descent;
+
+    /**
+     * @brief Runs the recursive-descent parser. It needs no tables and runs
+     * the semantic actions in the same order as the LR(1) parser, so its
+     * results are identical. Nesting depth is limited by the call stack.
+     *
+     * @param nextToken Fills in the next token; returns false at the end.
+     * @return The module, or std::nullopt on a syntax error.
+     */
+    std::optional<irStruct::Module> parseDescent(
+        const std::function<bool(lexerStruct::Token&)>& nextToken);
+
+    /**
+     * @brief Backpatches a jump list and reports the patched jumps to the
+     * block tracker.
+     *
+     * @param list The head of the jump list.
+     * @param target The target quadruple.
+     */
+    void patch(int list, int target);
 
     /**
      * @brief Computes the suffix for a given expression.
@@ -65,7 +343,7 @@ private:
      * @param I An Expression object.
      * @return A set of strings representing the suffix.
      */
-    std::set<std::string> compute_suffix(const Expression& I);
+    std::pmr::set<std::pmr::string> compute_suffix(const Expression& I);
 
     /**
      * @brief Adds the closure of a non-terminal for an expression to the given set.
@@ -75,8 +353,8 @@ private:
      * @param cur_str The current string being processed.
      */
     void add_non_terminal_closure(const Expression& I,
-                                  std::set<Expression>& pre,
-                                  const std::string& cur_str);
+                                  std::pmr::set<Expression>& pre,
+                                  const std::pmr::string& cur_str);
 
     /**
      * @brief Computes the closure of a set of Expressions.
@@ -84,26 +362,34 @@ private:
      * @param cur A set of Expressions to compute the closure for.
      * @return A set of Expressions representing the closure.
      */
-    std::set<Expression> get_closure(const std::set<Expression>& cur);
+    std::pmr::set<Expression> get_closure(
+        const std::pmr::set<Expression>& cur);
 
     /**
      * @brief Initializes the mapping of symbols to IDs.
      */
     void init_symbol_mapping();
 
+    /**
+     * @brief Looks up the ID of a grammar symbol. A symbol missing from
+     * OpKeyMap is added with ID 0, as the table has always given it.
+     *
+     * @param symbol The symbol.
+     * @return int Its ID.
+     */
+    int symbolId(std::string_view symbol);
+
     /**
      * @brief Parses and processes the expressions from the input data.
      * 
      * @param tmp A vector of strings containing the input expressions.
      */
-    void parse_expressions(std::vector<std::string>& tmp);
+    void parse_expressions(const std::vector<std::string>& tmp);
 
     /**
      * @brief Computes the first set for grammar symbols.
-     * 
-     * @param tmp A vector of strings representing the symbols.
      */
-    void compute_first_set(std::vector<std::string>& tmp);
+    void compute_first_set();
 
     /**
      * @brief Retrieves LR(1) item sets and associated symbols.
@@ -111,7 +397,9 @@ private:
      * @param idx The index of the current item set.
      * @return A pair containing the item sets and associated symbols.
      */
-    std::pair<std::vector<std::set<Expression>>, std::vector<std::string>> get_Items(int idx);
+    std::pair<std::pmr::vector<std::pmr::set<Expression>>,
+              std::pmr::vector<std::pmr::string>>
+    get_Items(int idx);
 
     /**
      * @brief Generates the LR parsing table.
@@ -119,19 +407,18 @@ private:
     void get_LR_table();
 
     /**
-     * @brief Generates the parser's output based on intermediate results.
-     * 
-     * @param nxt The next state index.
-     * @param quadruples A vector of QuadTuple objects representing intermediate code.
-     * @param symbolTable A vector of Symbol objects for the parsed symbols.
-     * @param tempVariableIndices A vector of integers for temporary variable indices.
-     * @return A vector of strings representing the parser's output.
-     */
-    std::vector<std::string> generateParserOutput(
-        int nxt,
-        const std::vector<parserStruct::QuadTuple>& quadruples,
-        const std::vector<parserStruct::Symbol>& symbolTable,
-        const std::vector<int>& tempVariableIndices);
+     * @brief Derives the per-rule summaries used by the parse loop and the
+     * per-state default reductions from the LR parsing table.
+     */
+    void compress_LR_table();
+
+    /**
+     * @brief Moves the parse results (symbol table, temporaries and resolved
+     * quadruples) into an IR module.
+     *
+     * @return The module describing the parsed program.
+     */
+    irStruct::Module buildModule();
 };
 
 #endif  // PARSER_H
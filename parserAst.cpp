@@ -0,0 +1,263 @@
+#include "parser.h"
+#include "parserUtil.h"
+
+// Builds the tree in AST mode. It takes the place of reduce(): every rule
+// that would emit quadruples appends a node instead, and the declarations
+// fill the symbol table as usual. The values of the symbols on the parse
+// stack (node indices, operators and types) are kept on a stack of ints.
+class Parser::AstBuilder {
+public:
+    explicit AstBuilder(Parser& parser) : parser(parser) {}
+
+    ast::Tree tree;
+
+    void reduce(int rule) {
+        switch (rule) {
+            case 2:  // SUBPROG -> M VARIABLES STATEMENT
+                tree.root = pop();
+                values.resize(values.size() - 2);
+                break;
+            case 3:  // M
+                parser.offset = 0;
+                values.push_back(-1);
+                break;
+            case 4:  // N
+                values.push_back(-1);
+                break;
+            case 5:  // VARIABLES -> VARIABLES VARIABLE ;
+                values.pop_back();
+                break;
+            case 7:  // T -> int | double
+            case 8:
+                values.push_back(rule == 7 ? 0 : 1);
+                break;
+            case 9:  // ID -> id
+                names.push_back(parser.lexeme);
+                break;
+            case 10:  // VARIABLE -> T ID | VARIABLE , ID
+            case 11:
+                declare(values.back());
+                break;
+            case 15:  // STATEMENT -> ^
+                values.push_back(tree.add(ast::Kind::Empty));
+                break;
+            case 16:  // STATEMENT -> { L ; }
+                openBlock();
+                values.back() = closeRun(ast::Kind::Block);
+                break;
+            case 17: {  // STATEMENT -> while N B do N STATEMENT
+                const int body = pop();
+                values.pop_back();
+                const int condition = pop();
+                values.back() = tree.add(ast::Kind::While, condition, body);
+                break;
+            }
+            case 18: {  // STATEMENT -> if B then N STATEMENT
+                const int body = pop();
+                values.pop_back();
+                const int condition = pop();
+                values.push_back(tree.add(ast::Kind::If, condition, body));
+                break;
+            }
+            case 19: {  // ASSIGN -> ID = EXPR
+                const int value = pop();
+                values.push_back(tree.add(ast::Kind::Assign, symbol(), value));
+                break;
+            }
+            case 20: {  // L -> L ; N STATEMENT
+                const int statement = pop();
+                values.pop_back();
+                openBlock();
+                runs.back().push_back(statement);
+                break;
+            }
+            case 22:  // EXPR -> EXPR || ORITEM
+            case 24:  // ORITEM -> ORITEM && ANDITEM
+                binary(ast::Kind::Binary, rule == 22 ? irStruct::OpCode::Or
+                                                     : irStruct::OpCode::And);
+                break;
+            case 27:  // ANDITEM -> ! NOITEM
+                values.back() = tree.add(ast::Kind::Not, values.back());
+                break;
+            case 28:  // Binary operators with an operator nonterminal
+            case 30:
+            case 33: {
+                const int right = pop();
+                const auto op = static_cast<irStruct::OpCode>(pop());
+                binaryWith(ast::Kind::Binary, op, right);
+                break;
+            }
+            case 34:  // FACTOR -> ID, BFACTOR -> ID
+            case 49:
+                values.push_back(tree.add(ast::Kind::Symbol, symbol()));
+                break;
+            case 35:  // Integer literals
+            case 47:
+                literal(parserUtil::intLiteral(parser.lexeme));
+                break;
+            case 36:  // Double literals
+            case 48:
+                literal(irStruct::Operand::immDouble(stof(parser.lexeme)));
+                break;
+            case 38: {  // FACTOR -> PLUS_MINUS FACTOR
+                const int operand = pop();
+                const auto op = static_cast<irStruct::OpCode>(pop());
+                values.push_back(tree.add(ast::Kind::Unary, operand, -1, op));
+                break;
+            }
+            case 39: {  // B -> B || N BORTERM
+                const int right = pop();
+                values.pop_back();
+                values.back() =
+                    tree.add(ast::Kind::CondOr, values.back(), right);
+                break;
+            }
+            case 41: {  // BORTERM -> BORTERM && N BANDTERM
+                const int right = pop();
+                values.pop_back();
+                values.back() =
+                    tree.add(ast::Kind::CondAnd, values.back(), right);
+                break;
+            }
+            case 44:  // BANDTERM -> ! BANDTERM
+                values.back() = tree.add(ast::Kind::CondNot, values.back());
+                break;
+            case 45: {  // BANDTERM -> BFACTOR REL BFACTOR
+                const int right = pop();
+                const auto op = static_cast<irStruct::OpCode>(pop());
+                binaryWith(ast::Kind::Compare, op, right);
+                break;
+            }
+            case 46:  // BANDTERM -> BFACTOR
+                values.back() = tree.add(ast::Kind::Test, values.back());
+                break;
+            case 50:  // Operator nonterminals, in OpCode order
+            case 51:
+            case 52:
+            case 53:
+            case 54:
+            case 55:
+            case 56:
+            case 57:
+            case 58:
+            case 59:
+                values.push_back(static_cast<int>(irStruct::OpCode::Add) +
+                                 rule - 50);
+                break;
+            case 60:  // SCANF -> SCANF_BEGIN )
+            case 63:  // PRINTF -> PRINTF_BEGIN )
+                values.back() = closeRun(rule == 60 ? ast::Kind::Read
+                                                    : ast::Kind::Write);
+                break;
+            case 61:  // SCANF_BEGIN -> SCANF_BEGIN , ID
+            case 65:  // PRINTF_BEGIN -> PRINTF_BEGIN , ID
+                runs.back().push_back(symbol());
+                break;
+            case 62:  // SCANF_BEGIN -> scanf ( ID
+            case 64:  // PRINTF_BEGIN -> printf ( ID
+                runs.push_back({symbol()});
+                values.push_back(-1);
+                break;
+        }
+    }
+
+private:
+    Parser& parser;
+    std::vector<int> values;         // Values of the parse stack's symbols
+    std::vector<std::string> names;  // IDs not yet used by a rule
+    std::vector<std::vector<std::int32_t>> runs;  // Open blocks and lists
+
+    int pop() {
+        const int value = values.back();
+        values.pop_back();
+        return value;
+    }
+
+    // Looks up the last ID, which must be declared
+    int symbol() {
+        const int index = parserUtil::lookup(names.back(), parser.symbolTable)
+                              .index;
+        names.pop_back();
+        return index;
+    }
+
+    // Declares the last ID, as reduce() does for VARIABLE
+    void declare(int type) {
+        for (const auto& symbol : parser.symbolTable) {
+            if (symbol.name == names.back()) {
+                throw parserStruct::SyntaxError();
+            }
+        }
+        parser.symbolTable.emplace_back(names.back(),
+                                        type == 0 ? "int" : "double",
+                                        parser.offset);
+        parser.offset += type == 0 ? 4 : 8;
+        names.pop_back();
+    }
+
+    void literal(const irStruct::Operand& value) {
+        tree.literals.push_back(value);
+        values.push_back(tree.add(ast::Kind::Literal,
+                                  static_cast<int>(tree.literals.size()) - 1));
+    }
+
+    void binary(ast::Kind kind, irStruct::OpCode op) {
+        const int right = pop();
+        binaryWith(kind, op, right);
+    }
+
+    void binaryWith(ast::Kind kind, irStruct::OpCode op, int right) {
+        values.back() = tree.add(kind, values.back(), right, op);
+    }
+
+    // L -> STATEMENT is bypassed by the parse loop, so L's value is its
+    // first statement until a second one opens a run (-1) for the block
+    void openBlock() {
+        if (values.back() != -1) {
+            runs.push_back({values.back()});
+            values.back() = -1;
+        }
+    }
+
+    // Moves the innermost open run into the tree as a node's children
+    int closeRun(ast::Kind kind) {
+        const int start = static_cast<int>(tree.lists.size());
+        tree.lists.insert(tree.lists.end(), runs.back().begin(),
+                          runs.back().end());
+        runs.pop_back();
+        return tree.add(kind, start, static_cast<int>(tree.lists.size()));
+    }
+};
+
+void Parser::buildNode(int rule) {
+    astBuilder->reduce(rule);
+}
+
+std::optional<ast::Program> Parser::parseAst(
+    const std::vector<lexerStruct::Token>& tokens) {
+    buildTables();
+    reset();
+    stateStack.push(0);
+
+    size_t position = 0;
+    auto nextToken = [&](lexerStruct::Token& token) {
+        if (position == tokens.size()) {
+            return false;
+        }
+        token = tokens[position++];
+        return true;
+    };
+
+    AstBuilder builder(*this);
+    astBuilder = &builder;
+    const bool accepted = runTable(nextToken);
+    astBuilder = nullptr;
+    if (!accepted) {
+        return std::nullopt;
+    }
+
+    ast::Program program;
+    program.tree = std::move(builder.tree);
+    program.symbols = symbols();
+    return program;
+}
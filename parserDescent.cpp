@@ -0,0 +1,367 @@
+#include "parser.h"
+#include <array>
+
+// The recursive-descent engine. It runs the rules' semantic actions in the
+// order the LR(1) parser reduces them, i.e. in postorder of the parse tree:
+// a rule's action runs once all of its right-hand side has been parsed, and
+// an N marker's action runs when the parser reaches its position. Left
+// recursive rules become loops that reduce after every repetition, so the
+// quadruples, temporaries and jump lists come out exactly the same.
+class Parser::Descent {
+public:
+    Descent(Parser& parser,
+            const std::function<bool(lexerStruct::Token&)>& nextToken)
+        : parser(parser), nextToken(nextToken) {
+        advance();
+    }
+
+    // SUBPROG -> M VARIABLES STATEMENT, followed by the end of the input
+    void program() {
+        reduce(3);
+        if (!isType()) {
+            throw parserStruct::SyntaxError();
+        }
+        variables();
+        reduce(6);
+        while (isType()) {
+            variables();
+            reduce(5);
+        }
+        statement();
+        reduce(2);
+        if (!atEnd) {
+            throw parserStruct::SyntaxError();
+        }
+    }
+
+private:
+    // A binary operator level of EXPR: unit and binary rule, and the rule
+    // that turns the operator into its own nonterminal (0 if there is none)
+    struct Level {
+        int unitRule;
+        int binaryRule;
+        int (*operatorRule)(const std::string& text);
+    };
+
+    // Rules producing PLUS_MINUS, MUL_DIV and REL from an operator, or 0
+    static int plusMinusRule(const std::string& text) {
+        return text == "+" ? 50 : text == "-" ? 51 : 0;
+    }
+    static int mulDivRule(const std::string& text) {
+        return text == "*" ? 52 : text == "/" ? 53 : 0;
+    }
+    static int relRule(const std::string& text) {
+        static const std::array<const char*, 6> ops{"==", "!=", "<",
+                                                    "<=", ">",  ">="};
+        for (size_t i = 0; i < ops.size(); i++) {
+            if (text == ops[i]) {
+                return 54 + i;
+            }
+        }
+        return 0;
+    }
+    static int orRule(const std::string& text) {
+        return text == "||" ? -1 : 0;
+    }
+    static int andRule(const std::string& text) {
+        return text == "&&" ? -1 : 0;
+    }
+
+    // EXPR -> ORITEM -> ANDITEM -> NOITEM -> RELITEM -> ITEM -> FACTOR, from
+    // the loosest level down. ANDITEM is the prefix level for '!'
+    static constexpr int AND_ITEM = 2;
+    static constexpr std::array<Level, 6> LEVELS{{
+        {23, 22, orRule},         // EXPR -> EXPR || ORITEM
+        {25, 24, andRule},        // ORITEM -> ORITEM && ANDITEM
+        {26, 27, nullptr},        // ANDITEM -> NOITEM | ! NOITEM
+        {29, 28, relRule},        // NOITEM -> NOITEM REL RELITEM
+        {31, 30, plusMinusRule},  // RELITEM -> RELITEM PLUS_MINUS ITEM
+        {32, 33, mulDivRule},     // ITEM -> ITEM MUL_DIV FACTOR
+    }};
+
+    Parser& parser;
+    const std::function<bool(lexerStruct::Token&)>& nextToken;
+    lexerStruct::Token token;  // The lookahead
+    bool atEnd = false;        // The input is exhausted
+
+    void advance() {
+        if (!nextToken(token)) {
+            token = lexerStruct::Token();
+            atEnd = true;
+        }
+    }
+
+    // Shifts the lookahead, keeping its text for the semantic actions
+    void shift() {
+        parser.lexeme = std::move(token.text);
+        advance();
+    }
+
+    // The lookahead is the operator or keyword text
+    bool is(const char* text) const {
+        return !atEnd &&
+               (token.kind == lexerStruct::TokenKind::Operator ||
+                token.kind == lexerStruct::TokenKind::Keyword) &&
+               token.text == text;
+    }
+
+    bool isType() const { return is("int") || is("double"); }
+
+    bool isKind(lexerStruct::TokenKind kind) const {
+        return !atEnd && token.kind == kind;
+    }
+
+    bool isOperator() const {
+        return !atEnd && token.kind == lexerStruct::TokenKind::Operator;
+    }
+
+    void expect(const char* text) {
+        if (!is(text)) {
+            throw parserStruct::SyntaxError();
+        }
+        shift();
+    }
+
+    void reduce(int rule) {
+        if (hasEmptyAction(rule)) {
+            return;
+        }
+        parser.reduce(rule);
+        if (parser.blockTracker) {
+            parser.trackReduction(rule);
+        }
+    }
+
+    // ID -> id
+    void id() {
+        if (!isKind(lexerStruct::TokenKind::Identifier)) {
+            throw parserStruct::SyntaxError();
+        }
+        shift();
+        reduce(9);
+    }
+
+    // VARIABLE ; with VARIABLE -> T ID | VARIABLE , ID
+    void variables() {
+        int rule = is("int") ? 7 : 8;
+        shift();
+        reduce(rule);
+        id();
+        reduce(10);
+        while (is(",")) {
+            shift();
+            id();
+            reduce(11);
+        }
+        expect(";");
+    }
+
+    void statement() {
+        if (isKind(lexerStruct::TokenKind::Identifier)) {
+            // ASSIGN -> ID = EXPR
+            id();
+            expect("=");
+            expression(0);
+            reduce(19);
+            reduce(12);
+        } else if (is("scanf")) {
+            // SCANF -> SCANF_BEGIN )
+            shift();
+            expect("(");
+            id();
+            reduce(62);
+            while (is(",")) {
+                shift();
+                id();
+                reduce(61);
+            }
+            expect(")");
+            reduce(60);
+            reduce(13);
+        } else if (is("printf")) {
+            // PRINTF -> PRINTF_BEGIN )
+            shift();
+            expect("(");
+            id();
+            reduce(64);
+            while (is(",")) {
+                shift();
+                id();
+                reduce(65);
+            }
+            expect(")");
+            reduce(63);
+            reduce(14);
+        } else if (is("{")) {
+            // STATEMENT -> { L ; } with L -> L ; N STATEMENT | STATEMENT
+            shift();
+            statement();
+            reduce(21);
+            expect(";");
+            while (!is("}")) {
+                reduce(4);
+                statement();
+                reduce(20);
+                expect(";");
+            }
+            shift();
+            reduce(16);
+        } else if (is("while")) {
+            // STATEMENT -> while N B do N STATEMENT
+            shift();
+            reduce(4);
+            condition();
+            expect("do");
+            reduce(4);
+            statement();
+            reduce(17);
+        } else if (is("if")) {
+            // STATEMENT -> if B then N STATEMENT
+            shift();
+            condition();
+            expect("then");
+            reduce(4);
+            statement();
+            reduce(18);
+        } else {
+            // STATEMENT -> ^; the caller checks what follows
+            reduce(15);
+        }
+    }
+
+    // Precedence climbing over LEVELS
+    void expression(size_t level) {
+        if (level == LEVELS.size()) {
+            factor();
+            return;
+        }
+        const Level& current = LEVELS[level];
+        if (level == AND_ITEM) {
+            if (is("!")) {
+                shift();
+                expression(level + 1);
+                reduce(current.binaryRule);
+            } else {
+                expression(level + 1);
+                reduce(current.unitRule);
+            }
+            return;
+        }
+
+        expression(level + 1);
+        reduce(current.unitRule);
+        while (isOperator()) {
+            int rule = current.operatorRule(token.text);
+            if (rule == 0) {
+                break;
+            }
+            shift();
+            if (rule > 0) {
+                reduce(rule);
+            }
+            expression(level + 1);
+            reduce(current.binaryRule);
+        }
+    }
+
+    void factor() {
+        if (isKind(lexerStruct::TokenKind::Identifier)) {
+            id();
+            reduce(34);
+        } else if (isKind(lexerStruct::TokenKind::Integer)) {
+            shift();
+            reduce(35);
+        } else if (isKind(lexerStruct::TokenKind::Double)) {
+            shift();
+            reduce(36);
+        } else if (is("(")) {
+            shift();
+            expression(0);
+            expect(")");
+            reduce(37);
+        } else if (isOperator() && plusMinusRule(token.text)) {
+            // FACTOR -> PLUS_MINUS FACTOR
+            int rule = plusMinusRule(token.text);
+            shift();
+            reduce(rule);
+            factor();
+            reduce(38);
+        } else {
+            throw parserStruct::SyntaxError();
+        }
+    }
+
+    // B -> B || N BORTERM | BORTERM
+    void condition() {
+        conditionTerm();
+        reduce(40);
+        while (is("||")) {
+            shift();
+            reduce(4);
+            conditionTerm();
+            reduce(39);
+        }
+    }
+
+    // BORTERM -> BORTERM && N BANDTERM | BANDTERM
+    void conditionTerm() {
+        conditionFactor();
+        reduce(42);
+        while (is("&&")) {
+            shift();
+            reduce(4);
+            conditionFactor();
+            reduce(41);
+        }
+    }
+
+    // BANDTERM -> ( B ) | ! BANDTERM | BFACTOR REL BFACTOR | BFACTOR
+    void conditionFactor() {
+        if (is("(")) {
+            shift();
+            condition();
+            expect(")");
+            reduce(43);
+        } else if (is("!")) {
+            shift();
+            conditionFactor();
+            reduce(44);
+        } else {
+            operand();
+            int rule = isOperator() ? relRule(token.text) : 0;
+            if (rule == 0) {
+                reduce(46);
+                return;
+            }
+            shift();
+            reduce(rule);
+            operand();
+            reduce(45);
+        }
+    }
+
+    // BFACTOR -> UINT | UFLOAT | ID
+    void operand() {
+        if (isKind(lexerStruct::TokenKind::Integer)) {
+            shift();
+            reduce(47);
+        } else if (isKind(lexerStruct::TokenKind::Double)) {
+            shift();
+            reduce(48);
+        } else {
+            id();
+            reduce(49);
+        }
+    }
+};
+
+std::optional<irStruct::Module> Parser::parseDescent(
+    const std::function<bool(lexerStruct::Token&)>& nextToken) {
+    try {
+        Descent descent(*this, nextToken);
+        descent.program();
+    } catch (const parserStruct::SyntaxError&) {
+        return std::nullopt;
+    }
+    return buildModule();
+}
@@ -0,0 +1,170 @@
+#include "parser.h"
+#include "opkeymap.h"
+#include <algorithm>
+#include <map>
+
+// Writes the directly-coded parser. Every action is read back from the
+// finished gotoTable with the same symbol ids the table-driven loop uses, so
+// the generated automaton resolves conflicts and errors exactly like it.
+void Parser::writeDirectParser(std::ostream& os) {
+    buildTables();
+
+    // Terminals get dense numbers of their own, in name order
+    std::vector<std::string> terminals;
+    for (const auto& [name, _] : OpKeyMap::terminal) {
+        if (name != "^") {
+            terminals.push_back(name);
+        }
+    }
+    std::sort(terminals.begin(), terminals.end());
+    std::map<std::string, int> terminalNumber;
+    for (size_t i = 0; i < terminals.size(); i++) {
+        terminalNumber[terminals[i]] = i;
+    }
+
+    const size_t stateCount = itemSets.size();
+    std::vector<bool> targeted(stateCount, false);
+    std::set<std::string> reducedTo;
+    for (size_t state = 0; state < stateCount; state++) {
+        for (const auto& [name, id] : symbolToIdMap) {
+            int action = gotoTable[state][id];
+            if (action > 0) {
+                targeted[action] = true;
+            } else if (action < -1) {
+                reducedTo.emplace(flattenedGrammarRules[-action - 1].first);
+            }
+        }
+    }
+
+    os << "// Directly-coded LR(1) parser for OpKeyMap::language.\n"
+       << "// Generated by `./Main --gen-parser > parserDirect.inc`; do not "
+          "edit.\n"
+       << "// " << stateCount << " states, " << flattenedGrammarRules.size()
+       << " rules.\n\n"
+       << "namespace {\n\n"
+       << "// Returns the generated terminal number of a token, or -1\n"
+       << "int directTerminal(const lexerStruct::Token& token) {\n"
+       << "    static const std::unordered_map<std::string, int> numbers{\n";
+    for (const auto& name : terminals) {
+        if (name != "id" && name != "UINT" && name != "UFLOAT") {
+            os << "        {\"" << name << "\", " << terminalNumber[name]
+               << "},\n";
+        }
+    }
+    os << "    };\n"
+       << "    switch (token.kind) {\n"
+       << "        case lexerStruct::TokenKind::Identifier:\n"
+       << "            return " << terminalNumber["id"] << ";\n"
+       << "        case lexerStruct::TokenKind::Integer:\n"
+       << "            return " << terminalNumber["UINT"] << ";\n"
+       << "        case lexerStruct::TokenKind::Double:\n"
+       << "            return " << terminalNumber["UFLOAT"] << ";\n"
+       << "        default: {\n"
+       << "            auto it = numbers.find(token.text);\n"
+       << "            return it == numbers.end() ? -1 : it->second;\n"
+       << "        }\n"
+       << "    }\n"
+       << "}\n\n"
+       << "}  // namespace\n\n"
+       << "std::optional<irStruct::Module> Parser::parseDirect(\n"
+       << "    const std::function<bool(lexerStruct::Token&)>& nextToken) {\n"
+       << "    std::vector<int> states{0};\n"
+       << "    lexerStruct::Token token;\n"
+       << "    int terminal = 0;\n"
+       << "    auto advance = [&]() {\n"
+       << "        if (!nextToken(token)) {\n"
+       << "            token = lexerStruct::Token(\n"
+       << "                \"#\", lexerStruct::TokenKind::Operator);\n"
+       << "        }\n"
+       << "        terminal = directTerminal(token);\n"
+       << "    };\n"
+       << "    advance();\n\n"
+       << "    try {\n";
+
+    for (size_t state = 0; state < stateCount; state++) {
+        // Group the terminals that share an action; the default reduction
+        // becomes the default label
+        const int fallback = -defaultReductions[state];
+        std::map<int, std::vector<std::string>> actions;
+        for (const auto& name : terminals) {
+            int action = gotoTable[state][symbolId(name)];
+            if (action != 0 && action != fallback) {
+                actions[action].push_back(name);
+            }
+        }
+        if (fallback != 0) {
+            actions[fallback];
+        }
+
+        if (targeted[state]) {
+            os << "    state" << state << ":\n";
+        }
+        os << "        switch (terminal) {\n";
+        for (const auto& [action, names] : actions) {
+            for (const auto& name : names) {
+                os << "            case " << terminalNumber[name] << ":  // "
+                   << name << "\n";
+            }
+            if (action == fallback) {
+                os << "            default:\n";
+            }
+            if (action == -1) {
+                os << "                goto accept;\n";
+            } else if (action > 0) {
+                os << "                states.push_back(" << action << ");\n"
+                   << "                lexeme = token.text;\n"
+                   << "                advance();\n"
+                   << "                goto state" << action << ";\n";
+            } else {
+                const int rule = -action;
+                const auto& [lhs, rhs] = flattenedGrammarRules[rule - 1];
+                const size_t length = rhs[0] == "^" ? 0 : rhs.size();
+                // A unit rule with an empty action only changes the state
+                if (unitRules[rule]) {
+                    os << "                states.pop_back();\n"
+                       << "                goto goto_" << lhs << ";\n";
+                    continue;
+                }
+                os << "                reduce(" << rule << ");\n";
+                if (length > 0) {
+                    os << "                states.resize(states.size() - "
+                       << length << ");\n";
+                }
+                os << "                if (blockTracker) {\n"
+                   << "                    trackReduction(" << rule << ");\n"
+                   << "                }\n"
+                   << "                goto goto_" << lhs << ";\n";
+            }
+        }
+        if (fallback == 0) {
+            os << "            default:\n"
+               << "                return std::nullopt;\n";
+        }
+        os << "        }\n";
+    }
+
+    // Gotos on the nonterminal a reduction produced
+    for (const auto& lhs : reducedTo) {
+        os << "    goto_" << lhs << ":\n"
+           << "        switch (states.back()) {\n";
+        const int id = symbolId(lhs);
+        for (size_t state = 0; state < stateCount; state++) {
+            int target = gotoTable[state][id];
+            if (target > 0) {
+                os << "            case " << state << ":\n"
+                   << "                states.push_back(" << target << ");\n"
+                   << "                goto state" << target << ";\n";
+            }
+        }
+        os << "            default:\n"
+           << "                return std::nullopt;\n"
+           << "        }\n";
+    }
+
+    os << "    accept:\n"
+       << "        return buildModule();\n"
+       << "    } catch (const parserStruct::SyntaxError&) {\n"
+       << "        return std::nullopt;\n"
+       << "    }\n"
+       << "}\n";
+}
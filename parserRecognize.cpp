@@ -0,0 +1,105 @@
+#include "parser.h"
+#include "parserUtil.h"
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+
+// The recognizer runs the table-driven automaton without the semantic
+// actions. Of those, only the declaration and lookup of identifiers and the
+// range checks of literals can reject a program; they are redone here on the
+// token texts alone, with a hash set of the declared names.
+bool Parser::recognize(const std::vector<lexerStruct::Token>& tokens) {
+    buildTables();
+
+    // Symbol IDs of the token classes; an unknown operator gets ID 0, as
+    // the table-driven loop gives it
+    const int idSymbol = symbolToIdMap.at("id");
+    const int intSymbol = symbolToIdMap.at("UINT");
+    const int doubleSymbol = symbolToIdMap.at("UFLOAT");
+    const int endSymbol = symbolToIdMap.at("#");
+    auto symbolOf = [&](const lexerStruct::Token& token) {
+        switch (token.kind) {
+            case lexerStruct::TokenKind::Identifier:
+                return idSymbol;
+            case lexerStruct::TokenKind::Integer:
+                return intSymbol;
+            case lexerStruct::TokenKind::Double:
+                return doubleSymbol;
+            default: {
+                auto it = symbolToIdMap.find(token.text);
+                return it == symbolToIdMap.end() ? 0 : it->second;
+            }
+        }
+    };
+
+    size_t position = 0;
+    int symbol = 0;
+    auto advance = [&]() {
+        symbol = position < tokens.size() ? symbolOf(tokens[position])
+                                          : endSymbol;
+    };
+    advance();
+    auto action = [&](int state) {
+        int act = gotoTable[state][symbol];
+        return act ? act : -defaultReductions[state];
+    };
+
+    std::vector<int> states{0};
+    std::vector<std::string_view> names;  // IDs not yet used by a rule
+    std::unordered_set<std::string_view> declared;
+    std::string_view lastShifted;
+
+    while (true) {
+        const int act = action(states.back());
+        if (act == -1) {
+            return true;
+        }
+        if (act == 0) {
+            return false;
+        }
+        if (act > 0) {
+            states.push_back(act);
+            lastShifted = tokens[position++].text;
+            advance();
+            continue;
+        }
+
+        const int rule = -act;
+        switch (ruleCheck(rule)) {
+            case RuleCheck::None:
+                break;
+            case RuleCheck::Name:
+                names.push_back(lastShifted);
+                break;
+            case RuleCheck::Declare:
+                if (!declared.insert(names.back()).second) {
+                    return false;
+                }
+                names.pop_back();
+                break;
+            case RuleCheck::Lookup:
+                if (!declared.count(names.back())) {
+                    return false;
+                }
+                names.pop_back();
+                break;
+            case RuleCheck::DoubleLiteral:
+                try {
+                    std::stof(std::string(lastShifted));
+                } catch (const std::out_of_range&) {
+                    return false;
+                }
+                break;
+        }
+
+        // Pop the right-hand side and go to the left-hand side's state,
+        // bypassing unit rules as the table-driven loop does
+        states.resize(states.size() - ruleLength[rule]);
+        int next = gotoTable[states.back()][ruleLhs[rule]];
+        for (int unit = -action(next); unit > 1 && unitRules[unit];
+             unit = -action(next)) {
+            next = gotoTable[states.back()][ruleLhs[unit]];
+        }
+        states.push_back(next);
+    }
+}
@@ -1,8 +1,13 @@
 #ifndef PARSERSTRUCT_H
 #define PARSERSTRUCT_H
 
+#include "irStruct.h"
+#include <memory_resource>
+#include <stack>
+#include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace parserStruct {
 
@@ -34,6 +39,13 @@ struct QuadTuple {
     QuadTuple() : Xfour(-1) {}
 };
 
+// SyntaxError is thrown by the semantic actions when the program is
+// malformed (undeclared or redeclared variable, integer literal out of
+// range). The parser reports it like a failed table lookup.
+struct SyntaxError : std::runtime_error {
+    SyntaxError() : std::runtime_error("Syntax Error") {}
+};
+
 // Symbol structure represents an entry in the symbol table.
 // It stores information about a symbol such as its name, type, and memory
 // offset.
@@ -63,14 +75,25 @@ struct Attribute {
     int width;         // The width or size of the data (in bytes)
     std::string name;  // The name of the variable (or temporary variable)
     std::string type;  // The type of the variable (e.g., int, float)
-    std::string op;    // The operator used in the expression
-    std::string place;  // The location where the value is stored (e.g.,
-                        // register or temporary variable)
+    irStruct::OpCode op;  // The operator used in the expression
+    irStruct::Operand place;  // The location where the value is stored (a
+                              // symbol, temporary variable or literal)
 
     // Default constructor initializes all fields to default values
-    Attribute() : quad(0), nextlist(0), truelist(0), falselist(0), width(0) {}
+    Attribute()
+        : quad(0),
+          nextlist(0),
+          truelist(0),
+          falselist(0),
+          width(0),
+          op(irStruct::OpCode::Assign) {}
 };
 
+// The parser's attribute stack. It sits on a vector, which keeps its storage
+// when the stack shrinks, where a deque frees and allocates blocks as the
+// stack moves across their boundaries
+using AttributeStack = std::stack<Attribute, std::pmr::vector<Attribute>>;
+
 }  // namespace parserStruct
 
 #endif  // PARSERSTRUCT_H
@@ -1,5 +1,7 @@
 #include "parserUtil.h"
 #include "parserStruct.h"
+#include "irUtil.h"
+#include <charconv>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -12,50 +14,62 @@ namespace parserUtil {
 // Updates the placeholder (i) in the list of quadruples (q) with the target
 // address (t) This is typically used for backpatching jump addresses or other
 // unresolved references
-void backpatch(int i, int t, std::vector<parserStruct::QuadTuple>& q) {
+void backpatch(int i, int t, irStruct::QuadList& q) {
     while (i > 0) {
-        int nxt = q[i].Xfour;
-        q[i].Xfour = t;  // Set the placeholder to the target address
-        i = nxt;         // Move to the next backpatch placeholder, if any
+        int nxt = q.result(i).index;
+        // Set the placeholder to the target address
+        q.setResult(i, irStruct::Operand::target(t));
+        i = nxt;  // Move to the next backpatch placeholder, if any
     }
 }
 
 // Merges two quadruple lists (a and b), linking the end of list b to the start
 // of list a Returns the updated index for the merged list
-int merge(int a, int b, std::vector<parserStruct::QuadTuple>& q) {
+int merge(int a, int b, irStruct::QuadList& q) {
     if (a < 0 || b < 0)
         return std::max(a, b);  // If either list is empty, return the valid one
     int x = b;
     int p = -1;
     while (x > 0) {
         p = x;
-        x = q[x].Xfour;  // Find the last element of list b
+        x = q.result(x).index;  // Find the last element of list b
     }
+    // Link the end of list b to the start of list a
     if (p != -1)
-        q[p].Xfour = a;  // Link the end of list b to the start of list a
-    return b;            // Return the index of list b
+        q.setResult(p, irStruct::Operand::target(a));
+    return b;  // Return the index of list b
 }
 
-// Looks up a symbol by its name in the symbol table (s) and returns its index
-// in the temporary base (TB)
-std::string lookup(const std::string& name,
-                   const std::vector<parserStruct::Symbol>& s) {
+// Jumps left with an empty list link (-1 or 0) fall through to the End
+// quadruple, which is always the last one
+void resolveJumps(irStruct::QuadList& q) {
+    for (std::size_t i = 0; i < q.size(); i++) {
+        if (irUtil::isJump(q.op(i)) && q.result(i).index <= 0) {
+            q.setResult(i, irStruct::Operand::target(
+                               static_cast<int>(q.size()) - 1));
+        }
+    }
+}
+
+// Looks up a symbol by its name in the symbol table (s) and returns it as a
+// symbol operand (printed as TB<index>)
+irStruct::Operand lookup(const std::string& name,
+                         const std::pmr::vector<parserStruct::Symbol>& s) {
     auto it = std::find_if(
         s.begin(), s.end(), [&name](const parserStruct::Symbol& i) {
             return i.name == name;  // Find the symbol matching the name
         });
     if (it != s.end()) {
-        return "TB" + std::to_string(std::distance(
-                          s.begin(), it));  // Return the index in TB
+        return irStruct::Operand::symbol(static_cast<int>(
+            std::distance(s.begin(), it)));  // Return the index in TB
     }
-    std::cout << "Syntax Error\n";
-    exit(0);  // If the symbol is not found, exit with an error
+    throw parserStruct::SyntaxError();  // The symbol is not declared
 }
 
 // Looks up the type of a symbol by its name in the symbol table (s) and returns
 // the symbol type
 std::string look_up_type(const std::string& name,
-                         const std::vector<parserStruct::Symbol>& s) {
+                         const std::pmr::vector<parserStruct::Symbol>& s) {
     auto it = std::find_if(
         s.begin(), s.end(), [&name](const parserStruct::Symbol& i) {
             return i.name == name;  // Find the symbol matching the name
@@ -63,20 +77,27 @@ std::string look_up_type(const std::string& name,
     if (it != s.end()) {
         return it->type;  // Return the type of the found symbol
     }
-    std::cout << "Syntax Error\n";
-    exit(0);  // If the symbol is not found, exit with an error
+    throw parserStruct::SyntaxError();  // The symbol is not declared
 }
 
-// Generates a new temporary variable name, appending a number to a base "T"
-// string k is used to determine if the temporary variable is an integer or a
-// double
-std::string Temp_New(int k, std::vector<int>& t) {
-    t.push_back(k);  // Add the index to the temporary variable list
-    std::string res =
-        "T" + std::to_string(t.size() - 1);  // Create the variable name
-    res +=
-        (k == 0) ? "_i" : "_d";  // Append "_i" for integer or "_d" for double
-    return res;                  // Return the new temporary variable name
+// Generates a new temporary variable, numbered after the ones created so far.
+// k is used to determine if the temporary variable is an integer or a double
+irStruct::Operand Temp_New(int k, std::vector<irStruct::ValueType>& t) {
+    auto type = static_cast<irStruct::ValueType>(k);
+    t.push_back(type);  // Record the type of the new temporary
+    return irStruct::Operand::temp(static_cast<int>(t.size()) - 1, type);
+}
+
+// Converts an integer literal into an immediate operand. Literals that do not
+// fit the immediate keep their text, which the listings print as written
+irStruct::Operand intLiteral(const std::string& literal) {
+    std::int64_t value = 0;
+    auto [ptr, ec] = std::from_chars(literal.data(),
+                                     literal.data() + literal.size(), value);
+    if (ec != std::errc() || ptr != literal.data() + literal.size()) {
+        return irUtil::textLiteral(literal);
+    }
+    return irStruct::Operand::immInt(value);
 }
 
 std::tuple<size_t, size_t, size_t, size_t, size_t> findPositions(std::string_view str, char delimiter) {
@@ -1,7 +1,9 @@
 #ifndef PARSERUTIL_H
 #define PARSERUTIL_H
 
+#include "irStruct.h"
 #include "parserStruct.h"
+#include <memory_resource>
 #include <vector>
 #include <cstring>
 
@@ -22,7 +24,7 @@ namespace parserUtil {
  * @param t The target address to backpatch.
  * @param q The list of quadruples where the backpatching is performed.
  */
-void backpatch(int i, int t, std::vector<parserStruct::QuadTuple>& q);
+void backpatch(int i, int t, irStruct::QuadList& q);
 
 /**
  * @brief Merges two quadruple lists and returns the resulting index.
@@ -32,18 +34,27 @@ void backpatch(int i, int t, std::vector<parserStruct::QuadTuple>& q);
  * @param q The list of quadruples where the merge is performed.
  * @return int The index of the merged list.
  */
-int merge(int a, int b, std::vector<parserStruct::QuadTuple>& q);
+int merge(int a, int b, irStruct::QuadList& q);
 
 /**
- * @brief Looks up a symbol by name in the symbol table and returns its string
- * representation.
+ * @brief Resolves the jumps whose target was never backpatched to the last
+ * quadruple (the End of the program).
+ *
+ * @param q The list of quadruples to finalize.
+ */
+void resolveJumps(irStruct::QuadList& q);
+
+/**
+ * @brief Looks up a symbol by name in the symbol table and returns it as an
+ * operand.
  *
  * @param name The name of the symbol to look up.
  * @param s The symbol table containing the symbols.
- * @return std::string The string representation of the symbol if found.
+ * @return irStruct::Operand The symbol operand if found.
+ * @throws parserStruct::SyntaxError If the symbol is not declared.
  */
-std::string lookup(const std::string& name,
-                   const std::vector<parserStruct::Symbol>& s);
+irStruct::Operand lookup(const std::string& name,
+                         const std::pmr::vector<parserStruct::Symbol>& s);
 
 /**
  * @brief Looks up the type of a symbol by name in the symbol table and returns
@@ -52,19 +63,28 @@ std::string lookup(const std::string& name,
  * @param name The name of the symbol to look up.
  * @param s The symbol table containing the symbols.
  * @return std::string The type of the symbol if found.
+ * @throws parserStruct::SyntaxError If the symbol is not declared.
  */
 std::string look_up_type(const std::string& name,
-                         const std::vector<parserStruct::Symbol>& s);
+                         const std::pmr::vector<parserStruct::Symbol>& s);
+
+/**
+ * @brief Generates a new temporary variable and records its type.
+ *
+ * @param k The type of the temporary (0 for int, 1 for double).
+ * @param t A vector holding the types of the temporaries created so far.
+ * @return irStruct::Operand The new temporary variable.
+ */
+irStruct::Operand Temp_New(int k, std::vector<irStruct::ValueType>& t);
 
 /**
- * @brief Generates a new temporary variable name based on a counter and updates
- * the index.
+ * @brief Converts an integer literal token into an immediate operand, or into
+ * a literal kept as text if it does not fit.
  *
- * @param k The counter value used to generate the variable name.
- * @param t A vector representing the current temporary variable indices.
- * @return std::string The generated temporary variable name.
+ * @param literal The literal as scanned by the lexer.
+ * @return irStruct::Operand The ImmInt or ImmText operand.
  */
-std::string Temp_New(int k, std::vector<int>& t);
+irStruct::Operand intLiteral(const std::string& literal);
 
 /**
  * @brief Finds positions of multiple delimiters in a string.
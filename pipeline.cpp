@@ -0,0 +1,427 @@
+#include "pipeline.h"
+#include "blockTracker.h"
+#include "incrementalParser.h"
+#include "irBinary.h"
+#include "irUtil.h"
+#include "lexer.h"
+#include "objectGen.h"
+#include "parallelParser.h"
+#include "parser.h"
+#include "spscQueue.h"
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <thread>
+
+namespace pipeline {
+
+bool parseOption(const std::string& arg, Options& options) {
+    if (arg == "--emit=tokens") {
+        options.emit = EmitKind::Tokens;
+    } else if (arg == "--emit=quads") {
+        options.emit = EmitKind::Quads;
+    } else if (arg == "--emit=qir") {
+        options.emit = EmitKind::Binary;
+    } else if (arg == "--emit=asm") {
+        options.emit = EmitKind::Asm;
+    } else if (arg == "--parser=table") {
+        options.engine = Parser::Engine::Table;
+    } else if (arg == "--parser=direct") {
+        options.engine = Parser::Engine::Direct;
+    } else if (arg == "--parser=descent") {
+        options.engine = Parser::Engine::Descent;
+    } else if (arg == "--stream") {
+        options.stream = true;
+    } else if (arg == "--threads") {
+        options.threads = true;
+    } else if (arg == "--incremental") {
+        options.incremental = true;
+    } else if (arg == "--ast") {
+        options.ast = true;
+    } else if (arg == "--fold") {
+        options.fold = true;
+    } else if (arg == "--check") {
+        options.check = true;
+    } else if (arg == "--batch") {
+        options.batch = true;
+    } else if (arg.rfind("--opt=", 0) == 0) {
+        std::string_view names(arg);
+        names.remove_prefix(names.find('=') + 1);
+        options.passes.clear();
+        while (!names.empty()) {
+            const auto comma = std::min(names.find(','), names.size());
+            const auto pass = irOpt::parsePass(names.substr(0, comma));
+            if (!pass) {
+                return false;
+            }
+            options.passes.push_back(*pass);
+            names.remove_prefix(std::min(comma + 1, names.size()));
+        }
+    } else if (arg.rfind("--parse-jobs=", 0) == 0) {
+        const char* first = arg.data() + arg.find('=') + 1;
+        const char* last = arg.data() + arg.size();
+        auto [ptr, ec] = std::from_chars(first, last, options.parseJobs);
+        if (ec != std::errc() || ptr != last || options.parseJobs == 0) {
+            return false;
+        }
+    } else if (arg.rfind("--codegen-jobs=", 0) == 0) {
+        const char* first = arg.data() + arg.find('=') + 1;
+        const char* last = arg.data() + arg.size();
+        auto [ptr, ec] = std::from_chars(first, last, options.codegenJobs);
+        if (ec != std::errc() || ptr != last || options.codegenJobs == 0) {
+            return false;
+        }
+    } else if (arg == "--input=source") {
+        options.input = InputKind::Source;
+    } else if (arg == "--input=quads") {
+        options.input = InputKind::Quads;
+    } else if (arg == "--input=qir") {
+        options.input = InputKind::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Concatenates the lines of a listing
+static std::string join(const std::vector<std::string>& lines) {
+    std::string out;
+    for (const auto& line : lines) {
+        out += line;
+    }
+    return out;
+}
+
+namespace {
+
+// Compiles one program, parsing it with the given parser unless it runs
+// ParallelParser; the other phases allocate from the resource
+std::string compile(const std::string& input,
+                    const Options& options,
+                    Parser& parser,
+                    std::pmr::memory_resource* resource) {
+    // A quadruple listing or a binary module skips the front end
+    if (options.input == InputKind::Quads) {
+        return runModule(irUtil::readModule(std::string_view(input)), options,
+                         resource);
+    }
+    if (options.input == InputKind::Binary) {
+        irBinary::ModuleView view(input.data(), input.size());
+        return runModule(view.toModule(), options, resource);
+    }
+
+    Lexer lexer(resource);
+    auto tokens = lexer.tokenize(input);
+    if (tokens.empty()) {
+        return "";
+    }
+    if (!lexer.err_msg.empty()) {
+        return lexer.err_msg[0].second;
+    }
+
+    if (options.emit == EmitKind::Tokens) {
+        std::string out;
+        for (const auto& token : tokens) {
+            out += Lexer::formatToken(token);
+        }
+        return out;
+    }
+
+    std::optional<irStruct::Module> module;
+    if (options.ast) {
+        if (auto program = parser.parseAst(tokens)) {
+            module = ast::lower(*program);
+        }
+    } else if (options.parseJobs > 1) {
+        ParallelParser parallel(options.parseJobs);
+        parallel.setFolding(options.fold);
+        module = parallel.parse(tokens);
+    } else {
+        module = parser.parse(tokens);
+    }
+    if (!module) {
+        return "Syntax Error\n";
+    }
+    return runModule(std::move(*module), options, resource);
+}
+
+}  // namespace
+
+std::string run(const std::string& input,
+                const Options& options,
+                std::pmr::memory_resource* resource) {
+    // The tree is always built by the table-driven engine
+    Parser parser(options.ast ? Parser::Engine::Table : options.engine,
+                  resource);
+    parser.setFolding(options.fold);
+    return compile(input, options, parser, resource);
+}
+
+namespace {
+
+// Initial size of the batch arena; one compilation's lexer, parser and code
+// generator containers mostly fit, larger ones make it grow
+constexpr std::size_t ARENA_SIZE = 1 << 20;
+
+}  // namespace
+
+std::vector<std::string> runBatch(const std::vector<std::string>& inputs,
+                                  const Options& options) {
+    // One parser builds its tables once for the whole batch, from a pool
+    // that outlives the arena
+    std::pmr::unsynchronized_pool_resource pool;
+    Parser parser(options.ast ? Parser::Engine::Table : options.engine,
+                  &pool);
+    parser.setFolding(options.fold);
+
+    // The first compilation's memory comes from the buffer; the arena only
+    // asks the heap for more once it is used up
+    std::vector<std::byte> buffer(ARENA_SIZE);
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    std::vector<std::string> outputs;
+    for (const auto& input : inputs) {
+        outputs.push_back(compile(input, options, parser, &arena));
+        arena.release();
+    }
+    return outputs;
+}
+
+std::string runStream(std::istream& input, const Options& options) {
+    TokenStream stream(input);
+    std::string out;
+    std::optional<irStruct::Module> module;
+
+    if (options.emit == EmitKind::Tokens) {
+        lexerStruct::Token token;
+        while (stream.next(token)) {
+            out += Lexer::formatToken(token);
+        }
+    } else {
+        Parser parser(options.engine);
+        parser.setFolding(options.fold);
+        module = parser.parse(stream);
+        // Lexical errors anywhere in the input take precedence, so a syntax
+        // error is only reported once the rest of the input has been lexed
+        if (!module) {
+            lexerStruct::Token token;
+            while (stream.next(token)) {
+            }
+        }
+    }
+
+    if (stream.count() == 0) {
+        return "";
+    }
+    if (!stream.errors().empty()) {
+        return stream.errors()[0].second;
+    }
+    if (options.emit == EmitKind::Tokens) {
+        return out;
+    }
+    if (!module) {
+        return "Syntax Error\n";
+    }
+    return runModule(std::move(*module), options);
+}
+
+void runListing(std::string_view listing,
+                const Options& options,
+                std::ostream& out) {
+    if (options.emit == EmitKind::Asm && options.passes.empty()) {
+        ObjectCodeGenerator().generateStreaming(listing, out);
+    } else {
+        out << runModule(irUtil::readModule(listing), options);
+    }
+}
+
+std::vector<std::string> runEdits(const std::vector<std::string>& versions,
+                                  const Options& options) {
+    IncrementalParser parser;
+    std::vector<std::string> outputs;
+    for (const auto& version : versions) {
+        Lexer lexer;
+        auto tokens = lexer.tokenize(version);
+        if (tokens.empty()) {
+            outputs.emplace_back();
+        } else if (!lexer.err_msg.empty()) {
+            outputs.push_back(lexer.err_msg[0].second);
+        } else if (options.emit == EmitKind::Tokens) {
+            std::string out;
+            for (const auto& token : tokens) {
+                out += Lexer::formatToken(token);
+            }
+            outputs.push_back(std::move(out));
+        } else if (auto module = parser.parse(std::move(tokens))) {
+            outputs.push_back(runModule(std::move(*module), options));
+        } else {
+            outputs.push_back("Syntax Error\n");
+        }
+    }
+    return outputs;
+}
+
+std::string check(const std::string& input, Parser& parser) {
+    Lexer lexer;
+    auto tokens = lexer.tokenize(input);
+    if (tokens.empty()) {
+        return "";
+    }
+    if (!lexer.err_msg.empty()) {
+        return lexer.err_msg[0].second;
+    }
+    return parser.recognize(tokens) ? "" : "Syntax Error\n";
+}
+
+namespace {
+
+// Slots in the token queue; enough to cover a few long lines
+constexpr std::size_t TOKEN_QUEUE_SIZE = 4096;
+
+// Slots in the basic block queue
+constexpr std::size_t BLOCK_QUEUE_SIZE = 256;
+
+// A basic block on its way from the parser to the code generator
+struct BlockMessage {
+    int start = 0;                     // Index of the block's first quad
+    std::vector<irStruct::Quad> quads;  // Quads since the previous block
+};
+
+// Ends the lexer and code generator threads however the parse ends, so an
+// exception from the parser propagates as in the sequential pipeline
+class ThreadGuard {
+public:
+    ThreadGuard(SpscQueue<lexerStruct::Token>& tokens,
+                std::thread& lexerThread,
+                SpscQueue<BlockMessage>& blocks,
+                std::thread& codegenThread)
+        : tokens(tokens),
+          lexerThread(lexerThread),
+          blocks(blocks),
+          codegenThread(codegenThread) {}
+
+    ThreadGuard(const ThreadGuard&) = delete;
+    ThreadGuard& operator=(const ThreadGuard&) = delete;
+
+    ~ThreadGuard() { join(); }
+
+    // Drains the tokens left so the lexer can finish, closes the block queue
+    // and waits for both threads
+    void join() {
+        if (lexerThread.joinable()) {
+            lexerStruct::Token token;
+            while (tokens.pop(token)) {
+            }
+            lexerThread.join();
+        }
+        blocks.close();
+        if (codegenThread.joinable()) {
+            codegenThread.join();
+        }
+    }
+
+private:
+    SpscQueue<lexerStruct::Token>& tokens;
+    std::thread& lexerThread;
+    SpscQueue<BlockMessage>& blocks;
+    std::thread& codegenThread;
+};
+
+}  // namespace
+
+std::string runThreaded(std::istream& input, const Options& options) {
+    if (options.emit == EmitKind::Tokens) {
+        return runStream(input, options);
+    }
+
+    // Lexer thread: everything it reads goes through the token queue, so a
+    // failed parse still leaves the whole input lexed for error reporting
+    TokenStream stream(input);
+    SpscQueue<lexerStruct::Token> tokens(TOKEN_QUEUE_SIZE);
+    std::thread lexerThread([&stream, &tokens] {
+        lexerStruct::Token token;
+        while (stream.next(token)) {
+            tokens.push(std::move(token));
+        }
+        tokens.close();
+    });
+
+    // Code generator thread: translates each block as soon as it arrives
+    const bool generate =
+        options.emit == EmitKind::Asm && options.passes.empty();
+    SpscQueue<BlockMessage> blocks(BLOCK_QUEUE_SIZE);
+    std::vector<irStruct::SymbolEntry> symbols;
+    bool started = false;
+    std::string code;
+    std::thread codegenThread;
+    ThreadGuard guard(tokens, lexerThread, blocks, codegenThread);
+
+    Parser parser(options.engine);
+    parser.setFolding(options.fold);
+    BlockTracker tracker([&](const irStruct::QuadList& quads, int first,
+                             int start, int end) {
+        // The symbol table is complete before the first quad exists
+        if (!started) {
+            started = true;
+            symbols = parser.symbols();
+            codegenThread = std::thread([&blocks, &symbols, &code] {
+                ObjectCodeGenerator ocg;
+                ocg.begin(std::move(symbols));
+                BlockMessage message;
+                while (blocks.pop(message)) {
+                    ocg.addBlock(message.quads, message.start);
+                }
+                code = ocg.finish();
+            });
+        }
+        BlockMessage message;
+        message.start = start;
+        for (int i = first; i <= end; i++) {
+            message.quads.push_back(quads.at(i));
+        }
+        blocks.push(std::move(message));
+    });
+    if (generate) {
+        parser.setBlockTracker(&tracker);
+    }
+
+    auto module = parser.parse([&tokens](lexerStruct::Token& token) {
+        return tokens.pop(token);
+    });
+    guard.join();
+
+    if (stream.count() == 0) {
+        return "";
+    }
+    if (!stream.errors().empty()) {
+        return stream.errors()[0].second;
+    }
+    if (!module) {
+        return "Syntax Error\n";
+    }
+    if (!started) {
+        return runModule(std::move(*module), options);
+    }
+    return code;
+}
+
+std::string runModule(irStruct::Module module,
+                      const Options& options,
+                      std::pmr::memory_resource* resource) {
+    irOpt::optimize(module, options.passes);
+    switch (options.emit) {
+        case EmitKind::Quads:
+            return join(irUtil::printModule(module));
+        case EmitKind::Binary:
+            return irBinary::serialize(module);
+        case EmitKind::Asm: {
+            ObjectCodeGenerator ocg(resource);
+            ocg.setJobs(options.codegenJobs);
+            return ocg.generate(std::move(module));
+        }
+        default:
+            return "";
+    }
+}
+
+}  // namespace pipeline
@@ -0,0 +1,204 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "irOpt.h"
+#include "irStruct.h"
+#include "parser.h"
+#include <istream>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * What a build runs when no option selects the stages, as the TASK switch
+ * in main.cpp did: 1 prints the token listing and 2 the quadruple listing of
+ * source code, 3 the object code of a quadruple listing (the default), and 4
+ * the object code of source code. Set it with -DTASK=N; --emit and --input
+ * override it.
+ */
+#ifndef TASK
+#define TASK 3
+#endif
+
+#if TASK < 1 || TASK > 4
+#error "TASK must be 1, 2, 3 or 4"
+#endif
+
+namespace pipeline {
+
+/**
+ * @enum EmitKind
+ * @brief The stage after which the compiler stops and prints its result.
+ */
+enum class EmitKind {
+    Tokens,  ///< Token listing produced by the lexer.
+    Quads,   ///< Quadruple listing produced by the parser.
+    Binary,  ///< Quadruples in the binary QIR container (irBinary.h).
+    Asm      ///< Object code produced by the object code generator.
+};
+
+/**
+ * @enum InputKind
+ * @brief The format of the program input.
+ */
+enum class InputKind {
+    Source,  ///< Source code, compiled from the lexer onwards.
+    Quads,   ///< A quadruple listing, handed directly to code generation.
+    Binary   ///< A binary QIR module, handed directly to code generation.
+};
+
+/**
+ * @struct Options
+ * @brief Runtime configuration of a compilation.
+ */
+struct Options {
+    EmitKind emit = (TASK == 1)   ? EmitKind::Tokens
+                    : (TASK == 2) ? EmitKind::Quads
+                                  : EmitKind::Asm;  ///< What to print.
+    InputKind input = (TASK == 3) ? InputKind::Quads
+                                  : InputKind::Source;  ///< What is read.
+    Parser::Engine engine = Parser::Engine::Table;  ///< How to parse.
+    bool stream = false;  ///< Parse source code while it is being read,
+                          ///< or generate code for a quadruple listing one
+                          ///< block at a time.
+    bool threads = false;  ///< Run lexer, parser and code generator on
+                           ///< their own threads (implies stream).
+    bool incremental = false;  ///< Inputs are successive versions of one
+                               ///< program, reparsed incrementally.
+    bool check = false;  ///< Only report whether each input is valid.
+    bool batch = false;  ///< Compile several independent inputs.
+    bool ast = false;  ///< Parse into an AST, then lower it to quadruples.
+    bool fold = false;  ///< Fold constants in the semantic actions (not
+                        ///< with ast or incremental).
+    std::vector<irOpt::Pass> passes;  ///< Optimization passes run on the
+                                      ///< quadruples before they are emitted.
+    unsigned parseJobs = 1;  ///< Threads parsing the statements of the
+                             ///< outermost block (ParallelParser).
+    unsigned codegenJobs = 1;  ///< Threads generating object code for the
+                               ///< basic blocks.
+};
+
+/**
+ * @brief Parses a command line option (e.g. "--emit=quads") into the
+ * options.
+ *
+ * @param arg The command line argument.
+ * @param options The options to update.
+ * @return bool False if the argument is not a recognised option.
+ */
+bool parseOption(const std::string& arg, Options& options);
+
+/**
+ * @brief Compiles the input in memory: the lexer hands its tokens to the
+ * parser and the parser hands its module to the object code generator
+ * without any intermediate text.
+ *
+ * @param input The program input.
+ * @param options Which stages to run.
+ * @param resource Allocates the containers of the lexer, the parser and the
+ * object code generator.
+ * @return std::string The output of the last stage that was run.
+ */
+std::string run(const std::string& input,
+                const Options& options,
+                std::pmr::memory_resource* resource =
+                    std::pmr::get_default_resource());
+
+/**
+ * @brief Compiles source code while reading it: the parser pulls tokens from
+ * a TokenStream, so only the tokens of the current line are held in memory.
+ * The output is the same as that of run() on the whole input.
+ *
+ * @param input The source code input.
+ * @param options What to emit; the input kind is ignored.
+ * @return std::string The output of the last stage that was run.
+ */
+std::string runStream(std::istream& input, const Options& options);
+
+/**
+ * @brief Runs the stages after the parser on a quadruple listing. Object code
+ * is generated with ObjectCodeGenerator::generateStreaming(), which writes
+ * each basic block as soon as it is generated and never holds the whole
+ * program; other outputs, and optimization passes, read the listing into a
+ * module first.
+ *
+ * @param listing The textual quadruple listing, e.g. a mapped file.
+ * @param options What to emit; the input kind is ignored.
+ * @param out Receives the output.
+ */
+void runListing(std::string_view listing,
+                const Options& options,
+                std::ostream& out);
+
+/**
+ * @brief Compiles source code with the lexer, the parser and the object code
+ * generator running concurrently on their own threads. Tokens flow from the
+ * lexer to the parser, and basic blocks whose jumps have been backpatched
+ * flow from the parser to the code generator, through bounded lock-free
+ * single-producer single-consumer queues. The output is the same as that of
+ * run() on the whole input.
+ *
+ * @param input The source code input.
+ * @param options What to emit; the input kind is ignored.
+ * @return std::string The output of the last stage that was run.
+ */
+std::string runThreaded(std::istream& input, const Options& options);
+
+/**
+ * @brief Compiles successive versions of a source program, e.g. the states
+ * of a file being edited. One IncrementalParser parses all of them, so each
+ * version after the first only reparses the statements around its edit. Each
+ * output is the same as that of run() on that version.
+ *
+ * @param versions The source code of each version, in order.
+ * @param options What to emit; the input kind and engine are ignored.
+ * @return std::vector<std::string> The output for each version.
+ */
+std::vector<std::string> runEdits(const std::vector<std::string>& versions,
+                                  const Options& options);
+
+/**
+ * @brief Compiles independent programs one after the other, e.g. the files
+ * of a build. One parser builds its tables once and parses every program.
+ * Each compilation allocates the containers of its lexer and object code
+ * generator from a monotonic arena, which is reset before the next
+ * compilation instead of being freed object by object. Each output is the
+ * same as that of run() on that input.
+ *
+ * @param inputs The program inputs.
+ * @param options Which stages to run.
+ * @return std::vector<std::string> The output for each input.
+ */
+std::vector<std::string> runBatch(const std::vector<std::string>& inputs,
+                                  const Options& options);
+
+/**
+ * @brief Checks whether a source program is valid without compiling it, using
+ * Parser::recognize(). The parser's tables are reused across calls.
+ *
+ * @param input The source code.
+ * @param parser The parser to check with.
+ * @return std::string Empty if the program is valid, otherwise the error
+ * run() would print.
+ */
+std::string check(const std::string& input, Parser& parser);
+
+/**
+ * @brief Runs the stages after the parser on a module, e.g. one mapped from
+ * a binary QIR file. The optimization passes run first.
+ *
+ * @param module The module.
+ * @param options What to emit; the input kind is ignored.
+ * @param resource Allocates the containers of the object code generator.
+ * @return std::string The requested output (nothing for Tokens).
+ */
+std::string runModule(irStruct::Module module,
+                      const Options& options,
+                      std::pmr::memory_resource* resource =
+                          std::pmr::get_default_resource());
+
+}  // namespace pipeline
+
+#endif  // PIPELINE_H
@@ -0,0 +1,104 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pipeline {
+
+/**
+ * @class SpscQueue
+ * @brief Bounded lock-free ring buffer between exactly one producer thread and
+ * one consumer thread.
+ *
+ * The producer owns the tail index and the consumer the head index; each side
+ * only reads the other's index, and keeps a cached copy of it so that the
+ * shared cache line is touched only when the ring looks full or empty.
+ *
+ * @tparam T The element type; must be default constructible and movable.
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * @brief Constructs a queue.
+     *
+     * @param capacity The number of slots, rounded up to a power of two.
+     */
+    explicit SpscQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Appends a value, waiting while the queue is full. Producer only.
+     */
+    void push(T value) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        while (t - headCache == slots.size()) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t - headCache == slots.size()) {
+                std::this_thread::yield();
+            }
+        }
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Marks the end of the stream. Producer only.
+     */
+    void close() { closed.store(true, std::memory_order_release); }
+
+    /**
+     * @brief Removes the oldest value, waiting while the queue is empty.
+     * Consumer only.
+     *
+     * @param value Receives the value.
+     * @return bool False once the queue is closed and drained.
+     */
+    bool pop(T& value) {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        while (h == tailCache) {
+            // Read the flag before the index so no value pushed before
+            // close() can be missed
+            const bool done = closed.load(std::memory_order_acquire);
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h == tailCache) {
+                if (done) {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+        }
+        value = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;  ///< The ring; its size is a power of two.
+    std::size_t mask = 0;  ///< slots.size() - 1.
+
+    alignas(64) std::atomic<std::size_t> head{0};  ///< Next slot to pop.
+    std::size_t tailCache = 0;  ///< Consumer's copy of tail.
+
+    alignas(64) std::atomic<std::size_t> tail{0};  ///< Next slot to push.
+    std::size_t headCache = 0;  ///< Producer's copy of head.
+
+    alignas(64) std::atomic<bool> closed{false};  ///< No more pushes.
+};
+
+}  // namespace pipeline
+
+#endif  // SPSCQUEUE_H
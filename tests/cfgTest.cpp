@@ -0,0 +1,188 @@
+// Checks the analyses of irCfg.h on the quadruples of small if and while
+// statements: immediate dominators, dominance, loop nesting and depth, and
+// that Analysis computes its results again after the quadruples change.
+// The listings are what --emit=quads prints for the source in the comments.
+// Usage: cfgTest
+
+#include "irCfg.h"
+#include "irUtil.h"
+#include <iostream>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what, int line) {
+    if (!condition) {
+        std::cerr << "cfgTest.cpp:" << line << ": " << what << "\n";
+        failures++;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+// scanf(a); if a < 1 then a = 2; printf(a);
+constexpr const char* IF_LISTING =
+    "1\na 0 null 0\n0\n6\n"
+    "0: (R,-,-,TB0)\n"
+    "1: (j<,TB0,1,3)\n"
+    "2: (j,-,-,4)\n"
+    "3: (=,2,-,TB0)\n"
+    "4: (W,-,-,TB0)\n"
+    "5: (End,-,-,-)\n";
+
+// scanf(a); while a < 10 do a = a + 1; printf(a);
+constexpr const char* WHILE_LISTING =
+    "1\na 0 null 0\n1\n8\n"
+    "0: (R,-,-,TB0)\n"
+    "1: (j<,TB0,10,3)\n"
+    "2: (j,-,-,6)\n"
+    "3: (+,TB0,1,T0_i)\n"
+    "4: (=,T0_i,-,TB0)\n"
+    "5: (j,-,-,1)\n"
+    "6: (W,-,-,TB0)\n"
+    "7: (End,-,-,-)\n";
+
+// scanf(a);
+// while a < 10 do { b = 0; while b < a do b = b + 1; a = a + 1; };
+// printf(a, b);
+constexpr const char* NESTED_LISTING =
+    "2\na 0 null 0\nb 0 null 4\n2\n15\n"
+    "0: (R,-,-,TB0)\n"
+    "1: (j<,TB0,10,3)\n"
+    "2: (j,-,-,12)\n"
+    "3: (=,0,-,TB1)\n"
+    "4: (j<,TB1,TB0,6)\n"
+    "5: (j,-,-,9)\n"
+    "6: (+,TB1,1,T0_i)\n"
+    "7: (=,T0_i,-,TB1)\n"
+    "8: (j,-,-,4)\n"
+    "9: (+,TB0,1,T1_i)\n"
+    "10: (=,T1_i,-,TB0)\n"
+    "11: (j,-,-,1)\n"
+    "12: (W,-,-,TB0)\n"
+    "13: (W,-,-,TB1)\n"
+    "14: (End,-,-,-)\n";
+
+void testIf() {
+    const auto module = irUtil::readModule(std::string_view(IF_LISTING));
+    const irCfg::Cfg cfg(module.quads);
+    const irCfg::DominatorTree dominators(cfg);
+    const irCfg::LoopNest loops(cfg, dominators);
+    auto block = [&cfg](int quad) { return cfg.blockOf(quad); };
+
+    // The condition dominates both branches and the join; the then branch
+    // does not dominate the join, which the else jump reaches around it
+    CHECK(dominators.idom(block(0)) == block(0));
+    CHECK(dominators.idom(block(3)) == block(1));
+    CHECK(dominators.dominates(block(1), block(3)));
+    CHECK(dominators.dominates(block(1), block(4)));
+    CHECK(!dominators.dominates(block(3), block(4)));
+    CHECK(dominators.dominates(block(4), block(4)));
+    CHECK(dominators.idom(block(4)) == block(1));
+
+    CHECK(loops.loops().empty());
+    CHECK(loops.loopOf(block(3)) == -1);
+    CHECK(loops.depth(block(3)) == 0);
+}
+
+void testWhile() {
+    const auto module = irUtil::readModule(std::string_view(WHILE_LISTING));
+    const irCfg::Cfg cfg(module.quads);
+    const irCfg::DominatorTree dominators(cfg);
+    const irCfg::LoopNest loops(cfg, dominators);
+    auto block = [&cfg](int quad) { return cfg.blockOf(quad); };
+
+    CHECK(dominators.idom(block(1)) == block(0));
+    CHECK(dominators.idom(block(3)) == block(1));
+    CHECK(dominators.dominates(block(1), block(6)));
+    CHECK(!dominators.dominates(block(3), block(6)));
+    CHECK(!dominators.dominates(block(3), block(1)));
+
+    CHECK(loops.loops().size() == 1);
+    const int loop = loops.loopOf(block(3));
+    CHECK(loop == 0);
+    CHECK(loops.loops()[0].header == block(1));
+    CHECK(loops.loops()[0].latches.size() == 1 &&
+          loops.loops()[0].latches[0] == block(5));
+    CHECK(loops.loopOf(block(1)) == loop);
+    CHECK(loops.depth(block(3)) == 1);
+    CHECK(loops.depth(block(0)) == 0);
+    CHECK(loops.depth(block(6)) == 0);
+}
+
+void testNestedWhile() {
+    const auto module = irUtil::readModule(std::string_view(NESTED_LISTING));
+    const irCfg::Cfg cfg(module.quads);
+    const irCfg::DominatorTree dominators(cfg);
+    const irCfg::LoopNest loops(cfg, dominators);
+    auto block = [&cfg](int quad) { return cfg.blockOf(quad); };
+
+    CHECK(dominators.idom(block(3)) == block(1));
+    CHECK(dominators.idom(block(4)) == block(3));
+    CHECK(dominators.idom(block(6)) == block(4));
+    CHECK(dominators.dominates(block(1), block(9)));
+    CHECK(dominators.dominates(block(4), block(9)));
+    CHECK(!dominators.dominates(block(6), block(9)));
+    CHECK(!dominators.dominates(block(4), block(12)));
+
+    // Inner loops come first
+    CHECK(loops.loops().size() == 2);
+    const int inner = loops.loopOf(block(6));
+    const int outer = loops.loopOf(block(9));
+    CHECK(inner == 0 && outer == 1);
+    CHECK(loops.loops()[inner].header == block(4));
+    CHECK(loops.loops()[outer].header == block(1));
+    CHECK(loops.loops()[inner].parent == outer);
+    CHECK(loops.loops()[outer].parent == -1);
+    CHECK(loops.loopOf(block(4)) == inner);
+    CHECK(loops.loopOf(block(3)) == outer);
+
+    CHECK(loops.depth(block(6)) == 2);
+    CHECK(loops.depth(block(4)) == 2);
+    CHECK(loops.depth(block(3)) == 1);
+    CHECK(loops.depth(block(9)) == 1);
+    CHECK(loops.depth(block(12)) == 0);
+
+    CHECK(loops.contains(outer, block(6)));
+    CHECK(!loops.contains(inner, block(9)));
+    CHECK(!loops.contains(outer, block(12)));
+}
+
+void testAnalysisCache() {
+    auto module = irUtil::readModule(std::string_view(WHILE_LISTING));
+    auto& quads = module.quads;
+    irCfg::Analysis analysis(quads);
+
+    CHECK(analysis.loops().loops().size() == 1);
+    const irCfg::Cfg* graph = &analysis.cfg();
+
+    // Reading the quadruples keeps the results
+    const auto version = quads.version();
+    CHECK(quads.op(5) == irStruct::OpCode::Jump);
+    CHECK(quads.result(5).index == 1);
+    CHECK(quads.version() == version);
+    CHECK(&analysis.cfg() == graph);
+    CHECK(analysis.loops().loops().size() == 1);
+
+    // Sending the back edge to the exit removes the loop
+    quads.setResult(5, irStruct::Operand::target(6));
+    CHECK(quads.version() > version);
+    CHECK(analysis.loops().loops().empty());
+    CHECK(analysis.dominators().idom(analysis.cfg().blockOf(6)) ==
+          analysis.cfg().blockOf(1));
+}
+
+}  // namespace
+
+int main() {
+    testIf();
+    testWhile();
+    testNestedWhile();
+    testAnalysisCache();
+    if (failures) {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
+    return 0;
+}
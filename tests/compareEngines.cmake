@@ -0,0 +1,37 @@
+# Translates every program in PROGRAMS with the table-driven parser and with
+# each of the modes below, and fails if any output differs.
+# Usage: cmake -DMAIN=<Main> -DPROGRAMS=<directory> -P compareEngines.cmake
+
+# --parse-jobs parses the statements of the outermost block on several
+# threads, each running the table-driven engine
+set(MODES --parser=direct --parser=descent --parse-jobs=2 --parse-jobs=4)
+
+file(GLOB programs "${PROGRAMS}/*.txt")
+if(NOT programs)
+    message(FATAL_ERROR "No programs in ${PROGRAMS}")
+endif()
+
+foreach(program IN LISTS programs)
+    foreach(emit quads asm)
+        execute_process(COMMAND "${MAIN}" --input=source --emit=${emit}
+                                --parser=table "${program}"
+                        OUTPUT_VARIABLE expected
+                        RESULT_VARIABLE status)
+        if(NOT status EQUAL 0)
+            message(FATAL_ERROR "${program}: --parser=table failed: ${status}")
+        endif()
+
+        foreach(mode IN LISTS MODES)
+            execute_process(COMMAND "${MAIN}" --input=source --emit=${emit}
+                                    ${mode} "${program}"
+                            OUTPUT_VARIABLE actual
+                            RESULT_VARIABLE status)
+            if(NOT status EQUAL 0)
+                message(SEND_ERROR "${program}: ${mode} failed: ${status}")
+            elseif(NOT actual STREQUAL expected)
+                message(SEND_ERROR "${program}: --emit=${emit} ${mode} "
+                                   "differs from --parser=table")
+            endif()
+        endforeach()
+    endforeach()
+endforeach()
@@ -0,0 +1,15 @@
+# Fails if parserDirect.inc differs from what ./Main --gen-parser writes.
+# Usage: cmake -DMAIN=<Main> -DSOURCE_DIR=<repository> -P genParser.cmake
+
+execute_process(COMMAND "${MAIN}" --gen-parser
+                OUTPUT_VARIABLE generated
+                RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+    message(FATAL_ERROR "--gen-parser failed: ${status}")
+endif()
+
+file(READ "${SOURCE_DIR}/parserDirect.inc" committed)
+if(NOT generated STREQUAL committed)
+    message(FATAL_ERROR "parserDirect.inc is out of date; regenerate it with "
+                        "./Main --gen-parser > parserDirect.inc")
+endif()
@@ -0,0 +1,199 @@
+// Writes random programs for the differential tests: every third one is
+// broken by a random edit, so most are valid and the rest exercise the error
+// paths of the parsers.
+// Usage: genPrograms <seed> <count> <directory>
+// The same seed gives the same programs on every platform, since only the
+// output of std::mt19937_64 is used.
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+class Generator {
+public:
+    explicit Generator(std::uint64_t seed) : rng(seed) {}
+
+    // A program: declarations, then one block of statements
+    std::string program() {
+        names.clear();
+        std::string out;
+        const int lines = 1 + pick(3);
+        for (int line = 0; line < lines; line++) {
+            out += pick(3) == 0 ? "double " : "int ";
+            const int count = 1 + pick(4);
+            for (int k = 0; k < count; k++) {
+                names.push_back(identifier(names.size()));
+                out += (k ? ", " : "") + names.back();
+            }
+            out += ";\n";
+        }
+        out += "{\n";
+        const int statements = 3 + pick(15);
+        for (int k = 0; k < statements; k++) {
+            out += statement(0) + ";\n";
+        }
+        return out + "}\n";
+    }
+
+    // The program with one random edit that usually makes it invalid
+    std::string broken(std::string source) {
+        const size_t at = pick(static_cast<int>(source.size()));
+        switch (pick(5)) {
+            case 0:  // An undeclared identifier
+                return source.replace(source.find('{'), 1, "{\nundeclared = 1;\n");
+            case 1:  // A redeclared identifier
+                return source.insert(source.find(';'), ", a");
+            case 2:  // A token dropped
+                return source.erase(at, 1);
+            case 3:  // A stray token
+                return source.insert(at, pick(2) ? " ) " : " ; do ");
+            default:  // An unknown character
+                return source.insert(at, " @ ");
+        }
+    }
+
+    int pick(int n) { return static_cast<int>(rng() % n); }
+
+private:
+    std::mt19937_64 rng;
+    std::vector<std::string> names;
+
+    // Identifiers are letters only: a, b, ..., z, ba, bb, ...
+    static std::string identifier(size_t index) {
+        std::string out;
+        do {
+            out.insert(out.begin(), static_cast<char>('a' + index % 26));
+            index /= 26;
+        } while (index);
+        return out;
+    }
+
+    const std::string& name() { return names[pick(names.size())]; }
+
+    // Integer literals are now and then too large for an immediate
+    std::string literal() {
+        if (pick(40) == 0) {
+            return "9223372036854775808" + std::to_string(pick(10));
+        }
+        if (pick(4) == 0) {
+            return std::to_string(pick(100)) + "." + std::to_string(pick(100));
+        }
+        return std::to_string(pick(4) == 0 ? pick(100000) : pick(10));
+    }
+
+    std::string statement(int depth) {
+        const int kind = depth < 3 ? pick(10) : pick(6);
+        if (kind < 4) {
+            return name() + " = " + expression(0);
+        }
+        if (kind == 4) {
+            std::string out = pick(2) ? "scanf(" : "printf(";
+            const int count = 1 + pick(3);
+            for (int k = 0; k < count; k++) {
+                out += (k ? ", " : "") + name();
+            }
+            return out + ")";
+        }
+        if (kind == 5) {
+            return "";
+        }
+        if (kind == 6) {
+            std::string out = "{ ";
+            const int count = 1 + pick(4);
+            for (int k = 0; k < count; k++) {
+                out += statement(depth + 1) + "; ";
+            }
+            return out + "}";
+        }
+        if (kind == 7) {
+            return "while " + condition(0) + " do " + statement(depth + 1);
+        }
+        return "if " + condition(0) + " then " + statement(depth + 1);
+    }
+
+    // EXPR, with operators of every precedence level
+    std::string expression(int depth) {
+        if (depth > 3 || pick(3) == 0) {
+            return pick(2) ? name() : literal();
+        }
+        static const char* const OPERATORS[] = {
+            " + ", " - ", " * ", " / ", " == ", " != ", " < ",
+            " <= ", " > ", " >= ", " && ", " || "};
+        switch (pick(5)) {
+            case 0:
+                return "(" + expression(depth + 1) + ")";
+            case 1:
+                return (pick(2) ? "-" : "+") + factor(depth + 1);
+            case 2:  // ! binds looser than arithmetic, so it is bracketed
+                return "(!" + factor(depth + 1) + ")";
+            default:
+                return expression(depth + 1) + OPERATORS[pick(12)] +
+                       expression(depth + 1);
+        }
+    }
+
+    // FACTOR, which may follow a unary operator
+    std::string factor(int depth) {
+        switch (pick(3)) {
+            case 0:
+                return name();
+            case 1:
+                return literal();
+            default:
+                return "(" + expression(depth) + ")";
+        }
+    }
+
+    // B, with relations between identifiers and literals only
+    std::string condition(int depth) {
+        static const char* const RELATIONS[] = {" == ", " != ", " < ",
+                                                " <= ", " > ", " >= "};
+        const auto operand = [this] {
+            return pick(3) ? name() : literal();
+        };
+        if (depth > 2 || pick(2) == 0) {
+            return pick(5) ? operand() + RELATIONS[pick(6)] + operand()
+                           : operand();
+        }
+        switch (pick(4)) {
+            case 0:
+                return "(" + condition(depth + 1) + ")";
+            case 1:
+                return "!" + condition(depth + 1);
+            case 2:
+                return condition(depth + 1) + " && " + condition(depth + 1);
+            default:
+                return condition(depth + 1) + " || " + condition(depth + 1);
+        }
+    }
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " <seed> <count> <directory>\n";
+        return 1;
+    }
+    Generator generator(std::stoull(argv[1]));
+    const int count = std::stoi(argv[2]);
+    for (int i = 0; i < count; i++) {
+        std::string source = generator.program();
+        if (i % 3 == 2) {
+            source = generator.broken(source);
+        }
+        const std::string path =
+            std::string(argv[3]) + "/program" + std::to_string(i) + ".txt";
+        std::ofstream file(path, std::ios::binary);
+        if (!(file << source)) {
+            std::cerr << "Failed to write " << path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+# Runs every program in PROGRAMS with each of MODES and fails if the outputs
+# differ from the listing checked in for the program, EXPECTED/<name>.expected,
+# which holds the output of each mode in turn after a "# <mode>" line.
+# Usage: cmake -DMAIN=<Main> -DPROGRAMS=<directories> -DMODES=<modes>
+#              -DEXPECTED=<directory> [-DUPDATE=ON] -P golden.cmake
+# Directories and modes are separated by "|", the arguments of a mode by
+# spaces. With UPDATE=ON the expected listings are written instead.
+
+string(REPLACE "|" ";" directories "${PROGRAMS}")
+string(REPLACE "|" ";" modes "${MODES}")
+
+set(programs)
+foreach(directory IN LISTS directories)
+    file(GLOB found "${directory}/*.txt")
+    list(APPEND programs ${found})
+endforeach()
+if(NOT programs)
+    message(FATAL_ERROR "No programs in ${PROGRAMS}")
+endif()
+
+foreach(program IN LISTS programs)
+    get_filename_component(name "${program}" NAME_WE)
+    set(actual "")
+    foreach(mode IN LISTS modes)
+        separate_arguments(arguments UNIX_COMMAND "${mode}")
+        execute_process(COMMAND "${MAIN}" ${arguments} "${program}"
+                        OUTPUT_VARIABLE output
+                        RESULT_VARIABLE status)
+        if(NOT status EQUAL 0)
+            message(SEND_ERROR "${program}: ${mode} failed: ${status}")
+        endif()
+        string(APPEND actual "# ${mode}\n${output}")
+    endforeach()
+
+    set(listing "${EXPECTED}/${name}.expected")
+    if(UPDATE)
+        file(WRITE "${listing}" "${actual}")
+    elseif(NOT EXISTS "${listing}")
+        message(SEND_ERROR "${program}: ${listing} is missing")
+    else()
+        file(READ "${listing}" expected)
+        if(NOT actual STREQUAL expected)
+            message(SEND_ERROR "${program}: the output differs from "
+                               "${listing}")
+        endif()
+    endif()
+endforeach()
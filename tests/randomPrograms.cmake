@@ -0,0 +1,77 @@
+# Writes COUNT programs with the generator (genPrograms.cpp) seeded with SEED
+# into DIRECTORY, and fails if the quadruple listing of any of them from one
+# of the modes below differs from --parser=table. A third of the programs is
+# broken, so the error reporting is compared as well.
+# Usage: cmake -DMAIN=<Main> -DGENERATOR=<genPrograms> -DSEED=<seed>
+#              -DCOUNT=<count> -DDIRECTORY=<directory> -P randomPrograms.cmake
+
+# Modes that compile the programs as one --batch run
+set(BATCH_MODES --parser=direct --parser=descent --parse-jobs=4 --ast)
+# Modes that read one program per run
+set(SINGLE_MODES --stream --threads)
+
+file(REMOVE_RECURSE "${DIRECTORY}")
+file(MAKE_DIRECTORY "${DIRECTORY}")
+execute_process(COMMAND "${GENERATOR}" ${SEED} ${COUNT} "${DIRECTORY}"
+                RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+    message(FATAL_ERROR "${GENERATOR} failed: ${status}")
+endif()
+
+file(GLOB programs "${DIRECTORY}/*.txt")
+list(LENGTH programs found)
+if(NOT found EQUAL COUNT)
+    message(FATAL_ERROR "${found} of ${COUNT} programs in ${DIRECTORY}")
+endif()
+
+# Stores the quadruple listing Main prints with the given arguments
+function(run result)
+    execute_process(COMMAND "${MAIN}" --input=source --emit=quads ${ARGN}
+                    OUTPUT_VARIABLE output
+                    RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(SEND_ERROR "${ARGN}: failed: ${status}")
+    endif()
+    set(${result} "${output}" PARENT_SCOPE)
+endfunction()
+
+# Compiles the programs one by one to name those that differ in a mode
+function(locate mode)
+    foreach(program IN LISTS programs)
+        run(expected --parser=table "${program}")
+        run(actual ${mode} "${program}")
+        if(NOT actual STREQUAL expected)
+            message(SEND_ERROR "${program}: ${mode} differs from "
+                               "--parser=table")
+        endif()
+    endforeach()
+endfunction()
+
+run(reference --batch --parser=table ${programs})
+
+foreach(mode IN LISTS BATCH_MODES)
+    run(actual --batch ${mode} ${programs})
+    if(NOT actual STREQUAL reference)
+        locate(${mode})
+    endif()
+endforeach()
+
+foreach(mode IN LISTS SINGLE_MODES)
+    set(actual "")
+    foreach(program IN LISTS programs)
+        run(output ${mode} "${program}")
+        string(APPEND actual "${output}")
+    endforeach()
+    if(NOT actual STREQUAL reference)
+        locate(${mode})
+    endif()
+endforeach()
+
+# --incremental takes the programs as successive versions of one program,
+# so each is reparsed from what the previous one left
+run(actual --incremental ${programs})
+if(NOT actual STREQUAL reference)
+    message(SEND_ERROR "--incremental over the programs in turn differs from "
+                       "--parser=table")
+    locate(--incremental)
+endif()